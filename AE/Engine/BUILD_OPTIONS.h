@@ -43,6 +43,31 @@
 // 2 = Application allocates in memory pool with debugging
 #define BUILD_VULKAN_MEMORY_ALLOCATOR_TYPE								2
 
+// Memory pool tuning, small allocations are served from per size class slabs and every thread
+// keeps a cache of free blocks for each size class so that most allocations never lock a mutex.
+// Slab size tells how many bytes are reserved from the system at once for a single size class,
+// thread cache block count tells how many free blocks a thread may hold per size class before
+// returning half of them back to the shared size class, bigger values lock less often but keep
+// more unused memory around per thread.
+// VALUES: slab size in bytes, thread cache size in blocks
+#define BUILD_MEMORY_POOL_SLAB_SIZE										65536
+#define BUILD_MEMORY_POOL_THREAD_CACHE_BLOCK_COUNT						64
+
+// Memory pool telemetry, records live bytes, peak bytes, allocation rate and allocation
+// size histogram per memory tag, see MEMORY_TAG() macro. Report can be written at any time
+// with MemoryPool_WriteTelemetryReport(), it's written to the engine log at shutdown and
+// to MemoryLeakReport.log if the memory pool still has allocations when it's destroyed.
+// VALUES:
+// 0 = OFF
+// 1 = ON
+#define BUILD_MEMORY_POOL_TELEMETRY										0
+
+// Frame arena chunk size, transient per frame containers (FrameVector, FrameString) are
+// allocated from this chunk and released all at once at the beginning of every frame.
+// If a frame uses more memory the chunk is grown to match on the next frame.
+// VALUES: chunk size in bytes
+#define BUILD_FRAME_ARENA_CHUNK_SIZE									262144
+
 // Include function name and line on log report
 // VALUES:
 // 0 = OFF
@@ -78,20 +103,114 @@
 #define BUILD_VULKAN_SECONDARY_RENDER_QUEUE_PRIORITY					0.6f
 #define BUILD_VULKAN_PRIMARY_TRANSFER_QUEUE_PRIORITY					0.5f
 
-// How many loader and destroyer threads the resource managers have
+// Worker threads of the engine wide job system, resource managers and scene updates run their work as jobs.
+// 0 uses one thread per hardware thread minus the main thread
+// VALUES: number of threads, 0 for automatic
+#define BUILD_JOB_SYSTEM_THREAD_COUNT									0
+
+// How many ready scene nodes one scene update job updates
+// VALUES: number of scene nodes
+#define BUILD_SCENE_MANAGER_UPDATE_BATCH_SIZE							64
+
+// How many loader and destroyer jobs the resource managers can run at the same time
 // 2 should be a good value to keep the engine fed with resources, adjust as needed
-// VALUES: number of threads
+// Device resource jobs are pinned to the first job system workers because of per thread vulkan objects,
+// the job system always has at least this many workers
+// VALUES: number of jobs
 #define BUILD_FILE_RESOURCE_MANAGER_WORKER_THREAD_COUNT					2
 #define BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT				2
 
-// Include resource statistics, basically how long the resource took to
-// load and unload, engine will collect a medium for each resource type
-// and reports mediums at the end of the application in the log file
+// Resource manager wait functions sleep until a worker job finishes, device resources that wait for
+// their command buffers can't wake anyone up so their fences are polled at this interval while waiting
+// VALUES: polling interval in microseconds
+#define BUILD_DEVICE_RESOURCE_MANAGER_FENCE_POLL_INTERVAL				1000
+
+// File system opens files for the file resource manager on its own I/O threads so that
+// many reads are in flight at once while the resource worker jobs only parse.
+// Reads are overlapped and finished through an I/O completion port, the I/O threads only open
+// files and handle finished reads so they don't limit how many reads are in flight.
+// Disks need many outstanding requests to reach full speed, maximum in flight limits
+// how many opened files can wait for parsing at the same time
+// VALUES:
+// Number of I/O threads
+// Maximum number of file resources being read at the same time
+#define BUILD_FILE_SYSTEM_IO_THREAD_COUNT								4
+#define BUILD_FILE_RESOURCE_MANAGER_MAX_READS_IN_FLIGHT					64
+
+// File resources that have no users stay loaded so that requesting them again is free,
+// once all loaded file resources together use more memory than the budget the least
+// recently released ones are unloaded. Budget can be changed at runtime from the manager
+// VALUES: bytes, 0 unloads resources as soon as they have no users
+#define BUILD_FILE_RESOURCE_MANAGER_RESIDENT_BUDGET						268435456
+
+// Resource managers keep their resources in hash tables split into shards, each shard has its own
+// mutex so that requests from different threads rarely wait for each other
+// VALUES: number of shards, power of two recommended
+#define BUILD_RESOURCE_MANAGER_LOOKUP_SHARD_COUNT						16
+
+// Memory map files when opening file streams instead of reading them into a heap buffer,
+// file resources keep the mapping alive instead of copying the file contents. Files smaller
+// than the minimum size are read into a heap buffer as mapping them would waste address space
+// VALUES:
+// 0 = OFF
+// 1 = ON
+// Minimum file size in bytes
+#define BUILD_FILE_SYSTEM_MEMORY_MAP_FILES								1
+#define BUILD_FILE_SYSTEM_MEMORY_MAP_MIN_FILE_SIZE						65536
+
+// Buffer size of file streams opened in streaming mode, the next buffer is read ahead while the current
+// one is used, so resources that are loaded through streaming file streams never hold more than twice
+// this much of the file in memory
+// VALUES: buffer size in bytes
+#define BUILD_FILE_STREAM_BUFFER_SIZE									262144
+
+// Use SSE2 to decode .me3d vertices, normals and uvs of a vertex are converted at once
+// instead of one value at a time. Scalar decoding is used if the target doesn't have SSE2.
+// VALUES:
+// 0 = OFF
+// 1 = ON
+#define BUILD_MESH_DECODE_SIMD											1
+
+// Optimize .me3d meshes when they're loaded, cooked meshes are optimized by the cooker instead.
+// Triangles are reordered for the vertex cache and vertices for fetch locality, identical vertices
+// are merged optionally. Before and after statistics are logged for every mesh.
+// VALUES:
+// 0 = OFF
+// 1 = REORDER
+// 2 = REORDER AND DEDUPLICATE
+#define BUILD_MESH_OPTIMIZE_ON_LOAD										0
+
+// Size of the FIFO post transform vertex cache used to measure ACMR and ATVR of meshes
+// VALUES: vertex count
+#define BUILD_MESH_OPTIMIZE_VERTEX_CACHE_SIZE							16
+
+// Archive that is mounted automatically when the engine starts if it exists,
+// files inside the archive are found before loose files under the mount point
+// Archives are created with "AE --pack <source directory> <archive>"
+// VALUES:
+// Archive file path
+// Mount point path
+#define BUILD_FILE_SYSTEM_DEFAULT_ARCHIVE								"data.pak"
+#define BUILD_FILE_SYSTEM_DEFAULT_ARCHIVE_MOUNT_POINT					"data"
+
+// Include resource statistics, time spent waiting for dependencies, waiting in the load queue,
+// reading, parsing, uploading to the device and unloading is collected into histograms per
+// resource type. Count, mean, p50, p95, p99 and max of every timing is written to the log
+// file at the end of the application, see Engine::LogResourceReport()
 // VALUES:
 // 0 = OFF
 // 1 = ON
 #define BUILD_INCLUDE_RESOURCE_STATISTICS								1
 
+// Maximum amount of resource trace events kept when resource statistics are enabled, every
+// read, parse, load and unload is an event. Events are written as Chrome trace JSON into
+// ResourceTrace.json at the end of the application, open it with chrome://tracing.
+// Events past the maximum are dropped.
+// VALUES:
+// 0 = OFF
+// Anything else is the maximum event count
+#define BUILD_RESOURCE_PROFILER_TRACE_EVENT_COUNT						65536
+
 // This tells the maximum per shader texture count, this does not mean that space is automatically
 // allocated for the amount given, but rather the absolute maximum that is possible to allocate
 // VALUES: maximum nuber of sampled images per shader
@@ -1,4 +1,6 @@
 
+#include <fstream>
+
 #include "Engine.h"
 
 // shared
@@ -6,6 +8,7 @@
 #include "Logger/Logger.h"
 
 // sub systems
+#include "Threading/JobSystem.h"
 #include "FileResource/FileResourceManager.h"
 #include "Window/WindowManager.h"
 #include "Renderer/Renderer.h"
@@ -13,6 +16,7 @@
 
 // specific
 #include "World/World.h"
+#include "Profiler/ResourceProfiler.h"
 
 namespace AE
 {
@@ -35,6 +39,8 @@ Logger * EngineBase::GetLogger()
 
 Engine::Engine()
 {
+	job_system				= MakeUniquePointer<JobSystem>( this );
+
 	filesystem				= MakeUniquePointer<FileSystem>( this );
 
 	file_resource_manager	= MakeUniquePointer<FileResourceManager>( this );
@@ -62,11 +68,32 @@ Engine::~Engine()
 	file_resource_manager->AllowResourceRequests( false );
 	file_resource_manager->WaitJobless();
 	file_resource_manager->ScrapFileResources();
+
+#if BUILD_INCLUDE_RESOURCE_STATISTICS
+	LogResourceReport();
+#endif
+#if BUILD_INCLUDE_RESOURCE_STATISTICS && BUILD_RESOURCE_PROFILER_TRACE_EVENT_COUNT
+	WriteResourceTrace( "ResourceTrace.json" );
+#endif
+
+#if BUILD_MEMORY_POOL_TELEMETRY
+	// sub systems are torn down here instead of by the member destructors so that the report
+	// below only sees allocations that outlive them, same order as the member destructors
+	renderer				= nullptr;
+	file_resource_manager	= nullptr;
+	filesystem				= nullptr;
+	job_system				= nullptr;
+
+	// only the logger should still own memory at this point, anything else is likely leaking
+	LogMemoryReport();
+#endif
 }
 
 bool Engine::Run()
 {
 	bool keep_running = true;
+	// everything allocated from the frame arena during the previous frame is released here
+	engine_internal::FrameArena_Reset();
 	file_resource_manager->Update();
 	if( active_world ) {
 		active_world->Update();
@@ -78,6 +105,11 @@ bool Engine::Run()
 	return keep_running;
 }
 
+JobSystem * Engine::GetJobSystem()
+{
+	return job_system.Get();
+}
+
 FileSystem * Engine::GetFileSystem()
 {
 	return filesystem.Get();
@@ -104,4 +136,29 @@ World * Engine::GetWorld()
 	return active_world.Get();
 }
 
+void Engine::LogMemoryReport()
+{
+	std::stringstream report;
+	engine_internal::MemoryPool_WriteTelemetryReport( report );
+	logger->LogInfo( report.str() );
+}
+
+void Engine::LogResourceReport()
+{
+	std::stringstream report;
+	engine_internal::ResourceProfiler_WriteReport( report );
+	logger->LogInfo( report.str() );
+}
+
+bool Engine::WriteResourceTrace( const Path & path )
+{
+	std::ofstream file( path );
+	if( !file.is_open() ) {
+		logger->LogWarning( String( "Unable to write resource trace: " ) + path.string().c_str() );
+		return false;
+	}
+	engine_internal::ResourceProfiler_WriteTrace( file );
+	return true;
+}
+
 }
@@ -13,6 +13,7 @@ namespace AE
 {
 
 class Logger;
+class JobSystem;
 class FileSystem;
 class FileResourceManager;
 class Renderer;
@@ -38,6 +39,7 @@ public:
 
 	bool								Run();
 
+	JobSystem						*	GetJobSystem();
 	FileSystem						*	GetFileSystem();
 	FileResourceManager				*	GetFileResourceManager();
 	Renderer						*	GetRenderer();
@@ -45,7 +47,16 @@ public:
 	World							*	CreateWorld( Path path );
 	World							*	GetWorld();
 
+	// Writes memory pool telemetry report into the engine log, see BUILD_MEMORY_POOL_TELEMETRY
+	void								LogMemoryReport();
+	// Writes resource load and unload timings into the engine log, see BUILD_INCLUDE_RESOURCE_STATISTICS
+	void								LogResourceReport();
+	// Writes recorded resource loading activity as Chrome trace JSON, see BUILD_RESOURCE_PROFILER_TRACE_EVENT_COUNT
+	bool								WriteResourceTrace( const Path & path );
+
 private:
+	// destroyed last, other sub systems schedule their work on it
+	UniquePointer<JobSystem>			job_system;
 	UniquePointer<FileSystem>			filesystem;
 	UniquePointer<FileResourceManager>	file_resource_manager;
 	UniquePointer<Renderer>				renderer;
@@ -1,8 +1,10 @@
 
 #include <assert.h>
-#include <chrono>
 
 #include "FileResource.h"
+#include "FileResourceManager.h"
+
+#include "../Profiler/ResourceProfiler.h"
 
 namespace AE
 {
@@ -15,6 +17,12 @@ FileResource::FileResource( Engine * engine, FileResourceManager * file_resource
 	assert( nullptr != p_engine );
 	assert( nullptr != p_resource_manager );
 	assert( type != FileResource::Type::UNDEFINED );
+
+#if BUILD_INCLUDE_RESOURCE_STATISTICS
+	// resources are created when they're first requested
+	profile_kind			= engine_internal::ResourceProfiler_RegisterKind( GetProfileKindName( type ) );
+	profile_request_time	= engine_internal::ResourceProfiler_Now();
+#endif
 }
 
 FileResource::~FileResource()
@@ -35,8 +43,7 @@ bool FileResource::IsResourceOK()
 
 uint32_t FileResource::GetResourceUsers()
 {
-	std::lock_guard<std::mutex> guard( mutex );
-	return users;
+	return users.load( std::memory_order_acquire );
 }
 
 FileResource::Type FileResource::GetResourceType() const
@@ -44,6 +51,19 @@ FileResource::Type FileResource::GetResourceType() const
 	return type;
 }
 
+void FileResource::AddLoadFinishedCallback( std::function<void()> callback )
+{
+	assert( callback );
+	{
+		LOCK_GUARD( mutex );
+		if( !IsLoadFinishedState( state ) ) {
+			load_finished_callbacks.push_back( std::move( callback ) );
+			return;
+		}
+	}
+	callback();
+}
+
 void FileResource::Release()
 {
 	DecrementUsers();
@@ -51,35 +71,52 @@ void FileResource::Release()
 
 const Path & FileResource::GetPath() const
 {
-	return resource_path;
+	return asset_id.GetPath();
+}
+
+AssetID FileResource::GetAssetID() const
+{
+	return asset_id;
 }
 
 uint32_t FileResource::IncrementUsers()
 {
-	std::lock_guard<std::mutex> guard( mutex );
-	assert( users < UINT32_MAX );
-	++users;
-	return users;
+	auto previous_users		= users.fetch_add( 1, std::memory_order_relaxed );
+	assert( previous_users < UINT32_MAX );
+	return previous_users + 1;
 }
 
 uint32_t FileResource::DecrementUsers()
 {
-	std::lock_guard<std::mutex> guard( mutex );
-	--users;
-	assert( users < UINT32_MAX );
-	return users;
+	// the last user is released by the manager, the resource may be unloaded
+	// by a worker as soon as it's users reach 0 so it's not touched after that
+	auto current_users		= users.load( std::memory_order_relaxed );
+	while( current_users > 1 ) {
+		if( users.compare_exchange_weak( current_users, current_users - 1, std::memory_order_acq_rel, std::memory_order_relaxed ) ) {
+			return current_users - 1;
+		}
+	}
+	return p_resource_manager->DecrementUsers( this );
+}
+
+FileStream::Mode FileResource::GetStreamMode() const
+{
+	return stream_mode;
 }
 
 bool FileResource::LoadFromManager( FileStream * stream, const Path & path )
 {
 #if BUILD_INCLUDE_RESOURCE_STATISTICS
-	auto time_point1	= std::chrono::high_resolution_clock::now();
+	auto start_time		= engine_internal::ResourceProfiler_Now();
 #endif
 	auto result			= Load( stream, path );
 #if BUILD_INCLUDE_RESOURCE_STATISTICS
-	auto time_point2	= std::chrono::high_resolution_clock::now();
-	auto time_span		= std::chrono::duration_cast<std::chrono::milliseconds>( time_point2 - time_point1 );
-	load_time			= time_span.count();
+	auto end_time		= engine_internal::ResourceProfiler_Now();
+	engine_internal::ResourceProfiler_RecordTiming( profile_kind, engine_internal::ResourceTiming::PARSE, end_time - start_time );
+	engine_internal::ResourceProfiler_RecordTraceEvent( "File parse", asset_id, start_time, end_time );
+	if( result ) {
+		engine_internal::ResourceProfiler_RecordTiming( profile_kind, engine_internal::ResourceTiming::TOTAL, end_time - profile_request_time );
+	}
 #endif
 	return result;
 }
@@ -87,13 +124,13 @@ bool FileResource::LoadFromManager( FileStream * stream, const Path & path )
 bool FileResource::UnloadFromManager()
 {
 #if BUILD_INCLUDE_RESOURCE_STATISTICS
-	auto time_point1	= std::chrono::high_resolution_clock::now();
+	auto start_time		= engine_internal::ResourceProfiler_Now();
 #endif
 	auto result			= Unload();
 #if BUILD_INCLUDE_RESOURCE_STATISTICS
-	auto time_point2	= std::chrono::high_resolution_clock::now();
-	auto time_span		= std::chrono::duration_cast<std::chrono::milliseconds>( time_point2 - time_point1 );
-	unload_time			= time_span.count();
+	auto end_time		= engine_internal::ResourceProfiler_Now();
+	engine_internal::ResourceProfiler_RecordTiming( profile_kind, engine_internal::ResourceTiming::UNLOAD, end_time - start_time );
+	engine_internal::ResourceProfiler_RecordTraceEvent( "File unload", asset_id, start_time, end_time );
 #endif
 	return result;
 }
@@ -106,8 +143,35 @@ FileResource::State FileResource::GetResourceState()
 
 void FileResource::SetResourceState( State new_state )
 {
-	std::lock_guard<std::mutex> guard( mutex );
-	state		= new_state;
+	Vector<std::function<void()>> callbacks;
+	{
+		std::lock_guard<std::mutex> guard( mutex );
+		state		= new_state;
+		if( IsLoadFinishedState( state ) ) {
+			callbacks.swap( load_finished_callbacks );
+		}
+	}
+	// called without the lock so that callbacks can use the resource
+	for( auto & c : callbacks ) {
+		c();
+	}
+}
+
+bool FileResource::IsLoadFinishedState( State check_state )
+{
+	return ( State::LOADED == check_state || State::UNABLE_TO_LOAD == check_state || State::UNABLE_TO_LOAD_FILE_NOT_FOUND == check_state );
+}
+
+const char * FileResource::GetProfileKindName( Type resource_type )
+{
+	switch( resource_type ) {
+	case Type::RAW_DATA:	return "File raw data";
+	case Type::XML:			return "File XML";
+	case Type::LUA:			return "File Lua";
+	case Type::MESH:		return "File mesh";
+	case Type::IMAGE:		return "File image";
+	default:				return "File unknown";
+	}
 }
 
 }
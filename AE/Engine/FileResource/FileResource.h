@@ -2,12 +2,14 @@
 
 #include <mutex>
 #include <atomic>
+#include <functional>
 
 #include "../BUILD_OPTIONS.h"
 #include "../Platform.h"
 
 #include "../Memory/Memory.h"
 #include "../FileSystem/FileStream.h"
+#include "../FileSystem/AssetID.h"
 #include "../CppFileSystem/CppFileSystem.h"
 
 namespace AE
@@ -16,10 +18,21 @@ namespace AE
 class Engine;
 class FileResourceManager;
 
+// Load priority of file and device resources, resources with a higher priority are loaded first
+// values between the named priorities are allowed
+enum class ResourcePriority : uint32_t
+{
+	LOWEST						= 0,
+	LOW							= 64,
+	NORMAL						= 128,
+	HIGH						= 192,
+	HIGHEST						= 255,
+};
+
 class FileResource
 {
 	friend class FileResourceManager;
-	friend void FileWorkerThread( Engine * engine, FileResourceManager * file_resource_manager, std::atomic_bool * thread_sleeping );
+	friend void FileWorkerJob( Engine * engine, FileResourceManager * file_resource_manager );
 	template<typename R>
 	friend class FileResourceHandle;
 
@@ -58,10 +71,19 @@ public:
 	uint32_t					GetResourceUsers();
 	Type						GetResourceType() const;
 
+	// Callback is called once when the resource has finished loading or failed to load, use IsResourceOK()
+	// to tell them apart. If the resource has already finished the callback is called right away, othervise
+	// it's called from the thread that finished the resource so it should be short and thread safe
+	void						AddLoadFinishedCallback( std::function<void()> callback );
+
 	// if you use FileResourceHandle you don't manually need to call this function
 	void						Release();
 
 	const Path				&	GetPath() const;
+	AssetID						GetAssetID() const;
+
+	// approximate amount of memory the loaded resource uses, counted against the resident budget of the manager
+	virtual size_t				GetResidentSize() const											= 0;
 
 private:
 	uint32_t					IncrementUsers();
@@ -73,6 +95,9 @@ private:
 	virtual bool				Load( FileStream * stream, const Path & path )	= 0;	// Load in loader thread
 	virtual bool				Unload()														= 0;	// Unload in loader thread
 
+	// stream mode the file is opened with, resources that pick it per file override this
+	virtual FileStream::Mode	GetStreamMode() const;
+
 	bool						LoadFromManager( FileStream * stream, const Path & path );
 	bool						UnloadFromManager();
 
@@ -80,22 +105,48 @@ public:
 	State						GetResourceState();
 
 private:
+	// calls load finished callbacks when the new state is a finished state
 	void						SetResourceState( State new_state );
+	static bool					IsLoadFinishedState( State check_state );
+	// name the resource is reported with in the resource profiler
+	static const char		*	GetProfileKindName( Type resource_type );
 
 protected:
 	Engine					*	p_engine					= nullptr;
 	FileResourceManager		*	p_resource_manager			= nullptr;
 
+	// resources that parse the file front to back or by sections can use a streaming
+	// file stream so that big files are never fully in memory
+	FileStream::Mode			stream_mode					= FileStream::Mode::WHOLE_FILE;
+
 private:
 	std::mutex					mutex;
-	uint32_t					users						= 0;
+	// users only go from 0 to 1 while the lookup shard of the resource is locked,
+	// so the count itself does not need the resource mutex
+	std::atomic<uint32_t>		users						{ 0 };
 	State						state						= State::UNLOADED;
 	Type						type						= Type::UNDEFINED;
-	Path						resource_path;
+	AssetID						asset_id;
+	// waiting for the resource to finish loading, called and cleared when the state is set to a finished state
+	Vector<std::function<void()>>	load_finished_callbacks;
+
+	// position in the load list of the resource manager, only used while loading is queued
+	ResourcePriority			load_priority				= ResourcePriority::NORMAL;
+	uint64_t					load_sequence				= 0;
+
+	// resource is queued for unloading when it's users drop to 0 after it has finished loading,
+	// guarded by the unload queue mutex of the manager
+	bool						unload_allowed				= false;
+	bool						in_unload_queue				= false;
+	List<FileResource*>::iterator	unload_queue_position;
+	// size reported by GetResidentSize() after loading, counted in the resident bytes of the manager
+	size_t						resident_size				= 0;
 
 #if BUILD_INCLUDE_RESOURCE_STATISTICS
-	uint64_t					load_time					= 0;
-	uint64_t					unload_time					= 0;
+	// resource profiler kind and timestamps in profiler time
+	uint16_t					profile_kind				= 0;
+	uint64_t					profile_request_time		= 0;
+	uint64_t					profile_read_time			= 0;
 #endif
 };
 
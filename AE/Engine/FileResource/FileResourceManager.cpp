@@ -1,10 +1,14 @@
 
 #include <sstream>
+#include <cstring>
+#include <algorithm>
 
 #include "FileResourceManager.h"
 
 #include "../Engine.h"
 #include "../Logger/Logger.h"
+#include "../Threading/JobSystem.h"
+#include "../Profiler/ResourceProfiler.h"
 
 #include "../FileResource/FileResource.h"
 #include "RawData/FileResource_RawData.h"
@@ -16,7 +20,8 @@
 namespace AE
 {
 
-void FileWorkerThread( Engine * engine, FileResourceManager * file_resource_manager, std::atomic_bool * thread_sleeping )
+// one pass over the loading and unloading work, runs as a job on the job system
+void FileWorkerJob( Engine * engine, FileResourceManager * file_resource_manager )
 {
 	assert( nullptr != engine );
 	assert( nullptr != file_resource_manager );
@@ -25,112 +30,107 @@ void FileWorkerThread( Engine * engine, FileResourceManager * file_resource_mana
 	assert( p_filesystem );
 	assert( p_logger );
 
-	while( !file_resource_manager->worker_threads_should_exit ) {
+	MEMORY_TAG( "File resource worker" );
+
+	// look for loading work first, reading happens on the file system I/O threads,
+	// worker jobs submit reads and parse whatever has been read so far
+	bool load_operation_ran				= false;
+	while( true ) {
+		if( file_resource_manager->allow_resource_loading ) {
+			file_resource_manager->SubmitQueuedReads();
+		}
+
+		FileResourceManager::OpenedResource opened {};
 		{
-			std::unique_lock<std::mutex> wakeup_guard( file_resource_manager->worker_threads_wakeup_mutex );
-			*thread_sleeping	= true;
-			file_resource_manager->worker_threads_wakeup.wait( wakeup_guard );
-			*thread_sleeping	= false;
+			std::lock_guard<std::mutex> opened_list_guard( file_resource_manager->mutex_opened_list );
+			if( !file_resource_manager->opened_list.size() ) break;
+			opened		= file_resource_manager->opened_list.front();
+			file_resource_manager->opened_list.pop_front();
 		}
-		// look for loading work first
-		bool load_operation_ran				= false;
-		if( file_resource_manager->allow_resource_loading ) {
-			bool more_work_available		= true;
-			// loop and load everything until the load list is empty
-			// it's likely the rest of the program is faster at giving
-			// tasks than the loader thread is able to process them
-			// this way we don't have to wait a call from the resource manager
-			// to initiate resource loading if there is pending work
-			while( more_work_available ) {
-				Path				path;
-				FileResource	*	resource	= nullptr;
-				{
-					std::lock_guard<std::mutex> load_list_guard( file_resource_manager->mutex_load_list );
-					auto res	= file_resource_manager->load_list.begin();
-					if( res != file_resource_manager->load_list.end() ) {
-						path		= res->first;
-						resource	= res->second;
-						file_resource_manager->load_list.erase( res );
-					}
-					if( file_resource_manager->load_list.size() == 0 ) {
-						more_work_available	= false;
-					}
-				}
-				if( nullptr != resource ) {
-					bool can_load	= false;
-					{
-						std::lock_guard<std::mutex> resource_guard( resource->mutex );
-						assert( resource->state == FileResource::State::LOADING_QUEUED );
-						can_load	= ( resource->state == FileResource::State::LOADING_QUEUED );
-						if( can_load )	resource->state = FileResource::State::LOADING;
-					}
-					if( can_load ) {
-						auto fs		= p_filesystem->OpenFileStream( path );
-						if( nullptr != fs ) {
-							auto loaded	= resource->LoadFromManager( fs, path );
-							resource->SetResourceState( loaded ? FileResource::State::LOADED : FileResource::State::UNABLE_TO_LOAD );
-							p_filesystem->CloseFileStream( fs );
-							load_operation_ran			= true;
-						} else {
-							resource->SetResourceState( FileResource::State::UNABLE_TO_LOAD_FILE_NOT_FOUND );
-							p_logger->LogWarning( String( "File resource not found: " ) + path.string().c_str() );
-						}
-					}
-				}
+		// already opened files are always parsed so that no resource is left in the loading state
+		auto resource	= opened.resource;
+		auto & path		= resource->GetPath();
+		if( nullptr != opened.stream ) {
+			auto loaded	= resource->LoadFromManager( opened.stream, path );
+			if( loaded ) {
+				file_resource_manager->SetResidentSize( resource, resource->GetResidentSize() );
 			}
+			resource->SetResourceState( loaded ? FileResource::State::LOADED : FileResource::State::UNABLE_TO_LOAD );
+			p_filesystem->CloseFileStream( opened.stream );
+			load_operation_ran			= true;
+		} else {
+			resource->SetResourceState( FileResource::State::UNABLE_TO_LOAD_FILE_NOT_FOUND );
+			p_logger->LogWarning( String( "File resource not found: " ) + path.string().c_str() );
 		}
-		// look for unloading and destroying work
-		if( file_resource_manager->allow_resource_unloading ) {
-			if( !load_operation_ran ) {
-				UniquePointer<FileResource> resource = nullptr;
-				{
-					std::lock_guard<std::mutex> resources_guard( file_resource_manager->mutex_resources_list );
-					auto it = file_resource_manager->resources_list.begin();
-					while( it != file_resource_manager->resources_list.end() ) {
-						auto & res = it->second;
-						std::lock_guard<std::mutex> resource_guard( res->mutex );
-						if( res->users == 0 ) {
-							if( res->state != FileResource::State::LOADING && res->state != FileResource::State::LOADING_QUEUED ) {
-								res->state		= FileResource::State::UNLOADING;
-								resource		= std::move( it->second );
-								it				= file_resource_manager->resources_list.erase( it );
-								break;
-							} else {
-								++it;
-							}
-						} else {
-							++it;
-						}
-					}
+		// resource is not touched after this, it may be unloaded by another worker right away
+		file_resource_manager->AllowUnloading( resource );
+		--file_resource_manager->reads_in_flight;
+	}
+	// loading goes first, unloading is left for the next pass
+	if( load_operation_ran ) {
+		file_resource_manager->worker_jobs_requested	= true;
+	}
+	// look for unloading and destroying work
+	if( file_resource_manager->allow_resource_unloading ) {
+		// unused resources are only unloaded while over the resident budget, least recently used first
+		while( !load_operation_ran && !file_resource_manager->worker_jobs_should_exit ) {
+			UniquePointer<FileResource>	resource	= nullptr;
+			AssetID						candidate_id;
+			{
+				// only the id is taken from the queue, the resource may be requested, released and unloaded
+				// by another worker as soon as the lock is released so it's looked up again from the shard
+				std::lock_guard<std::mutex> unload_queue_guard( file_resource_manager->mutex_unload_queue );
+				if( file_resource_manager->unload_queue.size() && file_resource_manager->IsOverResidentBudget() ) {
+					auto candidate				= file_resource_manager->unload_queue.front();
+					candidate_id				= candidate->asset_id;
+					file_resource_manager->RemoveFromUnloadQueue( candidate );
 				}
-				if( resource ) {
-					if( resource->UnloadFromManager() ) {
-						resource->SetResourceState( FileResource::State::UNLOADED );
-					} else {
-						resource->SetResourceState( FileResource::State::UNABLE_TO_UNLOAD );
-						p_logger->LogWarning( String( "Unable to unload file resource: " ) + resource->GetPath().string().c_str() );
-						assert( 0 && "Unable to unload resource, we'll try and delete it anyways" );
-					}
+			}
+			if( !candidate_id.IsValid() ) break;
+			{
+				auto & shard	= file_resource_manager->GetResourceShard( candidate_id );
+				std::lock_guard<std::mutex> shard_guard( shard.mutex );
+				auto it			= shard.resources.find( candidate_id );
+				if( it == shard.resources.end() ) continue;
+				auto candidate	= it->second.Get();
+				std::lock_guard<std::mutex> resource_guard( candidate->mutex );
+				// users only go from 0 to 1 while the shard is locked so this check is final,
+				// resources that are still loading are queued again once loading finishes
+				if( candidate->users == 0 &&
+					candidate->state != FileResource::State::LOADING &&
+					candidate->state != FileResource::State::LOADING_QUEUED ) {
+					candidate->state			= FileResource::State::UNLOADING;
+					resource					= std::move( it->second );
+					shard.resources.erase( it );
+					// it may have been requested, released and queued again after we took it from the queue
+					std::lock_guard<std::mutex> unload_queue_guard( file_resource_manager->mutex_unload_queue );
+					file_resource_manager->RemoveFromUnloadQueue( candidate );
+				}
+			}
+			if( resource ) {
+				file_resource_manager->SetResidentSize( resource.Get(), 0 );
+				++file_resource_manager->cache_evictions;
+				if( resource->UnloadFromManager() ) {
+					resource->SetResourceState( FileResource::State::UNLOADED );
+				} else {
+					resource->SetResourceState( FileResource::State::UNABLE_TO_UNLOAD );
+					p_logger->LogWarning( String( "Unable to unload file resource: " ) + resource->GetPath().string().c_str() );
+					assert( 0 && "Unable to unload resource, we'll try and delete it anyways" );
 				}
 			}
 		}
 	}
-};
+}
 
 FileResourceManager::FileResourceManager( Engine * engine )
 	: SubSystem( engine, "FileResourceManager")
 {
 	p_filesystem		= engine->GetFileSystem();
+	p_job_system		= engine->GetJobSystem();
+	assert( p_job_system );
 	allow_resource_requests				= false;
 	allow_resource_loading				= false;
 	allow_resource_unloading			= false;
-	worker_threads_should_exit			= false;
-
-	for( uint32_t i=0; i < BUILD_FILE_RESOURCE_MANAGER_WORKER_THREAD_COUNT; ++i ) {
-		worker_threads_sleeping[ i ]	= false;
-		auto thread						= std::thread( FileWorkerThread, p_engine, this, &worker_threads_sleeping[ i ] );
-		worker_threads[ i ]				= std::move( thread );
-	}
 }
 
 FileResourceManager::~FileResourceManager()
@@ -142,69 +142,253 @@ FileResourceManager::~FileResourceManager()
 	// scrap resources, ideally there shouldn't be any left at this point, but just in case
 	ScrapFileResources();
 
-	// notify all threads they should close
-	worker_threads_should_exit				= true;
-
-	// wait until they're all joinable, keep waiking them up until they become joinable
-	uint32_t worker_threads_joinable_count	= 0;
-	while( worker_threads_joinable_count != BUILD_FILE_RESOURCE_MANAGER_WORKER_THREAD_COUNT ) {
-		SignalWorkers_All();
-		std::this_thread::yield();
-		std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
-
-		uint32_t worker_threads_joinable_count_temp		= 0;
-		for( auto & t : worker_threads ) {
-			worker_threads_joinable_count_temp += uint32_t( !!t.joinable() );
-		}
-		worker_threads_joinable_count	= worker_threads_joinable_count_temp;
+	{
+		auto statistics		= GetCacheStatistics();
+		std::stringstream ss;
+		ss << "File resource cache: " << statistics.hits << " hits, " << statistics.misses << " misses, "
+			<< statistics.evictions << " evictions";
+		p_logger->LogInfo( ss.str() );
 	}
 
-	// all worker threads should be joinable
-	for( auto & w : worker_threads ) {
-		w.join();
-	}
+	// no more worker jobs are scheduled, wait for the ones that are still queued or running
+	worker_jobs_should_exit				= true;
+	WaitIdle();
 }
 
-FileResourceHandle<FileResource> FileResourceManager::RequestResource( const Path & resource_path )
+FileResourceHandle<FileResource> FileResourceManager::RequestResource( AssetID asset_id, ResourcePriority priority )
 {
 	if( !allow_resource_requests ) return nullptr;
-	if( resource_path == "" ) return nullptr;
+	if( !asset_id.IsValid() ) return nullptr;
 
-	std::lock_guard<std::mutex> lock_guard( mutex_resources_list );
+	auto & shard		= GetResourceShard( asset_id );
+	std::lock_guard<std::mutex> lock_guard( shard.mutex );
 
 	FileResourceHandle<FileResource>	resource		= nullptr;
 	// check if resource already available
-	auto resource_at	= resources_list.find( resource_path );
-	if( resource_at		!= resources_list.end() ) {
+	auto resource_at	= shard.resources.find( asset_id );
+	if( resource_at		!= shard.resources.end() ) {
 		// found, use this
 		resource		= FileResourceHandle<FileResource>( resource_at->second.Get() );
+		BumpResourcePriority( resource.Get(), priority );
+		{
+			// resource is in use again, it's no longer an unload candidate
+			std::lock_guard<std::mutex> unload_queue_guard( mutex_unload_queue );
+			RemoveFromUnloadQueue( resource.Get() );
+		}
+		++cache_hits;
 		return resource;
-	} else {
-		// not found, make a new entry
-		auto resource_type				= GetFileResourceTypeFromExtension( resource_path );
-		auto resource_unique			= CreateResource( resource_type );
-		resource_unique->state			= FileResource::State::LOADING_QUEUED;
-		resource_unique->resource_path	= resource_path;
-		resource						= FileResourceHandle<FileResource>( resource_unique.Get() );
-		if( resource ) {
-			std::lock_guard<std::mutex> load_list_guard( mutex_load_list );
-			load_list.insert( std::pair<Path, FileResource*>( resource_path, resource.Get() ) );
-			resources_list.insert( std::pair<Path, UniquePointer<FileResource>>( resource_path, std::move( resource_unique ) ) );
-			SignalWorkers_One();
+	}
+
+	// not found, make a new entry
+	auto resource_unique					= CreateResource( asset_id );
+	resource_unique->state					= FileResource::State::LOADING_QUEUED;
+	resource_unique->asset_id				= asset_id;
+	resource								= FileResourceHandle<FileResource>( resource_unique.Get() );
+	if( resource ) {
+		std::lock_guard<std::mutex> load_list_guard( mutex_load_list );
+		resource_unique->load_priority	= priority;
+		resource_unique->load_sequence	= load_list_sequence++;
+		load_list.insert( std::pair<LoadListKey, FileResource*>( { priority, resource_unique->load_sequence }, resource.Get() ) );
+		shard.resources.insert( std::pair<AssetID, UniquePointer<FileResource>>( asset_id, std::move( resource_unique ) ) );
+		SignalWorkers_One();
+	}
+	++cache_misses;
+
+	return resource;
+}
+
+FileResourceHandle<FileResource> FileResourceManager::RequestResource( const Path & resource_path, ResourcePriority priority )
+{
+	if( !allow_resource_requests ) return nullptr;
+	return RequestResource( AssetID( resource_path ), priority );
+}
+
+Vector<FileResourceHandle<FileResource>> FileResourceManager::RequestResources( const Vector<ResourceRequest> & requests )
+{
+	Vector<FileResourceHandle<FileResource>> resources( requests.size() );
+	if( !allow_resource_requests ) return resources;
+
+	// requests are handled shard by shard, the same ids end up next to each other
+	Vector<uint32_t> order;
+	order.reserve( requests.size() );
+	for( uint32_t i=0; i < uint32_t( requests.size() ); ++i ) {
+		if( requests[ i ].asset_id.IsValid() ) {
+			order.push_back( i );
 		}
+	}
+	std::sort( order.begin(), order.end(), [ &requests ]( uint32_t a, uint32_t b ) {
+		auto shard_a	= GetResourceShardIndex( requests[ a ].asset_id );
+		auto shard_b	= GetResourceShardIndex( requests[ b ].asset_id );
+		if( shard_a != shard_b ) return shard_a < shard_b;
+		return requests[ a ].asset_id < requests[ b ].asset_id;
+	} );
+
+	struct PriorityBump
+	{
+		FileResource					*	resource;
+		ResourcePriority					priority;
+	};
+	Vector<FileResource*>					created;
+	Vector<PriorityBump>					bumps;
+	uint64_t								hits			= 0;
+
+	size_t group_begin			= 0;
+	while( group_begin < order.size() ) {
+		auto shard_index		= GetResourceShardIndex( requests[ order[ group_begin ] ].asset_id );
+		auto & shard			= resource_shards[ shard_index ];
+		std::lock_guard<std::mutex> shard_guard( shard.mutex );
+
+		size_t group_end		= group_begin;
+		size_t hits_begin		= bumps.size();
+		while( group_end < order.size() && GetResourceShardIndex( requests[ order[ group_end ] ].asset_id ) == shard_index ) {
+			auto index			= order[ group_end ];
+			auto & request		= requests[ index ];
+			if( group_end > group_begin && requests[ order[ group_end - 1 ] ].asset_id == request.asset_id ) {
+				// same id earlier in the batch, share it's resource
+				auto & previous		= resources[ order[ group_end - 1 ] ];
+				if( previous ) {
+					resources[ index ]	= previous;
+					bumps.push_back( { resources[ index ].Get(), request.priority } );
+					++hits;
+				}
+				++group_end;
+				continue;
+			}
+			auto resource_at	= shard.resources.find( request.asset_id );
+			if( resource_at		!= shard.resources.end() ) {
+				resources[ index ]	= FileResourceHandle<FileResource>( resource_at->second.Get() );
+				bumps.push_back( { resources[ index ].Get(), request.priority } );
+				++hits;
+			} else {
+				auto resource_unique				= CreateResource( request.asset_id );
+				if( resource_unique ) {
+					// not in the load list yet, requests for it in the meantime only change load_priority
+					resource_unique->state			= FileResource::State::LOADING_QUEUED;
+					resource_unique->asset_id		= request.asset_id;
+					resource_unique->load_priority	= request.priority;
+					resources[ index ]				= FileResourceHandle<FileResource>( resource_unique.Get() );
+					created.push_back( resource_unique.Get() );
+					shard.resources.insert( std::pair<AssetID, UniquePointer<FileResource>>( request.asset_id, std::move( resource_unique ) ) );
+				}
+			}
+			++group_end;
+		}
+		{
+			// resources are in use again, they're no longer unload candidates, done while the shard is locked
+			// so that a resource can't drop to 0 users and be queued again before it's removed here
+			std::lock_guard<std::mutex> unload_queue_guard( mutex_unload_queue );
+			for( size_t i=hits_begin; i < bumps.size(); ++i ) {
+				RemoveFromUnloadQueue( bumps[ i ].resource );
+			}
+		}
+		group_begin				= group_end;
+	}
 
-		return resource;
+	if( created.size() || bumps.size() ) {
+		std::lock_guard<std::mutex> load_list_guard( mutex_load_list );
+		for( auto r : created ) {
+			r->load_sequence	= load_list_sequence++;
+			load_list.insert( std::pair<LoadListKey, FileResource*>( { r->load_priority, r->load_sequence }, r ) );
+		}
+		for( auto & b : bumps ) {
+			MoveInLoadList( b.resource, b.priority );
+		}
+	}
+	cache_hits		+= hits;
+	cache_misses	+= created.size();
+	if( created.size() ) {
+		SignalWorkers_One();
 	}
+	return resources;
+}
+
+FileResourceManager::ResourceShard & FileResourceManager::GetResourceShard( AssetID asset_id )
+{
+	return resource_shards[ GetResourceShardIndex( asset_id ) ];
+}
+
+uint32_t FileResourceManager::GetResourceShardIndex( AssetID asset_id )
+{
+	return uint32_t( asset_id.GetValue() % BUILD_RESOURCE_MANAGER_LOOKUP_SHARD_COUNT );
+}
+
+void FileResourceManager::BumpResourcePriority( FileResource * resource, ResourcePriority priority )
+{
+	assert( nullptr != resource );
+
+	std::lock_guard<std::mutex> load_list_guard( mutex_load_list );
+	MoveInLoadList( resource, priority );
+}
+
+void FileResourceManager::MoveInLoadList( FileResource * resource, ResourcePriority priority )
+{
+	assert( nullptr != resource );
+	if( uint32_t( priority ) <= uint32_t( resource->load_priority ) ) return;
+
+	// only resources that haven't been submitted for reading yet can be moved
+	auto it			= load_list.find( { resource->load_priority, resource->load_sequence } );
+	if( it != load_list.end() && it->second == resource ) {
+		load_list.erase( it );
+		load_list.insert( std::pair<LoadListKey, FileResource*>( { priority, resource->load_sequence }, resource ) );
+	}
+	resource->load_priority		= priority;
 }
 
 void FileResourceManager::SignalWorkers_One()
 {
-	worker_threads_wakeup.notify_one();
+	worker_jobs_requested		= true;
+	ScheduleWorkerJob();
 }
 
 void FileResourceManager::SignalWorkers_All()
 {
-	worker_threads_wakeup.notify_all();
+	worker_jobs_requested		= true;
+	for( uint32_t i=0; i < BUILD_FILE_RESOURCE_MANAGER_WORKER_THREAD_COUNT; ++i ) {
+		ScheduleWorkerJob();
+	}
+}
+
+void FileResourceManager::ScheduleWorkerJob()
+{
+	if( worker_jobs_should_exit ) return;
+
+	uint32_t running			= worker_jobs_running;
+	do {
+		if( running >= BUILD_FILE_RESOURCE_MANAGER_WORKER_THREAD_COUNT ) return;
+	} while( !worker_jobs_running.compare_exchange_weak( running, running + 1 ) );
+
+	// background so that threads waiting on short jobs, eg. the scene update, never get stuck parsing files
+	p_job_system->SubmitBackground( [ this ]() {
+		RunWorkerJob();
+	} );
+}
+
+void FileResourceManager::RunWorkerJob()
+{
+	while( worker_jobs_requested.exchange( false ) ) {
+		FileWorkerJob( p_engine, this );
+	}
+	--worker_jobs_running;
+	// work may have been requested after the last pass while this job was still counted as running
+	if( worker_jobs_requested ) {
+		ScheduleWorkerJob();
+	}
+	NotifyWorkDone();
+}
+
+void FileResourceManager::NotifyWorkDone()
+{
+	// locking makes sure a waiter is either still before its check or already waiting, so no notification is missed
+	{
+		std::lock_guard<std::mutex> work_done_guard( mutex_work_done );
+	}
+	work_done.notify_all();
+}
+
+void FileResourceManager::WaitUntil( std::function<bool()> is_done )
+{
+	std::unique_lock<std::mutex> work_done_guard( mutex_work_done );
+	work_done.wait( work_done_guard, is_done );
 }
 
 void FileResourceManager::Update()
@@ -212,61 +396,164 @@ void FileResourceManager::Update()
 	SignalWorkers_One();
 }
 
+bool FileResourceManager::SubmitQueuedReads()
+{
+	bool submitted		= false;
+	while( reads_in_flight < BUILD_FILE_RESOURCE_MANAGER_MAX_READS_IN_FLIGHT ) {
+		FileResource	*	resource	= nullptr;
+		{
+			std::lock_guard<std::mutex> load_list_guard( mutex_load_list );
+			auto res	= load_list.begin();
+			if( res == load_list.end() ) break;
+			resource	= res->second;
+			load_list.erase( res );
+		}
+		{
+			std::lock_guard<std::mutex> resource_guard( resource->mutex );
+			assert( resource->state == FileResource::State::LOADING_QUEUED );
+			if( resource->state != FileResource::State::LOADING_QUEUED ) continue;
+			resource->state = FileResource::State::LOADING;
+		}
+#if BUILD_INCLUDE_RESOURCE_STATISTICS
+		resource->profile_read_time		= engine_internal::ResourceProfiler_Now();
+		engine_internal::ResourceProfiler_RecordTiming( resource->profile_kind, engine_internal::ResourceTiming::QUEUE_WAIT, resource->profile_read_time - resource->profile_request_time );
+#endif
+
+		// reads in flight is decremented once the worker thread is done with the opened resource
+		++reads_in_flight;
+		p_filesystem->OpenFileStreamAsync( resource->GetPath(), resource->GetStreamMode(), [ this, resource ]( FileStream * stream ) {
+#if BUILD_INCLUDE_RESOURCE_STATISTICS
+			auto opened_time	= engine_internal::ResourceProfiler_Now();
+			engine_internal::ResourceProfiler_RecordTiming( resource->profile_kind, engine_internal::ResourceTiming::IO, opened_time - resource->profile_read_time );
+			engine_internal::ResourceProfiler_RecordTraceEvent( "File read", resource->asset_id, resource->profile_read_time, opened_time, true );
+#endif
+			{
+				std::lock_guard<std::mutex> opened_list_guard( mutex_opened_list );
+				opened_list.push_back( { resource, stream } );
+			}
+			SignalWorkers_One();
+		} );
+		submitted		= true;
+	}
+	return submitted;
+}
+
+void FileResourceManager::QueueForUnload( FileResource * resource )
+{
+	assert( nullptr != resource );
+	std::lock_guard<std::mutex> unload_queue_guard( mutex_unload_queue );
+	AddToUnloadQueue( resource );
+}
+
+uint32_t FileResourceManager::DecrementUsers( FileResource * resource )
+{
+	assert( nullptr != resource );
+	std::lock_guard<std::mutex> unload_queue_guard( mutex_unload_queue );
+	auto previous_users		= resource->users.fetch_sub( 1, std::memory_order_acq_rel );
+	assert( previous_users > 0 );
+	if( previous_users == 1 ) {
+		AddToUnloadQueue( resource );
+	}
+	return previous_users - 1;
+}
+
+void FileResourceManager::AllowUnloading( FileResource * resource )
+{
+	assert( nullptr != resource );
+	std::lock_guard<std::mutex> unload_queue_guard( mutex_unload_queue );
+	resource->unload_allowed				= true;
+	// users may have dropped to 0 while loading, it wasn't queued then
+	if( resource->users == 0 ) {
+		AddToUnloadQueue( resource );
+	}
+}
+
+void FileResourceManager::AddToUnloadQueue( FileResource * resource )
+{
+	if( !resource->unload_allowed ) return;
+	if( !resource->in_unload_queue ) {
+		resource->in_unload_queue			= true;
+		resource->unload_queue_position		= unload_queue.insert( unload_queue.end(), resource );
+		unload_queue_bytes					+= resource->resident_size;
+	}
+	if( IsOverResidentBudget() ) {
+		SignalWorkers_One();
+	}
+}
+
+void FileResourceManager::RemoveFromUnloadQueue( FileResource * resource )
+{
+	if( resource->in_unload_queue ) {
+		unload_queue.erase( resource->unload_queue_position );
+		resource->in_unload_queue			= false;
+		unload_queue_bytes					-= resource->resident_size;
+	}
+}
+
+void FileResourceManager::SetResidentSize( FileResource * resource, size_t resident_size )
+{
+	std::lock_guard<std::mutex> unload_queue_guard( mutex_unload_queue );
+	if( resource->in_unload_queue ) {
+		unload_queue_bytes					+= resident_size;
+		unload_queue_bytes					-= resource->resident_size;
+	}
+	resident_bytes							+= resident_size;
+	resident_bytes							-= resource->resident_size;
+	resource->resident_size					= resident_size;
+}
+
+bool FileResourceManager::IsOverResidentBudget() const
+{
+	return unload_all_unused || resident_bytes > resident_budget;
+}
+
 bool FileResourceManager::HasPendingLoadWork()
 {
+	if( reads_in_flight ) return true;
 	std::lock_guard<std::mutex> load_list_guard( mutex_load_list );
 	return !!load_list.size();
 }
 
 bool FileResourceManager::HasPendingUnloadWork()
 {
-	std::lock_guard<std::mutex> resources_list_guard( mutex_resources_list );
-	for( auto & r : resources_list ) {
-		if( !r.second->GetResourceUsers() ) return true;
-	}
-	return false;
+	std::lock_guard<std::mutex> unload_queue_guard( mutex_unload_queue );
+	return unload_queue.size() && IsOverResidentBudget();
 }
 
 bool FileResourceManager::IsIdle()
 {
-	for( auto & s : worker_threads_sleeping ) {
-		if( !s ) return false;
-	}
-	return true;
+	return worker_jobs_running == 0;
 }
 
 void FileResourceManager::WaitIdle()
 {
-	while( !IsIdle() ) {
-		std::this_thread::yield();
-	}
+	WaitUntil( [ this ]() {
+		return IsIdle();
+	} );
 }
 
 void FileResourceManager::WaitJobless()
 {
-	while( HasPendingLoadWork() || HasPendingUnloadWork() || !IsIdle() ) {
-		SignalWorkers_All();
-		std::this_thread::yield();
-		std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
-	}
+	SignalWorkers_All();
+	WaitUntil( [ this ]() {
+		return !HasPendingLoadWork() && !HasPendingUnloadWork() && IsIdle();
+	} );
 }
 
 void FileResourceManager::WaitUntilNoLoadWork()
 {
-	while( HasPendingLoadWork() || !IsIdle() ) {
-		SignalWorkers_All();
-		std::this_thread::yield();
-		std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
-	}
+	SignalWorkers_All();
+	WaitUntil( [ this ]() {
+		return !HasPendingLoadWork() && IsIdle();
+	} );
 }
 
 void FileResourceManager::WaitUntilNoUnloadWork()
 {
-	while( HasPendingUnloadWork() || !IsIdle() ) {
-		SignalWorkers_All();
-		std::this_thread::yield();
-		std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
-	}
+	SignalWorkers_All();
+	WaitUntil( [ this ]() {
+		return !HasPendingUnloadWork() && IsIdle();
+	} );
 }
 
 void FileResourceManager::AllowResourceRequests( bool allow )
@@ -290,56 +577,90 @@ void FileResourceManager::AllowResourceUnloading( bool allow )
 	}
 }
 
+void FileResourceManager::SetResidentBudget( uint64_t bytes )
+{
+	resident_budget				= bytes;
+	SignalWorkers_One();
+}
+
+FileResourceManager::CacheStatistics FileResourceManager::GetCacheStatistics()
+{
+	CacheStatistics statistics {};
+	statistics.hits				= cache_hits;
+	statistics.misses			= cache_misses;
+	statistics.evictions		= cache_evictions;
+	statistics.resident_bytes	= resident_bytes;
+	statistics.budget			= resident_budget;
+	{
+		std::lock_guard<std::mutex> unload_queue_guard( mutex_unload_queue );
+		statistics.cached_bytes	= unload_queue_bytes;
+	}
+	return statistics;
+}
+
 void FileResourceManager::ScrapFileResources()
 {
+	// unload everything regardless of the resident budget
+	unload_all_unused			= true;
+
 	// set all resources to have no users
-	{
-		std::lock_guard<std::mutex> lock_guard( mutex_resources_list );
-		for( auto & r : resources_list ) {
+	for( auto & shard : resource_shards ) {
+		std::lock_guard<std::mutex> lock_guard( shard.mutex );
+		for( auto & r : shard.resources ) {
 			std::lock_guard<std::mutex> resource_guard( r.second->mutex );
 			r.second->users		= 0;
+			QueueForUnload( r.second.Get() );
 		}
 	}
 
 	// wait until all resources have been destroyed
-	uint32_t resource_count = UINT32_MAX;
-	while( resource_count ) {
-		SignalWorkers_All();
-		std::this_thread::yield();
-		std::this_thread::sleep_for( std::chrono::milliseconds( 150 ) );
-		{
-			std::lock_guard<std::mutex> lock_guard( mutex_resources_list );
-			resource_count = uint32_t( resources_list.size() );
+	SignalWorkers_All();
+	WaitUntil( [ this ]() {
+		for( auto & shard : resource_shards ) {
+			std::lock_guard<std::mutex> lock_guard( shard.mutex );
+			if( shard.resources.size() ) return false;
 		}
-	}
+		return true;
+	} );
 }
 
-FileResource::Type FileResourceManager::GetFileResourceTypeFromExtension( const Path & path ) const
+FileResource::Type FileResourceManager::GetFileResourceTypeFromExtension( AssetID asset_id ) const
 {
-	Path extension = path.extension();
-	
-	if( extension == ".xml" ) {
-		return FileResource::Type::XML;
-	}
-	if( extension == ".lua" ) {
-		return FileResource::Type::XML;
-	}
-	if( extension == ".me3d" ) {
-		return FileResource::Type::MESH;
+	struct ExtensionType
+	{
+		const char				*	extension;
+		FileResource::Type			type;
+	};
+	static const ExtensionType extension_types[] = {
+		{ ".xml",	FileResource::Type::XML },
+		{ ".lua",	FileResource::Type::LUA },
+		{ ".me3d",	FileResource::Type::MESH },
+		{ ".amesh",	FileResource::Type::MESH },
+		{ ".png",	FileResource::Type::IMAGE },
+		{ ".jpg",	FileResource::Type::IMAGE },
+		{ ".jpeg",	FileResource::Type::IMAGE },
+		{ ".tga",	FileResource::Type::IMAGE },
+		{ ".bmp",	FileResource::Type::IMAGE },
+		{ ".psd",	FileResource::Type::IMAGE },
+		{ ".gif",	FileResource::Type::IMAGE },
+		{ ".hdr",	FileResource::Type::IMAGE },
+		{ ".pic",	FileResource::Type::IMAGE },
+		{ ".pnm",	FileResource::Type::IMAGE },
+		{ ".pgm",	FileResource::Type::IMAGE },
+		{ ".ppm",	FileResource::Type::IMAGE },
+	};
+
+	// normalized path is lower case with forward slashes, extension starts from the last dot of the file name
+	auto & path		= asset_id.GetNormalizedPath();
+	auto dot		= path.find_last_of( "./" );
+	if( dot == String::npos || path[ dot ] != '.' ) {
+		return FileResource::Type::RAW_DATA;
 	}
-	if( extension == ".png" ||
-		extension == ".jpg" ||
-		extension == ".jpeg" ||
-		extension == ".tga" ||
-		extension == ".bmp" ||
-		extension == ".psd" ||
-		extension == ".gif" ||
-		extension == ".hdr" ||
-		extension == ".pic" ||
-		extension == ".pnm" ||
-		extension == ".pgm" ||
-		extension == ".ppm" ) {
-		return FileResource::Type::IMAGE;
+	auto extension	= path.c_str() + dot;
+	for( auto & e : extension_types ) {
+		if( std::strcmp( extension, e.extension ) == 0 ) {
+			return e.type;
+		}
 	}
 
 	return FileResource::Type::RAW_DATA;
@@ -375,9 +696,9 @@ UniquePointer<FileResource> FileResourceManager::CreateResource( const FileResou
 	return nullptr;
 }
 
-UniquePointer<FileResource> FileResourceManager::CreateResource( const Path & path )
+UniquePointer<FileResource> FileResourceManager::CreateResource( AssetID asset_id )
 {
-	return CreateResource( GetFileResourceTypeFromExtension( path ) );
+	return CreateResource( GetFileResourceTypeFromExtension( asset_id ) );
 }
 
 }
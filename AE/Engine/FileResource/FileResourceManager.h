@@ -4,6 +4,8 @@
 #include <mutex>
 #include <atomic>
 #include <array>
+#include <functional>
+#include <condition_variable>
 
 #include "../BUILD_OPTIONS.h"
 #include "../Platform.h"
@@ -20,55 +22,167 @@ namespace AE
 class Engine;
 class Logger;
 class FileResource;
+class JobSystem;
 
 class FileResourceManager : SubSystem
 {
 	friend class Engine;
-	friend void FileWorkerThread( Engine * engine, FileResourceManager * file_resource_manager, std::atomic_bool * thread_sleeping );
+	friend class FileResource;
+	friend void FileWorkerJob( Engine * engine, FileResourceManager * file_resource_manager );
 
 public:
+	struct CacheStatistics
+	{
+		uint64_t							hits;						// requests of resources that were already loaded or loading
+		uint64_t							misses;						// requests that created a new resource
+		uint64_t							evictions;					// resources unloaded after they had no users
+		uint64_t							resident_bytes;				// memory used by all loaded resources
+		uint64_t							cached_bytes;				// part of resident bytes used by resources with no users
+		uint64_t							budget;
+	};
+
+	struct ResourceRequest
+	{
+		AssetID								asset_id;
+		ResourcePriority					priority					= ResourcePriority::NORMAL;
+	};
+
 											FileResourceManager( Engine * engine );
 											~FileResourceManager();
 
-	FileResourceHandle<FileResource>		RequestResource( const Path & resource_path );
+	// requesting an already requested resource with a higher priority bumps its priority if it's still waiting to be loaded
+	FileResourceHandle<FileResource>		RequestResource( AssetID asset_id, ResourcePriority priority = ResourcePriority::NORMAL );
+	// interns the path first, prefer keeping the asset id when requesting the same resource often
+	FileResourceHandle<FileResource>		RequestResource( const Path & resource_path, ResourcePriority priority = ResourcePriority::NORMAL );
+	// requests many resources at once, handles are returned in request order and are null for invalid ids
+	// each lookup shard and list is locked once for the whole batch, the same id requested more than once
+	// shares one resource with the highest priority of the requests, workers are signaled once
+	Vector<FileResourceHandle<FileResource>>	RequestResources( const Vector<ResourceRequest> & requests );
+	// raises the priority of a resource that is still waiting to be loaded, lower priorities are ignored
+	void									BumpResourcePriority( FileResource * resource, ResourcePriority priority );
 
 	void									SignalWorkers_One();
 	void									SignalWorkers_All();
 
 	void									Update();					// general update of the resource manager, should be called once in every frame
 	bool									HasPendingLoadWork();		// fast, just checks the size of a load and continue load lists
-	bool									HasPendingUnloadWork();		// relatively slow, loops through every resource in memory
-	bool									IsIdle();					// tells if the worker threads are idle, fast but doesn't tell if there's pending work
+	bool									HasPendingUnloadWork();		// fast, just checks the size of the unload queue
+	bool									IsIdle();					// tells if no worker jobs are running, fast but doesn't tell if there's pending work
 	void									WaitIdle();					// pauses the excecution of the calling thread until resource manager becomes idle, can be used in realtime but not preferred
-	void									WaitJobless();				// pauses the excecution of the calling thread until resource manager is completely without work and worker threads become idle, NO REALTIME USE
-	void									WaitUntilNoLoadWork();		// pauses the excecution of the calling thread until all pending resources have been loaded and worker threads become idle, NO REALTIME USE
-	void									WaitUntilNoUnloadWork();	// pauses the excecution of the calling thread until all pending resources have been unloaded and worker threads become idle, NO REALTIME USE
+	void									WaitJobless();				// pauses the excecution of the calling thread until resource manager is completely without work and worker jobs have finished, NO REALTIME USE
+	void									WaitUntilNoLoadWork();		// pauses the excecution of the calling thread until all pending resources have been loaded and worker jobs have finished, NO REALTIME USE
+	void									WaitUntilNoUnloadWork();	// pauses the excecution of the calling thread until all pending resources have been unloaded and worker jobs have finished, NO REALTIME USE
 
 	void									AllowResourceRequests( bool allow );
 	void									AllowResourceLoading( bool allow );
 	void									AllowResourceUnloading( bool allow );
 
+	// resources with no users are kept loaded until all resources together use more than the budget
+	void									SetResidentBudget( uint64_t bytes );
+	CacheStatistics							GetCacheStatistics();
+
 protected:
 	void									ScrapFileResources();
 
 private:
-	FileResource::Type						GetFileResourceTypeFromExtension( const Path & path ) const;
+	FileResource::Type						GetFileResourceTypeFromExtension( AssetID asset_id ) const;
 	UniquePointer<FileResource>				CreateResource( const FileResource::Type resource_type );
-	UniquePointer<FileResource>				CreateResource( const Path & path );
+	UniquePointer<FileResource>				CreateResource( AssetID asset_id );
+
+	// load list is ordered by priority first and by request order second
+	struct LoadListKey
+	{
+		ResourcePriority					priority;
+		uint64_t							sequence;
+
+		bool operator<( const LoadListKey & other ) const
+		{
+			if( priority != other.priority ) return uint32_t( priority ) > uint32_t( other.priority );
+			return sequence < other.sequence;
+		}
+	};
+
+	// resources are stored by asset id, each shard has its own mutex so that
+	// requests for different resources rarely contend on the same lock
+	struct ResourceShard
+	{
+		std::mutex											mutex;
+		UnorderedMap<AssetID, UniquePointer<FileResource>, AssetID::Hasher>	resources;
+	};
+
+	struct OpenedResource
+	{
+		FileResource					*	resource;
+		FileStream						*	stream;
+	};
+
+	ResourceShard						&	GetResourceShard( AssetID asset_id );
+	static uint32_t							GetResourceShardIndex( AssetID asset_id );
+
+	// moves a resource that hasn't been submitted for reading yet to it's new priority, mutex_load_list must be locked when calling this
+	void									MoveInLoadList( FileResource * resource, ResourcePriority priority );
+
+	// starts a new worker job on the job system unless the maximum amount of them are already running
+	void									ScheduleWorkerJob();
+	// runs worker passes for as long as they're requested, body of every worker job
+	void									RunWorkerJob();
+	// wakes up threads blocked in the wait functions so they can check their condition again
+	void									NotifyWorkDone();
+	// blocks the calling thread until is_done returns true, condition is checked every time a worker job finishes
+	void									WaitUntil( std::function<bool()> is_done );
+
+	// submits queued resources to the file system I/O threads, returns true if anything was submitted
+	bool									SubmitQueuedReads();
+
+	// queues a resource with no users for unloading, resources are checked again before unloading
+	// because they may have been requested again while waiting in the queue
+	// unload queue is also the least recently used list, front is unloaded first
+	void									QueueForUnload( FileResource * resource );
+	// releases a user of a resource and queues it for unloading if it was the last one, both are done while
+	// mutex_unload_queue is locked so that the resource can't be unloaded before it's users are released
+	uint32_t								DecrementUsers( FileResource * resource );
+	// called once loading has finished, resources are never queued for unloading before this
+	// so that the worker loading them can't have them unloaded from under it
+	void									AllowUnloading( FileResource * resource );
+	// mutex_unload_queue must be locked when calling these
+	void									AddToUnloadQueue( FileResource * resource );
+	void									RemoveFromUnloadQueue( FileResource * resource );
+	// updates the resident bytes after a resource has been loaded
+	void									SetResidentSize( FileResource * resource, size_t resident_size );
+	// true if resources in the unload queue should be unloaded now
+	bool									IsOverResidentBudget() const;
 
 	FileSystem							*	p_filesystem							= nullptr;
+	JobSystem							*	p_job_system							= nullptr;
 
-	std::condition_variable					worker_threads_wakeup;
-	std::mutex								worker_threads_wakeup_mutex;
-	std::atomic_bool						worker_threads_should_exit;
-	std::array<std::atomic_bool, BUILD_FILE_RESOURCE_MANAGER_WORKER_THREAD_COUNT>	worker_threads_sleeping;
-	std::array<std::thread, BUILD_FILE_RESOURCE_MANAGER_WORKER_THREAD_COUNT>		worker_threads;
+	// worker jobs are scheduled on demand, at most BUILD_FILE_RESOURCE_MANAGER_WORKER_THREAD_COUNT at a time
+	// running also counts jobs that have been submitted but not started yet
+	std::atomic<uint32_t>					worker_jobs_running						{ 0 };
+	std::atomic_bool						worker_jobs_requested					{ false };
+	std::atomic_bool						worker_jobs_should_exit					{ false };
 
-	std::mutex								mutex_resources_list;
-	std::mutex								mutex_load_list;
+	std::mutex								mutex_work_done;
+	std::condition_variable					work_done;
 
-	Map<Path, UniquePointer<FileResource>>	resources_list;
-	Map<Path, FileResource*>				load_list;
+	std::mutex								mutex_load_list;
+	std::mutex								mutex_opened_list;
+	std::mutex								mutex_unload_queue;
+
+	Array<ResourceShard, BUILD_RESOURCE_MANAGER_LOOKUP_SHARD_COUNT>	resource_shards;
+	Map<LoadListKey, FileResource*>			load_list;
+	uint64_t								load_list_sequence						= 0;
+	// resources that have been read by the file system and are waiting to be parsed
+	List<OpenedResource>					opened_list;
+	std::atomic<uint32_t>					reads_in_flight							{ 0 };
+	List<FileResource*>						unload_queue;
+	uint64_t								unload_queue_bytes						= 0;	// guarded by mutex_unload_queue
+
+	std::atomic<uint64_t>					resident_bytes							{ 0 };
+	std::atomic<uint64_t>					resident_budget							{ BUILD_FILE_RESOURCE_MANAGER_RESIDENT_BUDGET };
+	std::atomic_bool						unload_all_unused						{ false };
+	std::atomic<uint64_t>					cache_hits								{ 0 };
+	std::atomic<uint64_t>					cache_misses							{ 0 };
+	std::atomic<uint64_t>					cache_evictions							{ 0 };
 
 	std::atomic_bool						allow_resource_requests;
 	std::atomic_bool						allow_resource_loading;
@@ -3,8 +3,6 @@
 #include <array>
 //#include <png.h>
 
-#define STBI_FAILURE_USERMSG
-#define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 #include "FileResource_Image.h"
@@ -319,6 +317,11 @@ const ImageData & FileResource_Image::GetImageData() const
 	return image_data;
 }
 
+size_t FileResource_Image::GetResidentSize() const
+{
+	return image_data.image_bytes.size();
+}
+
 uint32_t FileResource_Image::GetWidth() const
 {
 	return image_data.width;
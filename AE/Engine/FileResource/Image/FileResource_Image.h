@@ -30,6 +30,8 @@ public:
 	uint32_t				GetBytesPerRow() const;
 	VkBool32				GetHasAlpha() const;
 
+	size_t					GetResidentSize() const;
+
 private:
 	ImageData				image_data;
 };
@@ -13,20 +13,31 @@ FileResource_Lua::~FileResource_Lua()
 {
 }
 
-const Vector<char>& FileResource_Lua::GetScript() const
+ArrayView<const char> FileResource_Lua::GetScript() const
 {
-	return script;
+	if( script ) {
+		return script->GetData();
+	}
+	return {};
+}
+
+size_t FileResource_Lua::GetResidentSize() const
+{
+	if( script ) {
+		return script->Size();
+	}
+	return 0;
 }
 
 bool FileResource_Lua::Load( FileStream * stream, const Path & path )
 {
-	script = stream->GetRawStream();
+	script	= stream->GetFileData();
 	return true;
 }
 
 bool FileResource_Lua::Unload()
 {
-	script.clear();
+	script	= nullptr;
 	return true;
 }
 
@@ -14,13 +14,16 @@ public:
 	FileResource_Lua( Engine * engine, FileResourceManager * file_resource_manager );
 	~FileResource_Lua();
 
-	const Vector<char>		&	GetScript() const;
+	ArrayView<const char>		GetScript() const;
+
+	size_t						GetResidentSize() const;
 
 private:
 	bool						Load( FileStream * stream, const Path & path );
 	bool						Unload();
 
-	Vector<char>				script;
+	// file contents are shared with the file stream, not copied
+	SharedPointer<FileData>		script;
 };
 
 }
@@ -0,0 +1,238 @@
+
+#include <assert.h>
+#include <cstring>
+#include <fstream>
+
+#include "CookedMeshFile.h"
+#include "ME3DFile.h"
+#include "MeshDecode.h"
+
+#include "../../FileSystem/FileStream.h"
+#include "../../FileSystem/FileArchive.h"
+#include "../../Logger/Logger.h"
+
+namespace AE
+{
+
+constexpr char CookedMeshFile::MAGIC[ 4 ];
+constexpr char CookedMeshFile::EXTENSION[];
+
+namespace engine_internal
+{
+
+uint64_t CookedMesh_AlignUp( uint64_t value, uint64_t alignment )
+{
+	return ( value + alignment - 1 ) / alignment * alignment;
+}
+
+// overflow safe check that [ offset, offset + size ) is inside [ 0, total_size )
+bool CookedMesh_IsRangeInside( uint64_t offset, uint64_t size, uint64_t total_size )
+{
+	return offset <= total_size && size <= total_size - offset;
+}
+
+// sets the offsets and sizes the device block, contents are left for the caller
+void CookedMesh_LayoutDeviceBlock( MeshData & mesh_data, uint32_t polygon_count, uint32_t vertex_count, VertexFormat vertex_format )
+{
+	mesh_data.polygon_count		= polygon_count;
+	mesh_data.vertex_count		= vertex_count;
+	mesh_data.vertex_format		= vertex_format;
+	mesh_data.index_offset		= 0;
+	mesh_data.vertex_offset		= size_t( CookedMesh_AlignUp( uint64_t( polygon_count ) * sizeof( Polygon ), CookedMeshFile::DEVICE_BLOCK_ALIGNMENT ) );
+	mesh_data.device_block.resize( mesh_data.vertex_offset + size_t( vertex_count ) * GetVertexSize( vertex_format ) );
+}
+
+bool CookedMesh_CookFile( const Path & source, const Path & destination, VertexFormat vertex_format, MeshOptimization optimization, Logger * logger )
+{
+	ME3D_File me3d;
+	if( !me3d.Load( source.string().c_str() ) ) {
+		if( logger ) logger->LogError( String( "Couldn't load mesh: " ) + source.string().c_str() );
+		return false;
+	}
+	MeshData mesh_data;
+	if( !CookedMeshFile::ConvertME3D( me3d, mesh_data, vertex_format ) ) {
+		if( logger ) logger->LogError( String( "Couldn't convert mesh: " ) + source.string().c_str() );
+		return false;
+	}
+	if( optimization != MeshOptimization::NONE ) {
+		MeshOptimizationReport report;
+		if( Mesh_Optimize( mesh_data, optimization, &report ) ) {
+			if( logger ) logger->LogInfo( String( "Optimized mesh: " ) + source.string().c_str() + ", " + Mesh_GetOptimizationReportText( report ) );
+		} else {
+			if( logger ) logger->LogWarning( String( "Couldn't optimize mesh, indices out of range: " ) + source.string().c_str() );
+		}
+	}
+	if( destination.has_parent_path() ) {
+		std::error_code error;
+		fsys::create_directories( destination.parent_path(), error );
+	}
+	if( !CookedMeshFile::Write( mesh_data, destination ) ) {
+		if( logger ) logger->LogError( String( "Couldn't write cooked mesh: " ) + destination.string().c_str() );
+		return false;
+	}
+	if( logger ) logger->LogInfo( String( "Cooked mesh: " ) + destination.string().c_str() );
+	return true;
+}
+
+}
+
+bool CookedMeshFile::IsCookedMesh( FileStream * stream )
+{
+	assert( nullptr != stream );
+	if( stream->Size() < sizeof( Header ) ) return false;
+
+	char magic[ 4 ] {};
+	stream->ReadRange( 0, magic, sizeof( magic ) );
+	return std::memcmp( magic, MAGIC, sizeof( MAGIC ) ) == 0;
+}
+
+bool CookedMeshFile::LoadFromFileStream( FileStream * stream, MeshData & mesh_data )
+{
+	assert( nullptr != stream );
+	mesh_data						= MeshData();
+
+	size_t stream_size				= stream->Size();
+	if( stream_size < sizeof( Header ) ) return false;
+
+	Header head {};
+	stream->Seek( 0 );
+	stream->Read( &head, 1 );
+
+	if( std::memcmp( head.magic, MAGIC, sizeof( MAGIC ) ) != 0 )	return false;
+	if( head.version != VERSION )									return false;
+	if( head.file_size != stream_size )								return false;
+	// the device block is used as is, vertex layout of the engine has to match
+	if( head.vertex_format != uint32_t( VertexFormat::FLOAT ) && head.vertex_format != uint32_t( VertexFormat::COMPACT ) )	return false;
+	auto vertex_format				= VertexFormat( head.vertex_format );
+	if( head.vertex_size != GetVertexSize( vertex_format ) )		return false;
+	if( head.polygon_size != sizeof( Polygon ) )					return false;
+	if( !engine_internal::CookedMesh_IsRangeInside( head.device_block_offset, head.device_block_size, stream_size ) )									return false;
+	if( !engine_internal::CookedMesh_IsRangeInside( head.index_offset, uint64_t( head.polygon_count ) * sizeof( Polygon ), head.device_block_size ) )		return false;
+	if( !engine_internal::CookedMesh_IsRangeInside( head.vertex_offset, uint64_t( head.vertex_count ) * head.vertex_size, head.device_block_size ) )		return false;
+	if( !engine_internal::CookedMesh_IsRangeInside( head.copy_vertices_offset, uint64_t( head.copy_vertex_count ) * sizeof( CopyVertex ), stream_size ) )	return false;
+
+	mesh_data.polygon_count			= head.polygon_count;
+	mesh_data.vertex_count			= head.vertex_count;
+	mesh_data.index_offset			= size_t( head.index_offset );
+	mesh_data.vertex_offset			= size_t( head.vertex_offset );
+	mesh_data.vertex_format			= vertex_format;
+	mesh_data.position_offset		= glm::vec3( head.position_offset[ 0 ], head.position_offset[ 1 ], head.position_offset[ 2 ] );
+	mesh_data.position_scale		= glm::vec3( head.position_scale[ 0 ], head.position_scale[ 1 ], head.position_scale[ 2 ] );
+	mesh_data.copy_vertices.resize( head.copy_vertex_count );
+
+	// whole file streams are memory mapped or already in memory, the device block is used in place if the
+	// vertices and polygons in it are aligned, othervise it's read straight from the file into the destination
+	auto file_data					= ( stream->GetMode() == FileStream::Mode::WHOLE_FILE ) ? stream->GetFileData() : nullptr;
+	auto file_device_block			= file_data ? reinterpret_cast<const uint8_t*>( file_data->GetData().data() ) + head.device_block_offset : nullptr;
+	if( file_device_block && ( uintptr_t( file_device_block ) % alignof( Vertex ) ) == 0 ) {
+		mesh_data.file_data			= file_data;
+		mesh_data.file_device_block	= ArrayView<const uint8_t>( file_device_block, size_t( head.device_block_size ) );
+	} else {
+		mesh_data.device_block.resize( size_t( head.device_block_size ) );
+		stream->Seek( size_t( head.device_block_offset ) );
+		stream->Read( mesh_data.device_block.data(), mesh_data.device_block.size() );
+	}
+	stream->Seek( size_t( head.copy_vertices_offset ) );
+	stream->Read( mesh_data.copy_vertices.data(), mesh_data.copy_vertices.size() );
+
+	// indices go straight to the device, an index out of range would read outside of the vertex buffer
+	if( !Mesh_IsValid( mesh_data ) ) {
+		mesh_data					= MeshData();
+		return false;
+	}
+	return true;
+}
+
+bool CookedMeshFile::ConvertME3D( const ME3D_File & me3d, MeshData & mesh_data, VertexFormat vertex_format )
+{
+	mesh_data			= MeshData();
+	if( !me3d.IsLoaded() ) return false;
+
+	auto & me3d_v		= me3d.GetVertices();
+	auto & me3d_vc		= me3d.GetCopyVertices();
+	auto & me3d_p		= me3d.GetPolygons();
+
+	engine_internal::CookedMesh_LayoutDeviceBlock( mesh_data, uint32_t( me3d_p.size() ), uint32_t( me3d_v.size() ), vertex_format );
+	mesh_data.copy_vertices.resize( me3d_vc.size() );
+
+	auto vertices		= mesh_data.device_block.data() + mesh_data.vertex_offset;
+	auto polygons		= reinterpret_cast<Polygon*>( mesh_data.device_block.data() + mesh_data.index_offset );
+	if( vertex_format == VertexFormat::COMPACT ) {
+		ME3D_GetCompactPositionTransform( me3d_v.data(), me3d_v.size(), mesh_data.position_offset, mesh_data.position_scale );
+		ME3D_DecodeCompactVertices( me3d_v.data(), reinterpret_cast<VertexCompact*>( vertices ), me3d_v.size(), mesh_data.position_offset, mesh_data.position_scale );
+	} else {
+		ME3D_DecodeVertices( me3d_v.data(), reinterpret_cast<Vertex*>( vertices ), me3d_v.size() );
+	}
+	for( size_t i=0; i < me3d_vc.size(); ++i ) {
+		auto & s = me3d_vc[ i ];
+		auto & d = mesh_data.copy_vertices[ i ];
+		d.copy_from_index	= int32_t( s.copy_from_index );
+	}
+	for( size_t i=0; i < me3d_p.size(); ++i ) {
+		auto & s = me3d_p[ i ];
+		auto & d = polygons[ i ];
+		d.indices[ 0 ]	= int32_t( s.indices[ 0 ] );
+		d.indices[ 1 ]	= int32_t( s.indices[ 1 ] );
+		d.indices[ 2 ]	= int32_t( s.indices[ 2 ] );
+	}
+	return true;
+}
+
+bool CookedMeshFile::Write( const MeshData & mesh_data, const Path & path )
+{
+	Header head {};
+	std::memcpy( head.magic, MAGIC, sizeof( MAGIC ) );
+	head.version					= VERSION;
+	head.vertex_format				= uint32_t( mesh_data.vertex_format );
+	head.vertex_size				= uint32_t( GetVertexSize( mesh_data.vertex_format ) );
+	head.polygon_size				= sizeof( Polygon );
+	head.vertex_count				= mesh_data.vertex_count;
+	head.polygon_count				= mesh_data.polygon_count;
+	head.copy_vertex_count			= uint32_t( mesh_data.copy_vertices.size() );
+	head.device_block_alignment		= DEVICE_BLOCK_ALIGNMENT;
+	for( glm::length_t i=0; i < 3; ++i ) {
+		head.position_offset[ i ]	= mesh_data.position_offset[ i ];
+		head.position_scale[ i ]	= mesh_data.position_scale[ i ];
+	}
+	head.device_block_offset		= engine_internal::CookedMesh_AlignUp( sizeof( Header ), DEVICE_BLOCK_ALIGNMENT );
+	head.device_block_size			= mesh_data.device_block.size();
+	head.index_offset				= mesh_data.index_offset;
+	head.vertex_offset				= mesh_data.vertex_offset;
+	head.copy_vertices_offset		= head.device_block_offset + head.device_block_size;
+	head.file_size					= head.copy_vertices_offset + uint64_t( mesh_data.copy_vertices.size() ) * sizeof( CopyVertex );
+
+	std::ofstream file( path, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc );
+	if( !file.is_open() ) return false;
+
+	Vector<char> padding( size_t( head.device_block_offset - sizeof( Header ) ) );
+	file.write( (const char*)&head, sizeof( Header ) );
+	file.write( padding.data(), padding.size() );
+	file.write( (const char*)mesh_data.device_block.data(), mesh_data.device_block.size() );
+	file.write( (const char*)mesh_data.copy_vertices.data(), mesh_data.copy_vertices.size() * sizeof( CopyVertex ) );
+	return file.good();
+}
+
+bool CookedMeshFile::Cook( const Path & source, const Path & destination, VertexFormat vertex_format, MeshOptimization optimization, Logger * logger )
+{
+	if( !fsys::is_directory( source ) ) {
+		return engine_internal::CookedMesh_CookFile( source, destination, vertex_format, optimization, logger );
+	}
+
+	bool all_cooked		= true;
+	for( auto & i : fsys::recursive_directory_iterator( source ) ) {
+		if( !fsys::is_regular_file( i.path() ) ) continue;
+		if( FileArchive::NormalizePath( i.path().extension() ) != ".me3d" ) continue;
+
+		// recursive directory iterator paths always start with the source directory
+		auto relative_path	= i.path().string().substr( source.string().size() );
+		while( relative_path.size() && ( relative_path[ 0 ] == '/' || relative_path[ 0 ] == '\\' ) ) {
+			relative_path.erase( 0, 1 );
+		}
+		auto cooked_path	= destination / relative_path;
+		cooked_path.replace_extension( EXTENSION );
+		all_cooked			&= engine_internal::CookedMesh_CookFile( i.path(), cooked_path, vertex_format, optimization, logger );
+	}
+	return all_cooked;
+}
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <filesystem>
+
+#include "../../BUILD_OPTIONS.h"
+#include "../../Platform.h"
+
+#include "../../Memory/Memory.h"
+#include "../../CppFileSystem/CppFileSystem.h"
+#include "MeshInfo.h"
+#include "MeshOptimize.h"
+
+namespace AE
+{
+
+class Logger;
+class FileStream;
+class ME3D_File;
+
+// Cooked mesh file, the device block of the file is stored exactly as the device buffer needs it
+// so loading is a single read without any conversion. Cooked meshes are made from .me3d files
+// offline with Cook(), they depend on the engine vertex layout and have to be cooked again if it changes.
+// Meshes can be cooked with compact vertices, those can only be drawn with pipelines that read compact vertices.
+// Layout of the cooked mesh file:
+// - Header
+// - Device block, starts at an offset aligned to the device block alignment
+//   - Polygons at the index offset
+//   - Vertices at the vertex offset, aligned to the device block alignment
+// - Copy vertices
+class CookedMeshFile
+{
+public:
+	static constexpr char		MAGIC[ 4 ]							= { 'A', 'E', 'M', 'C' };
+	static constexpr uint32_t	VERSION								= 2;
+	static constexpr uint32_t	DEVICE_BLOCK_ALIGNMENT				= 256;
+	static constexpr char		EXTENSION[]							= ".amesh";
+
+	struct Header
+	{
+		char					magic[ 4 ];
+		uint32_t				version;
+		uint32_t				vertex_format;				// VertexFormat
+		uint32_t				vertex_size;				// must match GetVertexSize( vertex_format )
+		uint32_t				polygon_size;				// must match sizeof( Polygon )
+		uint32_t				vertex_count;
+		uint32_t				polygon_count;
+		uint32_t				copy_vertex_count;
+		uint32_t				device_block_alignment;
+		float					position_offset[ 3 ];
+		float					position_scale[ 3 ];
+		uint32_t				reserved;
+		uint64_t				file_size;
+		uint64_t				device_block_offset;		// from the start of the file
+		uint64_t				device_block_size;
+		uint64_t				index_offset;				// from the start of the device block
+		uint64_t				vertex_offset;				// from the start of the device block
+		uint64_t				copy_vertices_offset;		// from the start of the file
+	};
+
+	// true if the stream starts with the cooked mesh magic, doesn't move the cursor
+	static bool					IsCookedMesh( FileStream * stream );
+
+	// returns true if successfully loaded a file
+	static bool					LoadFromFileStream( FileStream * stream, MeshData & mesh_data );
+
+	// converts a loaded .me3d file into the device layout
+	static bool					ConvertME3D( const ME3D_File & me3d, MeshData & mesh_data, VertexFormat vertex_format = VertexFormat::FLOAT );
+
+	static bool					Write( const MeshData & mesh_data, const Path & path );
+
+	// Cooks a .me3d file, or every .me3d file in a directory and it's sub directories,
+	// directories are cooked into the same relative paths under the destination directory
+	// Meshes are optimized before they're written, vertex cache statistics are logged for every mesh
+	static bool					Cook( const Path & source, const Path & destination, VertexFormat vertex_format, MeshOptimization optimization, Logger * logger );
+};
+
+}
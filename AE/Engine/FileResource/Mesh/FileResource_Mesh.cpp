@@ -1,7 +1,14 @@
 
+#include <cstring>
+
 #include "FileResource_Mesh.h"
 
 #include "ME3DFile.h"
+#include "CookedMeshFile.h"
+#include "MeshOptimize.h"
+
+#include "../../Engine.h"
+#include "../../Logger/Logger.h"
 
 namespace AE
 {
@@ -9,6 +16,8 @@ namespace AE
 FileResource_Mesh::FileResource_Mesh( Engine * engine, FileResourceManager * file_resource_manager )
 	: FileResource( engine, file_resource_manager, FileResource::Type::MESH )
 {
+	// .me3d files are read section by section
+	stream_mode		= FileStream::Mode::STREAMING;
 }
 
 FileResource_Mesh::~FileResource_Mesh()
@@ -17,93 +26,130 @@ FileResource_Mesh::~FileResource_Mesh()
 
 bool FileResource_Mesh::Load( FileStream * stream, const Path & path )
 {
+	// cooked meshes are already in the device layout, .me3d files are converted while loading
+	if( CookedMeshFile::IsCookedMesh( stream ) ) {
+		return CookedMeshFile::LoadFromFileStream( stream, mesh_data );
+	}
 	ME3D_File me3d;
 	me3d.LoadFromFileStream( stream );
-	if( me3d.IsLoaded() ) {
-		auto me3d_v		= me3d.GetVertices();
-		auto me3d_vc	= me3d.GetCopyVertices();
-		auto me3d_p		= me3d.GetPolygons();
-
-		vertices.resize( me3d_v.size() );
-		copy_vertices.resize( me3d_vc.size() );
-		polygons.resize( me3d_p.size() );
-
-		for( size_t i=0; i < me3d_v.size(); ++i ) {
-			auto & s = me3d_v[ i ];
-			auto & d = vertices[ i ];
-			d.position		= glm::vec3( s.position[ 0 ], s.position[ 1 ], s.position[ 2 ] );
-			d.normal		= glm::vec3( ME3D_ShortToFloat( s.normals[ 0 ] ), ME3D_ShortToFloat( s.normals[ 1 ] ), ME3D_ShortToFloat( s.normals[ 2 ] ) );
-			d.uv			= glm::vec2( ME3D_ShortToFloat( s.uvs[ 0 ] ), ME3D_ShortToFloat( s.uvs[ 1 ] ) );
-			d.material		= int32_t( s.material_index );
-		}
-		for( size_t i=0; i < me3d_vc.size(); ++i ) {
-			auto & s = me3d_vc[ i ];
-			auto & d = copy_vertices[ i ];
-			d.copy_from_index	= int32_t( s.copy_from_index );
-		}
-		for( size_t i=0; i < me3d_p.size(); ++i ) {
-			auto & s = me3d_p[ i ];
-			auto & d = polygons[ i ];
-			d.indices[ 0 ]	= int32_t( s.indices[ 0 ] );
-			d.indices[ 1 ]	= int32_t( s.indices[ 1 ] );
-			d.indices[ 2 ]	= int32_t( s.indices[ 2 ] );
-		}
-		return true;
+	if( !CookedMeshFile::ConvertME3D( me3d, mesh_data ) ) return false;
+	if( !Mesh_IsValid( mesh_data ) ) {
+		p_engine->GetLogger()->LogError( String( "Mesh has indices out of range: " ) + path.string().c_str() );
+		mesh_data		= MeshData();
+		return false;
 	}
-	return false;
+
+#if BUILD_MESH_OPTIMIZE_ON_LOAD
+	MeshOptimizationReport report;
+	auto optimization	= ( BUILD_MESH_OPTIMIZE_ON_LOAD == 2 ) ? MeshOptimization::REORDER_AND_DEDUPLICATE : MeshOptimization::REORDER;
+	if( Mesh_Optimize( mesh_data, optimization, &report ) ) {
+		p_engine->GetLogger()->LogInfo( String( "Optimized mesh: " ) + path.string().c_str() + ", " + Mesh_GetOptimizationReportText( report ) );
+	}
+#endif
+	return true;
 }
 
 bool FileResource_Mesh::Unload()
 {
-	vertices.clear();
-	copy_vertices.clear();
-	polygons.clear();
+	mesh_data		= MeshData();
 	return true;
 }
 
-const Vector<Vertex>& FileResource_Mesh::GetVertices() const
+ArrayView<const Vertex> FileResource_Mesh::GetVertices() const
+{
+	if( mesh_data.vertex_format != VertexFormat::FLOAT ) return ArrayView<const Vertex>();
+	return ArrayView<const Vertex>( reinterpret_cast<const Vertex*>( mesh_data.GetDeviceBlock().data() + mesh_data.vertex_offset ), mesh_data.vertex_count );
+}
+
+ArrayView<const VertexCompact> FileResource_Mesh::GetCompactVertices() const
 {
-	return vertices;
+	if( mesh_data.vertex_format != VertexFormat::COMPACT ) return ArrayView<const VertexCompact>();
+	return ArrayView<const VertexCompact>( reinterpret_cast<const VertexCompact*>( mesh_data.GetDeviceBlock().data() + mesh_data.vertex_offset ), mesh_data.vertex_count );
 }
 
 const Vector<CopyVertex>& FileResource_Mesh::GetCopyVertices() const
 {
-	return copy_vertices;
+	return mesh_data.copy_vertices;
 }
 
-const Vector<Polygon>& FileResource_Mesh::GetPolygons() const
+ArrayView<const Polygon> FileResource_Mesh::GetPolygons() const
 {
-	return polygons;
+	return ArrayView<const Polygon>( reinterpret_cast<const Polygon*>( mesh_data.GetDeviceBlock().data() + mesh_data.index_offset ), mesh_data.polygon_count );
 }
 
-Vector<Vertex>& FileResource_Mesh::GetEditableVertices()
+ArrayView<Vertex> FileResource_Mesh::GetEditableVertices()
 {
-	return vertices;
+	MakeDeviceBlockEditable();
+	if( mesh_data.vertex_format != VertexFormat::FLOAT ) return ArrayView<Vertex>();
+	return ArrayView<Vertex>( reinterpret_cast<Vertex*>( mesh_data.device_block.data() + mesh_data.vertex_offset ), mesh_data.vertex_count );
+}
+
+ArrayView<VertexCompact> FileResource_Mesh::GetEditableCompactVertices()
+{
+	MakeDeviceBlockEditable();
+	if( mesh_data.vertex_format != VertexFormat::COMPACT ) return ArrayView<VertexCompact>();
+	return ArrayView<VertexCompact>( reinterpret_cast<VertexCompact*>( mesh_data.device_block.data() + mesh_data.vertex_offset ), mesh_data.vertex_count );
 }
 
 Vector<CopyVertex>& FileResource_Mesh::GetEditableCopyVertices()
 {
-	return copy_vertices;
+	return mesh_data.copy_vertices;
+}
+
+ArrayView<Polygon> FileResource_Mesh::GetEditablePolygons()
+{
+	MakeDeviceBlockEditable();
+	return ArrayView<Polygon>( reinterpret_cast<Polygon*>( mesh_data.device_block.data() + mesh_data.index_offset ), mesh_data.polygon_count );
+}
+
+const MeshData & FileResource_Mesh::GetMeshData() const
+{
+	return mesh_data;
 }
 
-Vector<Polygon>& FileResource_Mesh::GetEditablePolygons()
+VertexFormat FileResource_Mesh::GetVertexFormat() const
 {
-	return polygons;
+	return mesh_data.vertex_format;
 }
 
 size_t FileResource_Mesh::GetVerticesByteSize() const
 {
-	return vertices.size() * sizeof( Vertex );
+	return size_t( mesh_data.vertex_count ) * GetVertexSize( mesh_data.vertex_format );
 }
 
 size_t FileResource_Mesh::GetCopyVerticesByteSize() const
 {
-	return copy_vertices.size() * sizeof( CopyVertex );
+	return mesh_data.copy_vertices.size() * sizeof( CopyVertex );
 }
 
 size_t FileResource_Mesh::GetPolygonsByteSize() const
 {
-	return polygons.size() * sizeof( Polygon );
+	return size_t( mesh_data.polygon_count ) * sizeof( Polygon );
+}
+
+size_t FileResource_Mesh::GetResidentSize() const
+{
+	return mesh_data.GetDeviceBlock().size() + GetCopyVerticesByteSize();
+}
+
+FileStream::Mode FileResource_Mesh::GetStreamMode() const
+{
+	auto asset_id				= GetAssetID();
+	auto & path					= asset_id.GetNormalizedPath();
+	auto extension_length		= std::strlen( CookedMeshFile::EXTENSION );
+	if( path.size() >= extension_length && path.compare( path.size() - extension_length, extension_length, CookedMeshFile::EXTENSION ) == 0 ) {
+		return FileStream::Mode::WHOLE_FILE;
+	}
+	return stream_mode;
+}
+
+void FileResource_Mesh::MakeDeviceBlockEditable()
+{
+	if( !mesh_data.file_data ) return;
+	auto file_device_block		= mesh_data.file_device_block;
+	mesh_data.device_block.assign( file_device_block.begin(), file_device_block.end() );
+	mesh_data.file_device_block	= ArrayView<const uint8_t>();
+	mesh_data.file_data			= nullptr;
 }
 
 }
@@ -20,22 +20,34 @@ public:
 	bool								Load( FileStream * stream, const Path & path );
 	bool								Unload();
 
-	const Vector<Vertex>			&	GetVertices() const;
+	// vertices are returned only in the format the mesh is stored in, the other returns an empty view
+	ArrayView<const Vertex>				GetVertices() const;
+	ArrayView<const VertexCompact>		GetCompactVertices() const;
 	const Vector<CopyVertex>		&	GetCopyVertices() const;
-	const Vector<Polygon>			&	GetPolygons() const;
+	ArrayView<const Polygon>			GetPolygons() const;
 
-	Vector<Vertex>					&	GetEditableVertices();
+	ArrayView<Vertex>					GetEditableVertices();
+	ArrayView<VertexCompact>			GetEditableCompactVertices();
 	Vector<CopyVertex>				&	GetEditableCopyVertices();
-	Vector<Polygon>					&	GetEditablePolygons();
+	ArrayView<Polygon>					GetEditablePolygons();
+
+	// polygons and vertices in the layout of the device buffer
+	const MeshData					&	GetMeshData() const;
+	VertexFormat						GetVertexFormat() const;
 
 	size_t								GetVerticesByteSize() const;
 	size_t								GetCopyVerticesByteSize() const;
 	size_t								GetPolygonsByteSize() const;
 
+	size_t								GetResidentSize() const;
+
 private:
-	Vector<Vertex>						vertices;
-	Vector<CopyVertex>					copy_vertices;
-	Vector<Polygon>						polygons;
+	// cooked meshes are opened as whole files so that they can be used in place
+	FileStream::Mode					GetStreamMode() const;
+	// copies a device block that is used in place from the file into mesh_data.device_block
+	void								MakeDeviceBlockEditable();
+
+	MeshData							mesh_data;
 };
 
 }
@@ -16,12 +16,12 @@ constexpr float ME3D_SHORT_TO_FLOAT					= 1 / ME3D_FLOAT_TO_SHORT;
 
 typedef		uint16_t		me3d_str_size_t;		// 16 bits is enough to handle character strings used by me3d
 
-uint16_t ME3D_FloatToShort( float value )
+int16_t ME3D_FloatToShort( float value )
 {
-	return uint16_t( ME3D_FLOAT_TO_SHORT * value );
+	return int16_t( ME3D_FLOAT_TO_SHORT * value );
 }
 
-float ME3D_ShortToFloat( uint16_t value )
+float ME3D_ShortToFloat( int16_t value )
 {
 	return float( ME3D_SHORT_TO_FLOAT * value );
 }
@@ -61,6 +61,24 @@ String ME3D_ReadStringFromStream( FileStream * stream )
 	return str;
 }
 
+// sections are read with one bulk read when the struct size in the file matches ours,
+// files with smaller structs are read element by element and the missing fields are left zero
+template<typename T>
+void ME3D_ReadSectionFromStream( FileStream * stream, T * destination, int32_t location, int32_t count, int32_t element_size )
+{
+	assert( nullptr != stream );
+	assert( size_t( element_size ) <= sizeof( T ) );
+
+	stream->Seek( size_t( location ) );
+	if( size_t( element_size ) == sizeof( T ) ) {
+		stream->Read( destination, size_t( count ) );
+	} else {
+		for( int32_t i=0; i < count; ++i ) {
+			stream->Read( (char*)&destination[ i ], size_t( element_size ) );
+		}
+	}
+}
+
 void ME3D_WriteStringFromStream( FileStream * stream, String str )
 {
 	assert( nullptr != stream );
@@ -151,6 +169,7 @@ bool ME3D_File::Load( String path )
 		m.identifier		= ME3D_ReadString( &file );
 		int32_t data_lenght	= 0;
 		file.read( (char*)&data_lenght, sizeof( data_lenght ) );
+		m.data.resize( data_lenght );
 		file.read( m.data.data(), m.data.size() );
 	}
 
@@ -192,40 +211,22 @@ bool ME3D_File::LoadFromFileStream( FileStream * stream )
 	if( head.vert_size > sizeof( ME3D_Vertex ) )			return false;
 	if( head.vert_copy_size > sizeof( ME3D_VertexCopy ) )	return false;
 	if( head.polygon_size > sizeof( ME3D_Polygon ) )		return false;
+	// sections are read directly from their locations, streaming file streams only load those parts of the file
+	auto SectionFits = [ stream_size ]( int32_t location, int32_t count, int32_t size ) {
+		return location >= 0 && count >= 0 && size >= 0 && uint64_t( location ) + uint64_t( count ) * uint64_t( size ) <= stream_size;
+	};
+	if( !SectionFits( head.vert_location, head.vert_count, head.vert_size ) )					return false;
+	if( !SectionFits( head.vert_copy_location, head.vert_copy_count, head.vert_copy_size ) )	return false;
+	if( !SectionFits( head.polygon_location, head.polygon_count, head.polygon_size ) )			return false;
 	// if we got here we can be pretty sure we are reading a compatible file
 
-	// we can check the padding of the data
-	bool aligned_vertices		= false;
-	bool aligned_vertex_copies	= false;
-	bool aligned_polygons		= false;
-	if( head.vert_size			== sizeof( ME3D_Vertex ) )		aligned_vertices		= true;
-	if( head.vert_copy_size		== sizeof( ME3D_VertexCopy ) )	aligned_vertex_copies	= true;
-	if( head.polygon_size		== sizeof( ME3D_Polygon ) )		aligned_polygons		= true;
-
 	vertices.resize( head.vert_count + head.vert_copy_count );
 	vertex_copies.resize( head.vert_copy_count );
 	polygons.resize( head.polygon_count );
 
-	// based on the way that the data is padded we can either copy it all at once or one at a time
-	// not sure if this does anything to the loading speed but lets do this because why not
-	stream->Seek( head.vert_location );
-	{
-		for( int32_t i=0; i < head.vert_count; ++i ) {
-			vertices[ i ] = stream->Read<ME3D_Vertex>();
-		}
-	}
-	stream->Seek( head.vert_copy_location );
-	{
-		for( int32_t i=0; i < head.vert_copy_count; ++i ) {
-			vertex_copies[ i ] = stream->Read<ME3D_VertexCopy>();
-		}
-	}
-	stream->Seek( head.polygon_location );
-	{
-		for( int32_t i=0; i < head.polygon_count; ++i ) {
-			polygons[ i ] = stream->Read<ME3D_Polygon>();
-		}
-	}
+	ME3D_ReadSectionFromStream( stream, vertices.data(), head.vert_location, head.vert_count, head.vert_size );
+	ME3D_ReadSectionFromStream( stream, vertex_copies.data(), head.vert_copy_location, head.vert_copy_count, head.vert_copy_size );
+	ME3D_ReadSectionFromStream( stream, polygons.data(), head.polygon_location, head.polygon_count, head.polygon_size );
 	meta_data.resize( head.metadata_count );
 	stream->Seek( head.metadata_location );
 	for( int32_t i=0; i < head.metadata_count; ++i ) {
@@ -235,6 +236,10 @@ bool ME3D_File::LoadFromFileStream( FileStream * stream )
 		stream->Read( m.data.data(), m.data.size() );
 	}
 
+	for( auto & c : vertex_copies ) {
+		if( c.copy_from_index < 0 || c.copy_from_index >= head.vert_count ) return false;
+	}
+
 	// we also need to calculate the copy vertices, but those
 	// take the coordinates of the the vertext it's copying
 	for( int32_t i=0; i < head.vert_copy_count; ++i ) {
@@ -67,8 +67,9 @@ struct ME3D_Polygon
 	int32_t			indices[ 3 ];
 };
 
-uint16_t ME3D_FloatToShort( float value );
-float ME3D_ShortToFloat( uint16_t value );
+// normals and uvs are stored as signed 16 bit values in the -1 to 1 range
+int16_t ME3D_FloatToShort( float value );
+float ME3D_ShortToFloat( int16_t value );
 
 class ME3D_File
 {
@@ -0,0 +1,126 @@
+
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#include "MeshDecode.h"
+
+#if AE_MESH_DECODE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace AE
+{
+
+static_assert( sizeof( ME3D_Vertex ) == 24, "Decoder expects packed .me3d vertices" );
+static_assert( sizeof( Vertex ) == 36, "Decoder expects tightly packed engine vertices" );
+static_assert( offsetof( ME3D_Vertex, normals ) == 12 && offsetof( ME3D_Vertex, material_index ) == 22, "Decoder expects .me3d vertex layout" );
+static_assert( offsetof( Vertex, normal ) == 12 && offsetof( Vertex, uv ) == 24 && offsetof( Vertex, material ) == 32, "Decoder expects engine vertex layout" );
+static_assert( sizeof( VertexCompact ) == 20, "Graphics pipelines expect tightly packed compact vertices" );
+
+namespace engine_internal
+{
+
+void ME3D_DecodeVertices_Scalar( const ME3D_Vertex * source, Vertex * destination, size_t count )
+{
+	for( size_t i=0; i < count; ++i ) {
+		auto & s = source[ i ];
+		auto & d = destination[ i ];
+		d.position		= glm::vec3( s.position[ 0 ], s.position[ 1 ], s.position[ 2 ] );
+		d.normal		= glm::vec3( ME3D_ShortToFloat( s.normals[ 0 ] ), ME3D_ShortToFloat( s.normals[ 1 ] ), ME3D_ShortToFloat( s.normals[ 2 ] ) );
+		d.uv			= glm::vec2( ME3D_ShortToFloat( s.uvs[ 0 ] ), ME3D_ShortToFloat( s.uvs[ 1 ] ) );
+		d.material		= int32_t( s.material_index );
+	}
+}
+
+#if AE_MESH_DECODE_SSE2
+// One vertex per iteration, every load and store stays inside it's own vertex so there is no tail to handle.
+// Bytes 8 to 23 of a .me3d vertex hold position z followed by the 6 int16 values of the vertex,
+// they're sign extended and dequantized at once, then shuffled together with the position into
+// the 36 byte engine vertex with two 16 byte stores and one 4 byte store.
+void ME3D_DecodeVertices_SSE2( const ME3D_Vertex * source, Vertex * destination, size_t count )
+{
+	const __m128 scale		= _mm_set1_ps( ME3D_ShortToFloat( 1 ) );
+	auto src				= reinterpret_cast<const char*>( source );
+	auto dst				= reinterpret_cast<char*>( destination );
+	for( size_t i=0; i < count; ++i ) {
+		__m128	position	= _mm_loadu_ps( reinterpret_cast<const float*>( src ) );								// px py pz n0n1
+		__m128i	shorts		= _mm_srli_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + 8 ) ), 4 );	// n0 n1 n2 u0 u1 m 0 0
+		__m128i	low			= _mm_srai_epi32( _mm_unpacklo_epi16( shorts, shorts ), 16 );							// n0 n1 n2 u0
+		__m128i	high		= _mm_srai_epi32( _mm_unpackhi_epi16( shorts, shorts ), 16 );							// u1 m 0 0
+		__m128	low_f		= _mm_mul_ps( _mm_cvtepi32_ps( low ), scale );
+		__m128	high_f		= _mm_mul_ps( _mm_cvtepi32_ps( high ), scale );
+
+		__m128	z_nx		= _mm_shuffle_ps( position, low_f, _MM_SHUFFLE( 0, 0, 2, 2 ) );					// pz pz nx nx
+		__m128	out_0		= _mm_shuffle_ps( position, z_nx, _MM_SHUFFLE( 2, 0, 1, 0 ) );						// px py pz nx
+		__m128	u_v			= _mm_shuffle_ps( low_f, high_f, _MM_SHUFFLE( 0, 0, 3, 3 ) );						// u u v v
+		__m128	out_1		= _mm_shuffle_ps( low_f, u_v, _MM_SHUFFLE( 2, 0, 2, 1 ) );							// ny nz u v
+		int32_t	material	= _mm_cvtsi128_si32( _mm_srli_si128( high, 4 ) );
+
+		_mm_storeu_ps( reinterpret_cast<float*>( dst ), out_0 );
+		_mm_storeu_ps( reinterpret_cast<float*>( dst + 16 ), out_1 );
+		std::memcpy( dst + 32, &material, sizeof( material ) );
+
+		src					+= sizeof( ME3D_Vertex );
+		dst					+= sizeof( Vertex );
+	}
+}
+#endif
+
+}
+
+void ME3D_DecodeVertices( const ME3D_Vertex * source, Vertex * destination, size_t count )
+{
+	assert( count == 0 || ( nullptr != source && nullptr != destination ) );
+#if AE_MESH_DECODE_SSE2
+	engine_internal::ME3D_DecodeVertices_SSE2( source, destination, count );
+#else
+	engine_internal::ME3D_DecodeVertices_Scalar( source, destination, count );
+#endif
+}
+
+void ME3D_GetCompactPositionTransform( const ME3D_Vertex * source, size_t count, glm::vec3 & position_offset, glm::vec3 & position_scale )
+{
+	assert( count == 0 || nullptr != source );
+	glm::vec3 min_position( 0, 0, 0 );
+	glm::vec3 max_position( 0, 0, 0 );
+	if( count ) {
+		min_position	= glm::vec3( source[ 0 ].position[ 0 ], source[ 0 ].position[ 1 ], source[ 0 ].position[ 2 ] );
+		max_position	= min_position;
+	}
+	for( size_t i=1; i < count; ++i ) {
+		auto p			= glm::vec3( source[ i ].position[ 0 ], source[ i ].position[ 1 ], source[ i ].position[ 2 ] );
+		min_position	= glm::min( min_position, p );
+		max_position	= glm::max( max_position, p );
+	}
+	position_offset		= ( min_position + max_position ) * 0.5f;
+	position_scale		= ( max_position - min_position ) * 0.5f;
+	// flat meshes would divide by zero, any scale works for them
+	for( glm::length_t i=0; i < 3; ++i ) {
+		if( position_scale[ i ] <= 0.0f ) position_scale[ i ] = 1.0f;
+	}
+}
+
+void ME3D_DecodeCompactVertices( const ME3D_Vertex * source, VertexCompact * destination, size_t count, const glm::vec3 & position_offset, const glm::vec3 & position_scale )
+{
+	assert( count == 0 || ( nullptr != source && nullptr != destination ) );
+	// snorm16 is read back by the device as max( value / 32767, -1 ), -32768 is never written
+	auto inverse_scale		= 32767.0f / position_scale;
+	for( size_t i=0; i < count; ++i ) {
+		auto & s = source[ i ];
+		auto & d = destination[ i ];
+		for( size_t c=0; c < 3; ++c ) {
+			float q			= std::round( ( s.position[ c ] - position_offset[ glm::length_t( c ) ] ) * inverse_scale[ glm::length_t( c ) ] );
+			d.position[ c ]	= int16_t( std::min( std::max( q, -32767.0f ), 32767.0f ) );
+			d.normal[ c ]	= s.normals[ c ];
+		}
+		d.material		= s.material_index;
+		d.padding		= 0;
+		d.uv[ 0 ]		= s.uvs[ 0 ];
+		d.uv[ 1 ]		= s.uvs[ 1 ];
+	}
+}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../../BUILD_OPTIONS.h"
+#include "../../Platform.h"
+
+#include "MeshInfo.h"
+#include "ME3DFile.h"
+
+#if BUILD_MESH_DECODE_SIMD && ( defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) || defined( __SSE2__ ) )
+#define AE_MESH_DECODE_SSE2		1
+#else
+#define AE_MESH_DECODE_SSE2		0
+#endif
+
+namespace AE
+{
+
+namespace engine_internal
+{
+
+// Decoders ME3D_DecodeVertices picks from, both produce the same vertices
+void ME3D_DecodeVertices_Scalar( const ME3D_Vertex * source, Vertex * destination, size_t count );
+#if AE_MESH_DECODE_SSE2
+void ME3D_DecodeVertices_SSE2( const ME3D_Vertex * source, Vertex * destination, size_t count );
+#endif
+
+}
+
+// Converts .me3d vertices into engine vertices, normals and uvs are dequantized to floats
+// Uses SSE2 when BUILD_MESH_DECODE_SIMD is enabled and the target supports it
+void ME3D_DecodeVertices( const ME3D_Vertex * source, Vertex * destination, size_t count );
+
+// Finds the bounds of .me3d vertex positions as the offset and scale compact vertices are stored relative to
+void ME3D_GetCompactPositionTransform( const ME3D_Vertex * source, size_t count, glm::vec3 & position_offset, glm::vec3 & position_scale );
+
+// Converts .me3d vertices into compact vertices, positions are quantized relative to the position transform,
+// normals, uvs and materials are copied as they are
+void ME3D_DecodeCompactVertices( const ME3D_Vertex * source, VertexCompact * destination, size_t count, const glm::vec3 & position_offset, const glm::vec3 & position_scale );
+
+}
@@ -4,10 +4,19 @@
 #include "../../Platform.h"
 
 #include "../../Math/Math.h"
+#include "../../Memory/Memory.h"
+#include "../../FileSystem/FileData.h"
 
 namespace AE
 {
 
+// Vertex layouts a mesh can be stored in, graphics pipelines select which one they read
+enum class VertexFormat : uint32_t
+{
+	FLOAT,						// Vertex
+	COMPACT,					// VertexCompact
+};
+
 struct Vertex
 {
 	glm::vec3	position;
@@ -16,6 +25,30 @@ struct Vertex
 	int32_t		material;
 };
 
+// Quantized vertex, 20 bytes instead of 36, all values are read by the vertex input as floats
+// position is snorm16 inside the mesh bounds, the position transform of the mesh maps it back to model space
+// normal and uv are snorm16, the same precision .me3d files store them in
+// material is stored after the position so the position can be read as four components,
+// the 4th component is never used as a position
+struct VertexCompact
+{
+	int16_t		position[ 3 ];
+	int16_t		material;
+	int16_t		normal[ 3 ];
+	int16_t		padding;
+	int16_t		uv[ 2 ];
+};
+
+constexpr size_t GetVertexSize( VertexFormat vertex_format )
+{
+	return vertex_format == VertexFormat::COMPACT ? sizeof( VertexCompact ) : sizeof( Vertex );
+}
+
+constexpr size_t GetVertexAlignment( VertexFormat vertex_format )
+{
+	return vertex_format == VertexFormat::COMPACT ? alignof( VertexCompact ) : alignof( Vertex );
+}
+
 struct CopyVertex
 {
 	int32_t		copy_from_index;
@@ -26,4 +59,32 @@ struct Polygon
 	int32_t		indices[ 3 ];
 };
 
+// Mesh in the same layout as the device buffer, index block followed by the vertex block
+// Device resources copy the whole block into the staging buffer at once
+struct MeshData
+{
+	// device block of converted meshes and of cooked meshes that couldn't be used in place
+	Vector<uint8_t>		device_block;
+	// cooked meshes read from a memory mapped file use the device block inside the file
+	// instead of copying it, file_data keeps the file contents alive
+	SharedPointer<FileData>		file_data;
+	ArrayView<const uint8_t>	file_device_block;
+	size_t				index_offset			= 0;		// polygons, from the start of the device block
+	size_t				vertex_offset			= 0;		// vertices, from the start of the device block
+	uint32_t			polygon_count			= 0;
+	uint32_t			vertex_count			= 0;
+	VertexFormat		vertex_format			= VertexFormat::FLOAT;
+	// model space position = position_offset + position_scale * stored position, only compact vertices need this
+	glm::vec3			position_offset			= glm::vec3( 0, 0, 0 );
+	glm::vec3			position_scale			= glm::vec3( 1, 1, 1 );
+	// not needed by the device, kept outside of the device block
+	Vector<CopyVertex>	copy_vertices;
+
+	ArrayView<const uint8_t> GetDeviceBlock() const
+	{
+		if( file_data ) return file_device_block;
+		return ArrayView<const uint8_t>( device_block.data(), device_block.size() );
+	}
+};
+
 }
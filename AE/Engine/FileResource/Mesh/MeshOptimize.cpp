@@ -0,0 +1,335 @@
+
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <sstream>
+#include <iomanip>
+
+#include "MeshOptimize.h"
+
+namespace AE
+{
+
+namespace engine_internal
+{
+
+// Size of the LRU cache the triangle order is optimized for, larger than most real caches on purpose,
+// triangles that reuse recent vertices are preferred and this works well for any smaller cache too
+constexpr uint32_t		MESH_OPTIMIZE_SCORING_CACHE_SIZE			= 32;
+
+ArrayView<Polygon> MeshOptimize_GetPolygons( MeshData & mesh_data )
+{
+	return ArrayView<Polygon>( reinterpret_cast<Polygon*>( mesh_data.device_block.data() + mesh_data.index_offset ), mesh_data.polygon_count );
+}
+
+MeshCacheStatistics MeshOptimize_SimulateCache( const Polygon * polygons, uint32_t polygon_count, uint32_t vertex_count )
+{
+	MeshCacheStatistics statistics;
+	if( polygon_count == 0 ) return statistics;
+
+	// time is the amount of vertex transforms when the vertex was last transformed,
+	// a vertex is still in the FIFO if less than cache size transforms have happened after it
+	Vector<uint32_t> load_time( vertex_count, 0 );
+	uint32_t transform_count		= 0;
+	uint32_t used_vertex_count		= 0;
+	for( uint32_t p=0; p < polygon_count; ++p ) {
+		for( auto i : polygons[ p ].indices ) {
+			auto & t = load_time[ i ];
+			if( t != 0 && transform_count - t < BUILD_MESH_OPTIMIZE_VERTEX_CACHE_SIZE ) continue;
+			if( t == 0 ) ++used_vertex_count;
+			t = ++transform_count;
+		}
+	}
+	statistics.acmr				= double( transform_count ) / double( polygon_count );
+	statistics.atvr				= double( transform_count ) / double( used_vertex_count );
+	return statistics;
+}
+
+float MeshOptimize_GetVertexScore( int32_t cache_position, uint32_t remaining_triangle_count )
+{
+	if( remaining_triangle_count == 0 ) return -1.0f;
+
+	float score = 0.0f;
+	if( cache_position >= 0 ) {
+		if( cache_position < 3 ) {
+			// vertices of the last triangle get a fixed score, otherwise strips would be favoured over fans
+			score = 0.75f;
+		} else {
+			float scaled = 1.0f - float( cache_position - 3 ) / float( MESH_OPTIMIZE_SCORING_CACHE_SIZE - 3 );
+			score = std::pow( scaled, 1.5f );
+		}
+	}
+	// vertices with few triangles left are finished first so they don't have to be loaded again later
+	score += 2.0f / std::sqrt( float( remaining_triangle_count ) );
+	return score;
+}
+
+// Greedy triangle reordering for the post transform vertex cache, Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+// Every step adds the triangle with the highest score, scores are only updated for triangles of the vertices in the cache
+void MeshOptimize_ReorderTriangles( ArrayView<Polygon> polygons, uint32_t vertex_count )
+{
+	auto polygon_count		= uint32_t( polygons.size() );
+	if( polygon_count == 0 ) return;
+
+	// triangles of every vertex, the first remaining_triangles[ v ] entries of a vertex are the ones not added yet
+	Vector<uint32_t>	remaining_triangles( vertex_count, 0 );
+	Vector<uint32_t>	triangle_list_offsets( size_t( vertex_count ) + 1, 0 );
+	Vector<uint32_t>	triangle_lists( size_t( polygon_count ) * 3 );
+	for( auto & p : polygons ) {
+		for( auto i : p.indices ) ++remaining_triangles[ i ];
+	}
+	for( uint32_t v=0; v < vertex_count; ++v ) {
+		triangle_list_offsets[ v + 1 ]	= triangle_list_offsets[ v ] + remaining_triangles[ v ];
+	}
+	{
+		Vector<uint32_t> fill( triangle_list_offsets.begin(), triangle_list_offsets.end() - 1 );
+		for( uint32_t p=0; p < polygon_count; ++p ) {
+			for( auto i : polygons[ p ].indices ) triangle_lists[ fill[ i ]++ ] = p;
+		}
+	}
+
+	Vector<int32_t>		cache_positions( vertex_count, -1 );
+	Vector<float>		vertex_scores( vertex_count );
+	Vector<float>		triangle_scores( polygon_count );
+	Vector<uint8_t>		triangle_added( polygon_count, 0 );
+	for( uint32_t v=0; v < vertex_count; ++v ) {
+		vertex_scores[ v ]		= MeshOptimize_GetVertexScore( -1, remaining_triangles[ v ] );
+	}
+	for( uint32_t p=0; p < polygon_count; ++p ) {
+		auto & indices			= polygons[ p ].indices;
+		triangle_scores[ p ]	= vertex_scores[ indices[ 0 ] ] + vertex_scores[ indices[ 1 ] ] + vertex_scores[ indices[ 2 ] ];
+	}
+
+	Vector<Polygon>		result;
+	result.reserve( polygon_count );
+	Array<uint32_t, MESH_OPTIMIZE_SCORING_CACHE_SIZE + 3>	cache;
+	Array<uint32_t, MESH_OPTIMIZE_SCORING_CACHE_SIZE + 3>	new_cache;
+	uint32_t			cache_count				= 0;
+	int64_t				best_triangle			= -1;
+	uint32_t			next_unadded_triangle	= 0;
+
+	while( result.size() < polygon_count ) {
+		if( best_triangle < 0 ) {
+			// nothing in the cache has triangles left, continue from the next triangle in the original order
+			while( triangle_added[ next_unadded_triangle ] ) ++next_unadded_triangle;
+			best_triangle		= next_unadded_triangle;
+		}
+		auto & best			= polygons[ size_t( best_triangle ) ];
+		result.push_back( best );
+		triangle_added[ size_t( best_triangle ) ]	= 1;
+
+		// remove the triangle from the remaining triangles of it's vertices
+		for( auto i : best.indices ) {
+			auto list			= triangle_lists.data() + triangle_list_offsets[ i ];
+			auto & remaining	= remaining_triangles[ i ];
+			auto found			= std::find( list, list + remaining, uint32_t( best_triangle ) );
+			assert( found != list + remaining );
+			std::swap( *found, list[ remaining - 1 ] );
+			--remaining;
+		}
+
+		// vertices of the triangle go to the front of the cache, the rest keep their order
+		uint32_t new_cache_count = 0;
+		for( auto i : best.indices ) {
+			if( std::find( new_cache.begin(), new_cache.begin() + new_cache_count, uint32_t( i ) ) == new_cache.begin() + new_cache_count ) {
+				new_cache[ new_cache_count++ ]	= uint32_t( i );
+			}
+		}
+		for( uint32_t c=0; c < cache_count; ++c ) {
+			auto v = cache[ c ];
+			if( v != uint32_t( best.indices[ 0 ] ) && v != uint32_t( best.indices[ 1 ] ) && v != uint32_t( best.indices[ 2 ] ) ) {
+				new_cache[ new_cache_count++ ]	= v;
+			}
+		}
+
+		// update the scores of everything that moved in or out of the cache and pick the next triangle
+		for( uint32_t c=0; c < new_cache_count; ++c ) {
+			auto v					= new_cache[ c ];
+			cache_positions[ v ]	= ( c < MESH_OPTIMIZE_SCORING_CACHE_SIZE ) ? int32_t( c ) : -1;
+			vertex_scores[ v ]		= MeshOptimize_GetVertexScore( cache_positions[ v ], remaining_triangles[ v ] );
+		}
+		best_triangle			= -1;
+		float best_score		= -1.0f;
+		for( uint32_t c=0; c < new_cache_count; ++c ) {
+			auto v				= new_cache[ c ];
+			auto list			= triangle_lists.data() + triangle_list_offsets[ v ];
+			for( uint32_t t=0; t < remaining_triangles[ v ]; ++t ) {
+				auto p					= list[ t ];
+				auto & indices			= polygons[ p ].indices;
+				triangle_scores[ p ]	= vertex_scores[ indices[ 0 ] ] + vertex_scores[ indices[ 1 ] ] + vertex_scores[ indices[ 2 ] ];
+				if( triangle_scores[ p ] > best_score ) {
+					best_score			= triangle_scores[ p ];
+					best_triangle		= p;
+				}
+			}
+		}
+
+		cache_count		= std::min( new_cache_count, MESH_OPTIMIZE_SCORING_CACHE_SIZE );
+		std::copy( new_cache.begin(), new_cache.begin() + cache_count, cache.begin() );
+	}
+
+	std::copy( result.begin(), result.end(), polygons.begin() );
+}
+
+// Points every vertex to the first vertex that has exactly the same contents, the first one is
+// always a regular vertex if the group has any so copy vertices never become copy sources
+void MeshOptimize_FindDuplicateVertices( const MeshData & mesh_data, Vector<uint32_t> & representatives )
+{
+	auto vertex_size		= GetVertexSize( mesh_data.vertex_format );
+	auto vertices			= mesh_data.device_block.data() + mesh_data.vertex_offset;
+
+	Vector<uint32_t> sorted( mesh_data.vertex_count );
+	std::iota( sorted.begin(), sorted.end(), 0 );
+	std::sort( sorted.begin(), sorted.end(), [ vertices, vertex_size ]( uint32_t a, uint32_t b ) {
+		auto compare = std::memcmp( vertices + a * vertex_size, vertices + b * vertex_size, vertex_size );
+		return compare < 0 || ( compare == 0 && a < b );
+	} );
+
+	for( size_t group_start=0; group_start < sorted.size(); ) {
+		auto first			= sorted[ group_start ];
+		size_t group_end	= group_start;
+		while( group_end < sorted.size() && std::memcmp( vertices + first * vertex_size, vertices + sorted[ group_end ] * vertex_size, vertex_size ) == 0 ) {
+			representatives[ sorted[ group_end ] ]	= first;
+			++group_end;
+		}
+		group_start			= group_end;
+	}
+}
+
+// Renumbers vertices in the order the polygons first use them, unused vertices that weren't merged go after
+// Regular vertices and copy vertices are ordered separately so copy vertices stay at the end
+void MeshOptimize_ReorderVertices( MeshData & mesh_data, const Vector<uint32_t> & representatives )
+{
+	auto vertex_size		= GetVertexSize( mesh_data.vertex_format );
+	auto polygons			= MeshOptimize_GetPolygons( mesh_data );
+	auto base_count			= mesh_data.vertex_count - uint32_t( mesh_data.copy_vertices.size() );
+
+	constexpr uint32_t UNUSED = UINT32_MAX;
+	Vector<uint32_t> new_indices( mesh_data.vertex_count, UNUSED );
+	Vector<uint32_t> order;
+	order.reserve( mesh_data.vertex_count );
+
+	auto AddRange = [ & ]( uint32_t range_begin, uint32_t range_end ) {
+		for( auto & p : polygons ) {
+			for( auto i : p.indices ) {
+				auto v = uint32_t( i );
+				if( v >= range_begin && v < range_end && new_indices[ v ] == UNUSED ) {
+					new_indices[ v ]	= uint32_t( order.size() );
+					order.push_back( v );
+				}
+			}
+		}
+		for( uint32_t v=range_begin; v < range_end; ++v ) {
+			if( new_indices[ v ] == UNUSED && representatives[ v ] == v ) {
+				new_indices[ v ]	= uint32_t( order.size() );
+				order.push_back( v );
+			}
+		}
+	};
+	AddRange( 0, base_count );
+	auto new_base_count		= uint32_t( order.size() );
+	AddRange( base_count, mesh_data.vertex_count );
+
+	Vector<CopyVertex> copy_vertices( order.size() - new_base_count );
+	for( size_t c=0; c < copy_vertices.size(); ++c ) {
+		auto & old_copy						= mesh_data.copy_vertices[ order[ new_base_count + c ] - base_count ];
+		copy_vertices[ c ].copy_from_index	= int32_t( new_indices[ representatives[ old_copy.copy_from_index ] ] );
+	}
+	for( auto & p : polygons ) {
+		for( auto & i : p.indices ) i = int32_t( new_indices[ uint32_t( i ) ] );
+	}
+
+	Vector<uint8_t> vertices( order.size() * vertex_size );
+	auto old_vertices		= mesh_data.device_block.data() + mesh_data.vertex_offset;
+	for( size_t v=0; v < order.size(); ++v ) {
+		std::memcpy( vertices.data() + v * vertex_size, old_vertices + size_t( order[ v ] ) * vertex_size, vertex_size );
+	}
+	mesh_data.device_block.resize( mesh_data.vertex_offset + vertices.size() );
+	std::memcpy( mesh_data.device_block.data() + mesh_data.vertex_offset, vertices.data(), vertices.size() );
+	mesh_data.vertex_count		= uint32_t( order.size() );
+	mesh_data.copy_vertices		= std::move( copy_vertices );
+}
+
+}
+
+bool Mesh_IsValid( const MeshData & mesh_data )
+{
+	auto device_block		= mesh_data.GetDeviceBlock();
+	auto vertex_size		= GetVertexSize( mesh_data.vertex_format );
+	auto vertex_alignment	= GetVertexAlignment( mesh_data.vertex_format );
+	auto block_size			= uint64_t( device_block.size() );
+	auto polygons_size		= uint64_t( mesh_data.polygon_count ) * sizeof( Polygon );
+	auto vertices_size		= uint64_t( mesh_data.vertex_count ) * vertex_size;
+
+	// written so that huge offsets can't wrap around
+	if( mesh_data.index_offset > block_size || polygons_size > block_size - mesh_data.index_offset )	return false;
+	if( mesh_data.vertex_offset > block_size || vertices_size > block_size - mesh_data.vertex_offset )	return false;
+	if( mesh_data.polygon_count && uintptr_t( device_block.data() + mesh_data.index_offset ) % alignof( Polygon ) != 0 )	return false;
+	if( mesh_data.vertex_count && uintptr_t( device_block.data() + mesh_data.vertex_offset ) % vertex_alignment != 0 )		return false;
+	if( mesh_data.copy_vertices.size() > mesh_data.vertex_count )										return false;
+
+	auto base_count			= mesh_data.vertex_count - uint32_t( mesh_data.copy_vertices.size() );
+	for( auto & c : mesh_data.copy_vertices ) {
+		if( c.copy_from_index < 0 || uint32_t( c.copy_from_index ) >= base_count ) return false;
+	}
+	auto polygons			= reinterpret_cast<const Polygon*>( device_block.data() + mesh_data.index_offset );
+	for( uint32_t p=0; p < mesh_data.polygon_count; ++p ) {
+		for( auto i : polygons[ p ].indices ) {
+			if( i < 0 || uint32_t( i ) >= mesh_data.vertex_count ) return false;
+		}
+	}
+	return true;
+}
+
+MeshCacheStatistics Mesh_GetCacheStatistics( const MeshData & mesh_data )
+{
+	if( !Mesh_IsValid( mesh_data ) ) return MeshCacheStatistics();
+	auto polygons = reinterpret_cast<const Polygon*>( mesh_data.GetDeviceBlock().data() + mesh_data.index_offset );
+	return engine_internal::MeshOptimize_SimulateCache( polygons, mesh_data.polygon_count, mesh_data.vertex_count );
+}
+
+bool Mesh_Optimize( MeshData & mesh_data, MeshOptimization optimization, MeshOptimizationReport * report )
+{
+	// device blocks used in place from a file are read only
+	if( mesh_data.file_data ) return false;
+	if( !Mesh_IsValid( mesh_data ) ) return false;
+
+	if( report ) {
+		report->before				= Mesh_GetCacheStatistics( mesh_data );
+		report->vertex_count_before	= mesh_data.vertex_count;
+	}
+
+	if( optimization != MeshOptimization::NONE ) {
+		Vector<uint32_t> representatives( mesh_data.vertex_count );
+		std::iota( representatives.begin(), representatives.end(), 0 );
+		if( optimization == MeshOptimization::REORDER_AND_DEDUPLICATE ) {
+			engine_internal::MeshOptimize_FindDuplicateVertices( mesh_data, representatives );
+			for( auto & p : engine_internal::MeshOptimize_GetPolygons( mesh_data ) ) {
+				for( auto & i : p.indices ) i = int32_t( representatives[ uint32_t( i ) ] );
+			}
+		}
+		engine_internal::MeshOptimize_ReorderTriangles( engine_internal::MeshOptimize_GetPolygons( mesh_data ), mesh_data.vertex_count );
+		engine_internal::MeshOptimize_ReorderVertices( mesh_data, representatives );
+	}
+
+	if( report ) {
+		report->after				= Mesh_GetCacheStatistics( mesh_data );
+		report->vertex_count_after	= mesh_data.vertex_count;
+	}
+	return true;
+}
+
+String Mesh_GetOptimizationReportText( const MeshOptimizationReport & report )
+{
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision( 3 );
+	ss << "ACMR " << report.before.acmr << " -> " << report.after.acmr;
+	ss << ", ATVR " << report.before.atvr << " -> " << report.after.atvr;
+	ss << ", vertices " << report.vertex_count_before << " -> " << report.vertex_count_after;
+	return ss.str().c_str();
+}
+
+}
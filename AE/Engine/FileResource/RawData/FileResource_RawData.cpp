@@ -13,21 +13,31 @@ FileResource_RawData::~FileResource_RawData()
 {
 }
 
-const Vector<char>& FileResource_RawData::GetData()
+ArrayView<const char> FileResource_RawData::GetData()
 {
-	return data;
+	if( data ) {
+		return data->GetData();
+	}
+	return {};
+}
+
+size_t FileResource_RawData::GetResidentSize() const
+{
+	if( data ) {
+		return data->Size();
+	}
+	return 0;
 }
 
 bool FileResource_RawData::Load( FileStream * stream, const Path & path )
 {
-	data.resize( stream->Size() );
-	stream->Read( data.data(), data.size() );
+	data	= stream->GetFileData();
 	return true;
 }
 
 bool FileResource_RawData::Unload()
 {
-	data.clear();
+	data	= nullptr;
 	return true;
 }
 
@@ -14,14 +14,17 @@ public:
 	FileResource_RawData( Engine * engine, FileResourceManager * file_resource_manager );
 	~FileResource_RawData();
 
-	const Vector<char>	&	GetData();
+	ArrayView<const char>	GetData();
+
+	size_t					GetResidentSize() const;
 
 private:
 
 	bool					Load( FileStream * stream, const Path & path );
 	bool					Unload();
 
-	Vector<char>			data;
+	// file contents are shared with the file stream, not copied
+	SharedPointer<FileData>	data;
 };
 
 }
@@ -125,6 +125,7 @@ bool FileResource_XML::Load( FileStream * stream, const Path & path )
 
 	auto result = xml.Parse( stream->GetRawStream().data(), stream->Size() );
 	if( result == tinyxml2::XMLError::XML_SUCCESS ) {
+		source_size		= stream->Size();
 		return true;
 	}
 	return false;
@@ -133,7 +134,14 @@ bool FileResource_XML::Load( FileStream * stream, const Path & path )
 bool FileResource_XML::Unload()
 {
 	xml.Clear();
+	source_size			= 0;
 	return true;
 }
 
+size_t FileResource_XML::GetResidentSize() const
+{
+	// the document is a tree of nodes holding copies of the text, roughly twice the source
+	return source_size * 2;
+}
+
 }
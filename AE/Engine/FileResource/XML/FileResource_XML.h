@@ -22,6 +22,8 @@ public:
 
 	tinyxml2::XMLDocument			*	GetRawXML();
 
+	size_t								GetResidentSize() const;
+
 	String								GetFieldValue_Text( tinyxml2::XMLElement * parent, const String & field_name, const String & default_value = "" );
 	int64_t								GetFieldValue_Int64( tinyxml2::XMLElement * parent, const String & field_name, int64_t default_value = 0 );
 	double								GetFieldValue_Double( tinyxml2::XMLElement * parent, const String & field_name, double default_value = 0.0 );
@@ -37,6 +39,8 @@ private:
 	bool								Unload();
 
 	tinyxml2::XMLDocument				xml;
+	// tinyxml2 doesn't report it's memory use, the parsed document is estimated from the source size
+	size_t								source_size					= 0;
 };
 
 }
@@ -0,0 +1,133 @@
+
+#include <assert.h>
+
+#include "AssetID.h"
+#include "FileArchive.h"
+
+#include "../Threading/Threading.h"
+
+namespace AE
+{
+
+namespace engine_internal
+{
+
+struct AssetIDEntry
+{
+	Path						path;
+	String						normalized_path;
+};
+
+struct AssetIDTableShard
+{
+	Mutex						mutex;
+	UnorderedMap<uint64_t, AssetIDEntry>	entries;
+};
+
+struct AssetIDTable
+{
+	Array<AssetIDTableShard, BUILD_RESOURCE_MANAGER_LOOKUP_SHARD_COUNT>	shards;
+};
+
+AssetIDTable & GetAssetIDTable()
+{
+	// constructed on first use, after the memory pool, so it's also destroyed before the memory pool
+	static AssetIDTable table;
+	return table;
+}
+
+AssetIDTableShard & GetAssetIDTableShard( uint64_t value )
+{
+	return GetAssetIDTable().shards[ value % BUILD_RESOURCE_MANAGER_LOOKUP_SHARD_COUNT ];
+}
+
+// entries are never removed, returned pointer stays valid
+const AssetIDEntry * FindAssetIDEntry( uint64_t value )
+{
+	auto & shard		= GetAssetIDTableShard( value );
+	LOCK_GUARD( shard.mutex );
+	auto it				= shard.entries.find( value );
+	if( it == shard.entries.end() ) return nullptr;
+	return &it->second;
+}
+
+}
+
+size_t AssetID::Hasher::operator()( const AssetID & id ) const
+{
+	return size_t( id.value ^ ( id.value >> 32 ) );
+}
+
+AssetID::AssetID( const Path & path )
+{
+	if( path.empty() ) return;
+
+	String		normalized_path		= FileArchive::NormalizePath( path );
+	uint64_t	candidate			= FileArchive::HashPath( normalized_path );
+	while( true ) {
+		// 0 is reserved for invalid ids
+		if( 0 == candidate ) ++candidate;
+
+		auto & shard				= engine_internal::GetAssetIDTableShard( candidate );
+		LOCK_GUARD( shard.mutex );
+		auto it						= shard.entries.find( candidate );
+		if( it == shard.entries.end() ) {
+			shard.entries.insert( std::pair<uint64_t, engine_internal::AssetIDEntry>( candidate, { path, normalized_path } ) );
+			value					= candidate;
+			return;
+		}
+		if( it->second.normalized_path == normalized_path ) {
+			value					= candidate;
+			return;
+		}
+		// hash collision with another path, the path interned later gets the next free id
+		++candidate;
+	}
+}
+
+bool AssetID::IsValid() const
+{
+	return 0 != value;
+}
+
+uint64_t AssetID::GetValue() const
+{
+	return value;
+}
+
+const Path & AssetID::GetPath() const
+{
+	static const Path empty_path;
+	if( !IsValid() ) return empty_path;
+
+	auto entry		= engine_internal::FindAssetIDEntry( value );
+	assert( entry );
+	return entry ? entry->path : empty_path;
+}
+
+const String & AssetID::GetNormalizedPath() const
+{
+	static const String empty_path;
+	if( !IsValid() ) return empty_path;
+
+	auto entry		= engine_internal::FindAssetIDEntry( value );
+	assert( entry );
+	return entry ? entry->normalized_path : empty_path;
+}
+
+bool AssetID::operator==( const AssetID & other ) const
+{
+	return value == other.value;
+}
+
+bool AssetID::operator!=( const AssetID & other ) const
+{
+	return value != other.value;
+}
+
+bool AssetID::operator<( const AssetID & other ) const
+{
+	return value < other.value;
+}
+
+}
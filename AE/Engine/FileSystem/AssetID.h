@@ -0,0 +1,46 @@
+#pragma once
+
+#include <filesystem>
+
+#include "../BUILD_OPTIONS.h"
+#include "../Platform.h"
+
+#include "../Memory/Memory.h"
+#include "../CppFileSystem/CppFileSystem.h"
+
+namespace AE
+{
+
+// Interned asset path
+// Paths are normalized (lower case, forward slashes) and hashed into a 64 bit id when interned,
+// the same path always gets the same id, also between runs. Interning locks a table so it should
+// be done once when the path is first known, after that ids are copied and compared as integers.
+// The path an id was first interned with can be looked up for opening the file and for logging
+class AssetID
+{
+public:
+	struct Hasher
+	{
+		size_t					operator()( const AssetID & id ) const;
+	};
+
+								AssetID()												= default;
+	explicit					AssetID( const Path & path );
+
+	bool						IsValid() const;
+	uint64_t					GetValue() const;
+
+	// path the id was first interned with, empty path for invalid ids
+	const Path				&	GetPath() const;
+	// lower case path with forward slashes
+	const String			&	GetNormalizedPath() const;
+
+	bool						operator==( const AssetID & other ) const;
+	bool						operator!=( const AssetID & other ) const;
+	bool						operator<( const AssetID & other ) const;
+
+private:
+	uint64_t					value													= 0;
+};
+
+}
@@ -0,0 +1,49 @@
+
+#include <assert.h>
+#include <climits>
+#include <cstdlib>
+
+// this is the only translation unit that compiles the stb libraries, the image writer
+// is only used for it's zlib compressor and the rest of it is never called
+#define STBI_FAILURE_USERMSG
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#define STBI_WRITE_NO_STDIO
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include "Compression.h"
+
+namespace AE
+{
+
+namespace engine_internal
+{
+
+bool Compression_Deflate( const char * data, size_t size, Vector<char> & compressed, int quality )
+{
+	assert( nullptr != data || 0 == size );
+	compressed.clear();
+	if( size > size_t( INT_MAX ) ) return false;
+
+	int compressed_size		= 0;
+	auto result				= stbi_zlib_compress( reinterpret_cast<unsigned char*>( const_cast<char*>( data ) ), int( size ), &compressed_size, quality );
+	if( nullptr == result ) return false;
+	compressed.assign( reinterpret_cast<const char*>( result ), reinterpret_cast<const char*>( result ) + compressed_size );
+	STBIW_FREE( result );
+	return true;
+}
+
+bool Compression_Inflate( const char * compressed, size_t compressed_size, char * data, size_t size )
+{
+	assert( nullptr != data || 0 == size );
+	if( compressed_size > size_t( INT_MAX ) || size > size_t( INT_MAX ) ) return false;
+
+	int decompressed_size	= stbi_zlib_decode_buffer( data, int( size ), compressed, int( compressed_size ) );
+	return decompressed_size >= 0 && size_t( decompressed_size ) == size;
+}
+
+}
+
+}
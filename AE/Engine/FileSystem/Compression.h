@@ -0,0 +1,23 @@
+#pragma once
+
+#include "../BUILD_OPTIONS.h"
+#include "../Platform.h"
+
+#include "../Memory/Memory.h"
+
+namespace AE
+{
+
+namespace engine_internal
+{
+
+// zlib stream compression used by file archives
+// Compresses data into a zlib stream, quality is the zlib compression level 1 - 9
+bool						Compression_Deflate( const char * data, size_t size, Vector<char> & compressed, int quality = 8 );
+// Decompresses a zlib stream into a buffer of exactly the original size, returns false if the
+// stream is broken or doesn't decompress into exactly size bytes
+bool						Compression_Inflate( const char * compressed, size_t compressed_size, char * data, size_t size );
+
+}
+
+}
@@ -0,0 +1,315 @@
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include <assert.h>
+
+#include "FileArchive.h"
+#include "Compression.h"
+
+#include "../Logger/Logger.h"
+
+namespace AE
+{
+
+namespace engine_internal
+{
+
+// overflow safe check that [ offset, offset + size ) is inside [ 0, total_size )
+bool FileArchive_IsRangeInside( uint64_t offset, uint64_t size, uint64_t total_size )
+{
+	return offset <= total_size && size <= total_size - offset;
+}
+
+}
+
+constexpr char FileArchive::MAGIC[ 4 ];
+
+FileArchive::FileArchive()
+{
+}
+
+FileArchive::~FileArchive()
+{
+}
+
+bool FileArchive::Open( const Path & archive_path, const Path & mount_point )
+{
+	auto file_data		= MakeSharedPointer<FileData>();
+	if( !file_data->MapFile( archive_path ) ) {
+		if( !file_data->ReadFile( archive_path ) ) {
+			return false;
+		}
+	}
+
+	auto data			= file_data->GetData();
+	if( data.size() < sizeof( Header ) ) return false;
+
+	Header archive_header {};
+	std::memcpy( &archive_header, data.data(), sizeof( Header ) );
+	if( std::memcmp( archive_header.magic, MAGIC, sizeof( MAGIC ) ) != 0 ) return false;
+	if( archive_header.version != VERSION ) return false;
+	if( !engine_internal::FileArchive_IsRangeInside( archive_header.toc_offset, uint64_t( archive_header.entry_count ) * sizeof( Entry ), data.size() ) ) return false;
+	if( !engine_internal::FileArchive_IsRangeInside( archive_header.strings_offset, archive_header.strings_size, data.size() ) ) return false;
+	if( archive_header.toc_offset % alignof( Entry ) != 0 ) return false;
+
+	// validated once here so that FindEntry and OpenEntry can trust the table of contents
+	auto entries		= reinterpret_cast<const Entry*>( data.data() + archive_header.toc_offset );
+	for( uint32_t i=0; i < archive_header.entry_count; ++i ) {
+		auto & e		= entries[ i ];
+		if( !engine_internal::FileArchive_IsRangeInside( e.path_offset, e.path_length, archive_header.strings_size ) ) return false;
+		if( !engine_internal::FileArchive_IsRangeInside( e.data_offset, e.stored_size, data.size() ) ) return false;
+		if( !( e.flags & EntryFlags::COMPRESSED ) && e.stored_size != e.original_size ) return false;
+	}
+
+	this->archive_path				= archive_path;
+	this->mount_point				= mount_point;
+	this->normalized_mount_point	= NormalizePath( mount_point );
+	if( normalized_mount_point.size() && normalized_mount_point.back() != '/' ) {
+		normalized_mount_point		+= '/';
+	}
+	archive_data					= file_data;
+	header							= archive_header;
+	return true;
+}
+
+const FileArchive::Entry * FileArchive::FindEntry( const Path & path ) const
+{
+	if( !archive_data ) return nullptr;
+
+	String normalized_path			= NormalizePath( path );
+	if( normalized_path.compare( 0, normalized_mount_point.size(), normalized_mount_point ) != 0 ) {
+		return nullptr;
+	}
+	normalized_path.erase( 0, normalized_mount_point.size() );
+
+	uint64_t		hash			= HashPath( normalized_path );
+	const Entry	*	entries_begin	= GetEntries();
+	const Entry	*	entries_end		= entries_begin + header.entry_count;
+	const char	*	strings			= GetStrings();
+
+	// entries are sorted by hash, entries with the same hash are next to each other
+	auto it = std::lower_bound( entries_begin, entries_end, hash, []( const Entry & entry, uint64_t h ) {
+		return entry.path_hash < h;
+	} );
+	for( ; it != entries_end && it->path_hash == hash; ++it ) {
+		if( it->path_length == normalized_path.size() &&
+			std::memcmp( strings + it->path_offset, normalized_path.data(), normalized_path.size() ) == 0 ) {
+			return it;
+		}
+	}
+	return nullptr;
+}
+
+SharedPointer<FileData> FileArchive::OpenEntry( const SharedPointer<FileData> & archive_data, const Entry & entry )
+{
+	assert( archive_data );
+
+	auto data			= archive_data->GetData();
+	if( !engine_internal::FileArchive_IsRangeInside( entry.data_offset, entry.stored_size, data.size() ) ) return nullptr;
+
+	auto file_data		= MakeSharedPointer<FileData>();
+	if( entry.flags & EntryFlags::COMPRESSED ) {
+		Vector<char> buffer( size_t( entry.original_size ) );
+		if( !engine_internal::Compression_Inflate( data.data() + entry.data_offset, size_t( entry.stored_size ), buffer.data(), buffer.size() ) ) return nullptr;
+		file_data->SetBuffer( std::move( buffer ) );
+	} else {
+		if( !file_data->SetView( archive_data, size_t( entry.data_offset ), size_t( entry.stored_size ) ) ) return nullptr;
+	}
+	return file_data;
+}
+
+const SharedPointer<FileData> & FileArchive::GetArchiveData() const
+{
+	return archive_data;
+}
+
+const Path & FileArchive::GetArchivePath() const
+{
+	return archive_path;
+}
+
+const Path & FileArchive::GetMountPoint() const
+{
+	return mount_point;
+}
+
+uint32_t FileArchive::GetEntryCount() const
+{
+	return header.entry_count;
+}
+
+bool FileArchive::Pack( const Path & source_directory, const Path & archive_path, bool allow_compression, Logger * logger )
+{
+	struct PackEntry
+	{
+		Entry				entry;
+		String				path;
+		Path				source_path;
+	};
+
+	if( !fsys::is_directory( source_directory ) ) {
+		if( logger ) logger->LogError( String( "Archive source is not a directory: " ) + source_directory.string().c_str() );
+		return false;
+	}
+
+	String normalized_source_directory		= NormalizePath( source_directory );
+	if( normalized_source_directory.size() && normalized_source_directory.back() != '/' ) {
+		normalized_source_directory			+= '/';
+	}
+
+	Vector<PackEntry> pack_entries;
+	for( auto & i : fsys::recursive_directory_iterator( source_directory ) ) {
+		if( !fsys::is_regular_file( i.path() ) ) continue;
+		PackEntry pack_entry {};
+		pack_entry.source_path		= i.path();
+		pack_entry.path				= NormalizePath( i.path() );
+		if( pack_entry.path.compare( 0, normalized_source_directory.size(), normalized_source_directory ) == 0 ) {
+			pack_entry.path.erase( 0, normalized_source_directory.size() );
+		}
+		pack_entry.entry.path_hash	= HashPath( pack_entry.path );
+		pack_entries.push_back( std::move( pack_entry ) );
+	}
+	std::sort( pack_entries.begin(), pack_entries.end(), []( const PackEntry & a, const PackEntry & b ) {
+		if( a.entry.path_hash != b.entry.path_hash ) return a.entry.path_hash < b.entry.path_hash;
+		return a.path < b.path;
+	} );
+
+	// path strings
+	String strings;
+	for( auto & e : pack_entries ) {
+		e.entry.path_offset			= uint32_t( strings.size() );
+		e.entry.path_length			= uint32_t( e.path.size() );
+		strings						+= e.path;
+	}
+
+	auto AlignUp = []( uint64_t value, uint64_t alignment ) {
+		return ( value + alignment - 1 ) / alignment * alignment;
+	};
+
+	Header archive_header {};
+	std::memcpy( archive_header.magic, MAGIC, sizeof( MAGIC ) );
+	archive_header.version			= VERSION;
+	archive_header.entry_count		= uint32_t( pack_entries.size() );
+	archive_header.alignment		= DEFAULT_ALIGNMENT;
+	archive_header.toc_offset		= AlignUp( sizeof( Header ), alignof( Entry ) );
+	archive_header.strings_offset	= archive_header.toc_offset + uint64_t( pack_entries.size() ) * sizeof( Entry );
+	archive_header.strings_size		= strings.size();
+	archive_header.data_offset		= AlignUp( archive_header.strings_offset + archive_header.strings_size, DEFAULT_ALIGNMENT );
+
+	std::ofstream archive( archive_path, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc );
+	if( !archive.is_open() ) {
+		if( logger ) logger->LogError( String( "Couldn't create archive: " ) + archive_path.string().c_str() );
+		return false;
+	}
+
+	// file contents first, the table of contents is written after all offsets and sizes are known
+	char padding[ DEFAULT_ALIGNMENT ] {};
+	uint64_t offset					= archive_header.data_offset;
+	archive.seekp( std::streamoff( offset ) );
+	uint64_t original_total			= 0;
+	uint64_t stored_total			= 0;
+	for( auto & e : pack_entries ) {
+		auto source					= MakeSharedPointer<FileData>();
+		if( !source->ReadFile( e.source_path ) ) {
+			if( logger ) logger->LogError( String( "Couldn't read file: " ) + e.source_path.string().c_str() );
+			return false;
+		}
+		auto data					= source->GetData();
+
+		uint64_t aligned_offset		= AlignUp( offset, DEFAULT_ALIGNMENT );
+		archive.write( padding, std::streamsize( aligned_offset - offset ) );
+		offset						= aligned_offset;
+
+		e.entry.data_offset			= offset;
+		e.entry.original_size		= data.size();
+		e.entry.stored_size			= data.size();
+		e.entry.flags				= EntryFlags::NONE;
+
+		Vector<char>		compressed;
+		bool				is_compressed	= false;
+		if( allow_compression && data.size() ) {
+			is_compressed			= engine_internal::Compression_Deflate( data.data(), data.size(), compressed );
+		}
+		if( is_compressed && uint64_t( compressed.size() ) * 4 <= data.size() * 3 ) {
+			e.entry.stored_size		= uint64_t( compressed.size() );
+			e.entry.flags			= EntryFlags::COMPRESSED;
+			archive.write( compressed.data(), std::streamsize( compressed.size() ) );
+		} else {
+			archive.write( data.data(), std::streamsize( data.size() ) );
+		}
+
+		offset						+= e.entry.stored_size;
+		original_total				+= e.entry.original_size;
+		stored_total				+= e.entry.stored_size;
+	}
+
+	Vector<Entry> entries;
+	entries.reserve( pack_entries.size() );
+	for( auto & e : pack_entries ) {
+		entries.push_back( e.entry );
+	}
+
+	archive.seekp( 0 );
+	archive.write( reinterpret_cast<const char*>( &archive_header ), sizeof( Header ) );
+	archive.write( padding, std::streamsize( archive_header.toc_offset - sizeof( Header ) ) );
+	archive.write( reinterpret_cast<const char*>( entries.data() ), std::streamsize( entries.size() * sizeof( Entry ) ) );
+	archive.write( strings.data(), std::streamsize( strings.size() ) );
+	archive.close();
+	if( archive.fail() ) {
+		if( logger ) logger->LogError( String( "Couldn't write archive: " ) + archive_path.string().c_str() );
+		return false;
+	}
+
+	if( logger ) logger->LogInfo( String( "Packed " ) + std::to_string( entries.size() ).c_str() + " files, " +
+		std::to_string( original_total ).c_str() + " bytes into " + std::to_string( stored_total ).c_str() + " bytes: " +
+		archive_path.string().c_str() );
+	return true;
+}
+
+String FileArchive::NormalizePath( const Path & path )
+{
+	String normalized		= path.generic_string().c_str();
+	std::replace( normalized.begin(), normalized.end(), '\\', '/' );
+	std::transform( normalized.begin(), normalized.end(), normalized.begin(), []( char c ) {
+		return ( c >= 'A' && c <= 'Z' ) ? char( c - 'A' + 'a' ) : c;
+	} );
+	while( normalized.compare( 0, 2, "./" ) == 0 ) {
+		normalized.erase( 0, 2 );
+	}
+	return normalized;
+}
+
+uint64_t FileArchive::HashPath( const String & normalized_path )
+{
+	// FNV-1a
+	uint64_t hash			= 14695981039346656037ULL;
+	for( auto c : normalized_path ) {
+		hash				^= uint64_t( uint8_t( c ) );
+		hash				*= 1099511628211ULL;
+	}
+	return hash;
+}
+
+const FileArchive::Entry * FileArchive::GetEntries() const
+{
+	return reinterpret_cast<const Entry*>( archive_data->GetData().data() + header.toc_offset );
+}
+
+const char * FileArchive::GetStrings() const
+{
+	return archive_data->GetData().data() + header.strings_offset;
+}
+
+FileArchive::EntryFlags operator|( FileArchive::EntryFlags f1, FileArchive::EntryFlags f2 )
+{
+	return FileArchive::EntryFlags( uint32_t( f1 ) | uint32_t( f2 ) );
+}
+
+uint32_t operator&( FileArchive::EntryFlags f1, FileArchive::EntryFlags f2 )
+{
+	return uint32_t( f1 ) & uint32_t( f2 );
+}
+
+}
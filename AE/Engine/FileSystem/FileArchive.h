@@ -0,0 +1,103 @@
+#pragma once
+
+#include <filesystem>
+
+#include "../BUILD_OPTIONS.h"
+#include "../Platform.h"
+
+#include "../Memory/Memory.h"
+#include "../CppFileSystem/CppFileSystem.h"
+#include "FileData.h"
+
+namespace AE
+{
+
+class Logger;
+
+// Packed file archive
+// Layout of the archive file:
+// - Header
+// - Table of contents, one entry per file sorted by path hash
+// - Path strings of all entries, used to resolve hash collisions
+// - File contents, every entry starts at an offset aligned to the archive alignment
+// Uncompressed entries are served directly from the mapped archive without copying,
+// compressed entries are zlib compressed and decompressed into a heap buffer when opened.
+class FileArchive
+{
+public:
+	static constexpr char		MAGIC[ 4 ]							= { 'A', 'E', 'P', 'K' };
+	static constexpr uint32_t	VERSION								= 1;
+	static constexpr uint32_t	DEFAULT_ALIGNMENT					= 64;
+
+	enum class EntryFlags : uint32_t
+	{
+		NONE						= 0,
+		COMPRESSED					= 1 << 0,
+	};
+
+	struct Header
+	{
+		char					magic[ 4 ];
+		uint32_t				version;
+		uint32_t				entry_count;
+		uint32_t				alignment;
+		uint64_t				toc_offset;
+		uint64_t				strings_offset;
+		uint64_t				strings_size;
+		uint64_t				data_offset;
+	};
+
+	struct Entry
+	{
+		uint64_t				path_hash;
+		uint64_t				data_offset;			// from the start of the archive file
+		uint64_t				stored_size;			// size inside the archive
+		uint64_t				original_size;			// size after decompression
+		uint32_t				path_offset;			// from the start of the path strings
+		uint32_t				path_length;
+		EntryFlags				flags;
+		uint32_t				reserved;
+	};
+
+	FileArchive();
+	~FileArchive();
+
+	// Opens an archive, files inside the archive are found relative to the mount point
+	// Fails if any entry points outside of the archive
+	bool						Open( const Path & archive_path, const Path & mount_point );
+
+	// Returns nullptr if the path is not inside this archive
+	const Entry				*	FindEntry( const Path & path ) const;
+	// Returns the contents of an entry, uncompressed entries share the archive memory
+	// Static so that entries can be decompressed without holding on to the archive itself
+	static SharedPointer<FileData>	OpenEntry( const SharedPointer<FileData> & archive_data, const Entry & entry );
+
+	const SharedPointer<FileData>	&	GetArchiveData() const;
+	const Path				&	GetArchivePath() const;
+	const Path				&	GetMountPoint() const;
+	uint32_t					GetEntryCount() const;
+
+	// Packs all files from a directory into an archive, paths are stored relative to the directory
+	// Entries are compressed if compression saves at least a quarter of the size
+	static bool					Pack( const Path & source_directory, const Path & archive_path, bool allow_compression, Logger * logger );
+
+	// Archive paths are case insensitive and always use forward slashes
+	static String				NormalizePath( const Path & path );
+	static uint64_t				HashPath( const String & normalized_path );
+
+private:
+	const Entry				*	GetEntries() const;
+	const char				*	GetStrings() const;
+
+	Path						archive_path;
+	Path						mount_point;
+	String						normalized_mount_point;
+
+	SharedPointer<FileData>		archive_data;
+	Header						header								= {};
+};
+
+FileArchive::EntryFlags			operator|( FileArchive::EntryFlags f1, FileArchive::EntryFlags f2 );
+uint32_t						operator&( FileArchive::EntryFlags f1, FileArchive::EntryFlags f2 );
+
+}
@@ -0,0 +1,139 @@
+
+#include <fstream>
+
+#include <assert.h>
+
+#include "FileData.h"
+
+namespace AE
+{
+
+FileData::FileData()
+{
+}
+
+FileData::~FileData()
+{
+	Clear();
+}
+
+bool FileData::MapFile( const Path & path )
+{
+	Clear();
+
+	file_handle			= CreateFileW( path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+	if( INVALID_HANDLE_VALUE == file_handle ) {
+		return false;
+	}
+
+	LARGE_INTEGER file_size {};
+	if( !GetFileSizeEx( file_handle, &file_size ) || 0 == file_size.QuadPart ) {
+		// empty files can't be mapped
+		Clear();
+		return false;
+	}
+
+	mapping_handle		= CreateFileMappingW( file_handle, NULL, PAGE_READONLY, 0, 0, NULL );
+	if( NULL == mapping_handle ) {
+		Clear();
+		return false;
+	}
+
+	mapped_view			= MapViewOfFile( mapping_handle, FILE_MAP_READ, 0, 0, 0 );
+	if( nullptr == mapped_view ) {
+		Clear();
+		return false;
+	}
+
+	data				= reinterpret_cast<const char*>( mapped_view );
+	size				= size_t( file_size.QuadPart );
+	return true;
+}
+
+bool FileData::ReadFile( const Path & path )
+{
+	Clear();
+
+	std::ifstream file( path, std::fstream::in | std::fstream::binary | std::fstream::ate );
+	if( file.good() && file.is_open() ) {
+		int64_t		file_size	= int64_t( file.tellg() );
+		file.seekg( 0 );
+		buffer.resize( size_t( file_size ) );
+		file.read( buffer.data(), file_size );
+		data					= buffer.data();
+		size					= buffer.size();
+		return true;
+	}
+	return false;
+}
+
+void FileData::SetBuffer( Vector<char> && data_buffer )
+{
+	Clear();
+	buffer				= std::move( data_buffer );
+	data				= buffer.data();
+	size				= buffer.size();
+}
+
+bool FileData::SetView( SharedPointer<FileData> parent_data, size_t offset, size_t view_size )
+{
+	Clear();
+	if( !parent_data ) return false;
+	if( offset > parent_data->Size() || view_size > parent_data->Size() - offset ) return false;
+	parent				= parent_data;
+	data				= parent->GetData().data() + offset;
+	size				= view_size;
+	return true;
+}
+
+ArrayView<const char> FileData::GetData() const
+{
+	return ArrayView<const char>( data, size );
+}
+
+size_t FileData::Size() const
+{
+	return size;
+}
+
+bool FileData::IsMapped() const
+{
+	if( parent ) {
+		return parent->IsMapped();
+	}
+	return ( nullptr != mapped_view );
+}
+
+void FileData::Prefetch() const
+{
+	if( !IsMapped() || 0 == size ) return;
+
+	// the system reads all pages in parallel, this only queues the reads and doesn't wait for them
+	WIN32_MEMORY_RANGE_ENTRY range {};
+	range.VirtualAddress	= const_cast<char*>( data );
+	range.NumberOfBytes		= size;
+	PrefetchVirtualMemory( GetCurrentProcess(), 1, &range, 0 );
+}
+
+void FileData::Clear()
+{
+	if( nullptr != mapped_view ) {
+		UnmapViewOfFile( mapped_view );
+		mapped_view		= nullptr;
+	}
+	if( NULL != mapping_handle ) {
+		CloseHandle( mapping_handle );
+		mapping_handle	= NULL;
+	}
+	if( INVALID_HANDLE_VALUE != file_handle ) {
+		CloseHandle( file_handle );
+		file_handle		= INVALID_HANDLE_VALUE;
+	}
+	buffer.clear();
+	buffer.shrink_to_fit();
+	parent				= nullptr;
+	data				= nullptr;
+	size				= 0;
+}
+
+}
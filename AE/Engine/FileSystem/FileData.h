@@ -0,0 +1,57 @@
+#pragma once
+
+#include <filesystem>
+
+#include "../BUILD_OPTIONS.h"
+#include "../Platform.h"
+
+#include "../Memory/Memory.h"
+#include "../CppFileSystem/CppFileSystem.h"
+
+namespace AE
+{
+
+// Read only contents of a file, either memory mapped or read into a heap buffer
+// File streams and file resources share this object through a SharedPointer, so a resource
+// can keep the file contents alive after the stream is closed without copying the bytes
+class FileData
+{
+public:
+	FileData();
+	FileData( const FileData & other )				= delete;
+	~FileData();
+
+	FileData			&	operator=( const FileData & other ) = delete;
+
+	// Maps the whole file into memory, returns false if the file couldn't be mapped
+	bool					MapFile( const Path & path );
+	// Reads the whole file into a heap buffer, returns false if the file couldn't be read
+	bool					ReadFile( const Path & path );
+	// Takes ownership of an already filled buffer
+	void					SetBuffer( Vector<char> && data_buffer );
+	// Uses a part of another file data, eg. an uncompressed file inside a mapped archive,
+	// parent is kept alive for as long as this object is alive
+	bool					SetView( SharedPointer<FileData> parent_data, size_t offset, size_t view_size );
+
+	ArrayView<const char>	GetData() const;
+	size_t					Size() const;
+	bool					IsMapped() const;
+	// Asks the operating system to read every page of a mapped file in now instead of
+	// when the contents are first used, returns without waiting, does nothing for heap buffers
+	void					Prefetch() const;
+
+private:
+	void					Clear();
+
+	Vector<char>			buffer;
+	SharedPointer<FileData>	parent;
+
+	const char			*	data					= nullptr;
+	size_t					size					= 0;
+
+	HANDLE					file_handle				= INVALID_HANDLE_VALUE;
+	HANDLE					mapping_handle			= NULL;
+	const void			*	mapped_view				= nullptr;
+};
+
+}
@@ -1,5 +1,7 @@
 
 #include <assert.h>
+#include <algorithm>
+#include <cstring>
 
 #include "FileStream.h"
 
@@ -14,8 +16,14 @@ FileStream::FileStream( FileSystem * file_system )
 FileStream::FileStream( FileStream && other )
 {
 	std::swap( p_file_system, other.p_file_system );
+	std::swap( mode, other.mode );
+	std::swap( file_data, other.file_data );
 	std::swap( raw_stream, other.raw_stream );
 	std::swap( cursor, other.cursor );
+	std::swap( streaming_file, other.streaming_file );
+	std::swap( stream_buffer, other.stream_buffer );
+	std::swap( stream_buffer_position, other.stream_buffer_position );
+	std::swap( stream_size, other.stream_size );
 }
 
 FileStream::~FileStream()
@@ -25,8 +33,14 @@ FileStream::~FileStream()
 FileStream & FileStream::operator=( FileStream && other )
 {
 	std::swap( p_file_system, other.p_file_system );
+	std::swap( mode, other.mode );
+	std::swap( file_data, other.file_data );
 	std::swap( raw_stream, other.raw_stream );
 	std::swap( cursor, other.cursor );
+	std::swap( streaming_file, other.streaming_file );
+	std::swap( stream_buffer, other.stream_buffer );
+	std::swap( stream_buffer_position, other.stream_buffer_position );
+	std::swap( stream_size, other.stream_size );
 	return *this;
 }
 
@@ -34,21 +48,186 @@ void FileStream::Seek( size_t cursor_position )
 {
 	cursor										= cursor_position;
 	if( cursor < 0 )					cursor	= 0;
-	if( cursor >= raw_stream.size() )	cursor	= raw_stream.size() - 1;
+	if( cursor >= Size() )				cursor	= Size() - 1;
 }
 
-const Vector<char>& FileStream::GetRawStream() const
+FileStream::Mode FileStream::GetMode() const
 {
-	return raw_stream;
+	return mode;
 }
 
-Vector<char>& FileStream::GetEditableRawStream()
+ArrayView<const char> FileStream::GetRawStream() const
 {
+	assert( Mode::WHOLE_FILE == mode && "Raw stream is not available in streaming mode" );
 	return raw_stream;
 }
 
+SharedPointer<FileData> FileStream::GetFileData() const
+{
+	assert( Mode::WHOLE_FILE == mode && "File data is not available in streaming mode" );
+	return file_data;
+}
+
+void FileStream::SetFileData( SharedPointer<FileData> data )
+{
+	mode			= Mode::WHOLE_FILE;
+	file_data		= data;
+	raw_stream		= ArrayView<const char>();
+	if( file_data ) {
+		raw_stream	= file_data->GetData();
+	}
+	cursor			= 0;
+}
+
+bool FileStream::OpenStreaming( const Path & path )
+{
+	auto streaming			= MakeUniquePointer<StreamingFile>();
+	streaming->file_handle	= CreateFileW( path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+	if( INVALID_HANDLE_VALUE == streaming->file_handle ) {
+		return false;
+	}
+	LARGE_INTEGER file_size {};
+	if( !GetFileSizeEx( streaming->file_handle, &file_size ) ) {
+		return false;
+	}
+	streaming->read_event	= CreateEventW( NULL, TRUE, FALSE, NULL );
+	if( NULL == streaming->read_event ) {
+		return false;
+	}
+	mode					= Mode::STREAMING;
+	streaming_file			= std::move( streaming );
+	stream_size				= size_t( file_size.QuadPart );
+	stream_buffer.reserve( BUILD_FILE_STREAM_BUFFER_SIZE );
+	stream_buffer_position	= 0;
+	cursor					= 0;
+	return true;
+}
+
+const char * FileStream::AcquireBytes( size_t amount )
+{
+	if( Mode::WHOLE_FILE == mode ) {
+		return raw_stream.data() + cursor;
+	}
+	assert( amount <= BUILD_FILE_STREAM_BUFFER_SIZE && "Single read doesn't fit the stream buffer, increase BUILD_FILE_STREAM_BUFFER_SIZE" );
+	if( cursor < stream_buffer_position || cursor + amount > stream_buffer_position + stream_buffer.size() ) {
+		FillStreamBuffer( cursor );
+	}
+	return stream_buffer.data() + ( cursor - stream_buffer_position );
+}
+
+void FileStream::ReadStreaming( char * data, size_t amount )
+{
+	size_t position		= cursor;
+	// copy whatever is already in the buffer
+	if( position >= stream_buffer_position && position < stream_buffer_position + stream_buffer.size() ) {
+		size_t buffered	= std::min( amount, stream_buffer_position + stream_buffer.size() - position );
+		std::memcpy( data, stream_buffer.data() + ( position - stream_buffer_position ), buffered );
+		data			+= buffered;
+		position		+= buffered;
+		amount			-= buffered;
+	}
+	if( 0 == amount ) return;
+
+	if( amount >= BUILD_FILE_STREAM_BUFFER_SIZE ) {
+		// big ranges go straight to the destination, buffering them would only add a copy
+		streaming_file->Read( position, data, amount );
+	} else {
+		FillStreamBuffer( position );
+		std::memcpy( data, stream_buffer.data(), std::min( amount, stream_buffer.size() ) );
+	}
+}
+
+void FileStream::FillStreamBuffer( size_t position )
+{
+	assert( Mode::STREAMING == mode );
+	size_t fill_size		= std::min( size_t( BUILD_FILE_STREAM_BUFFER_SIZE ), stream_size - std::min( position, stream_size ) );
+	stream_buffer_position	= position;
+
+	// sequential reads find the buffer already read ahead
+	auto streaming			= streaming_file.Get();
+	if( streaming->WaitReadAhead() && streaming->read_ahead_position == position && streaming->read_ahead_buffer.size() == fill_size ) {
+		std::swap( stream_buffer, streaming->read_ahead_buffer );
+		// keeps the memory of the old buffer for the next read ahead
+		streaming->read_ahead_buffer.clear();
+	} else {
+		stream_buffer.resize( fill_size );
+		streaming->Read( position, stream_buffer.data(), fill_size );
+	}
+
+	auto next_position		= position + fill_size;
+	if( next_position < stream_size ) {
+		streaming->StartReadAhead( next_position, std::min( size_t( BUILD_FILE_STREAM_BUFFER_SIZE ), stream_size - next_position ) );
+	}
+}
+
+FileStream::StreamingFile::~StreamingFile()
+{
+	if( read_ahead_pending ) {
+		// the buffer can't be freed while the system may still write into it
+		CancelIoEx( file_handle, &overlapped );
+		DWORD transferred	= 0;
+		GetOverlappedResult( file_handle, &overlapped, &transferred, TRUE );
+	}
+	if( NULL != read_event ) {
+		CloseHandle( read_event );
+	}
+	if( INVALID_HANDLE_VALUE != file_handle ) {
+		CloseHandle( file_handle );
+	}
+}
+
+bool FileStream::StreamingFile::Read( size_t position, char * data, size_t amount )
+{
+	WaitReadAhead();
+	while( amount ) {
+		// single read is limited to a DWORD
+		DWORD chunk_size		= DWORD( std::min<size_t>( amount, 1 << 30 ) );
+		DWORD transferred		= 0;
+		overlapped				= OVERLAPPED {};
+		overlapped.Offset		= DWORD( uint64_t( position ) & 0xFFFFFFFF );
+		overlapped.OffsetHigh	= DWORD( uint64_t( position ) >> 32 );
+		overlapped.hEvent		= read_event;
+		if( !ReadFile( file_handle, data, chunk_size, NULL, &overlapped ) && GetLastError() != ERROR_IO_PENDING ) return false;
+		if( !GetOverlappedResult( file_handle, &overlapped, &transferred, TRUE ) || 0 == transferred ) return false;
+		position				+= transferred;
+		data					+= transferred;
+		amount					-= transferred;
+	}
+	return true;
+}
+
+void FileStream::StreamingFile::StartReadAhead( size_t position, size_t amount )
+{
+	assert( !read_ahead_pending );
+	read_ahead_buffer.resize( amount );
+	read_ahead_position		= position;
+	overlapped				= OVERLAPPED {};
+	overlapped.Offset		= DWORD( uint64_t( position ) & 0xFFFFFFFF );
+	overlapped.OffsetHigh	= DWORD( uint64_t( position ) >> 32 );
+	overlapped.hEvent		= read_event;
+	if( !ReadFile( file_handle, read_ahead_buffer.data(), DWORD( amount ), NULL, &overlapped ) && GetLastError() != ERROR_IO_PENDING ) {
+		read_ahead_buffer.clear();
+		return;
+	}
+	read_ahead_pending		= true;
+}
+
+bool FileStream::StreamingFile::WaitReadAhead()
+{
+	if( !read_ahead_pending ) return read_ahead_buffer.size() > 0;
+	read_ahead_pending		= false;
+
+	DWORD transferred		= 0;
+	if( !GetOverlappedResult( file_handle, &overlapped, &transferred, TRUE ) || transferred != read_ahead_buffer.size() ) {
+		read_ahead_buffer.clear();
+		return false;
+	}
+	return true;
+}
+
 String FileStream::ReadLine()
 {
+	assert( Mode::WHOLE_FILE == mode && "ReadLine is not supported in streaming mode" );
 	String ret;
 	auto pos	= cursor;
 	while( true ) {
@@ -83,12 +262,15 @@ size_t FileStream::Tell() const
 
 size_t FileStream::Size() const
 {
+	if( Mode::STREAMING == mode ) {
+		return stream_size;
+	}
 	return raw_stream.size();
 }
 
 bool FileStream::EndOfStream()
 {
-	return ( cursor == raw_stream.size() );
+	return ( cursor == Size() );
 }
 
 }
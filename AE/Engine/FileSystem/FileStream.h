@@ -1,11 +1,13 @@
 #pragma once
 
 #include <filesystem>
+#include <fstream>
 
 #include "../BUILD_OPTIONS.h"
 #include "../Platform.h"
 
 #include "../Memory/Memory.h"
+#include "FileData.h"
 
 namespace AE
 {
@@ -15,8 +17,16 @@ class FileSystem;
 class FileStream
 {
 	friend class FileSystem;
+	friend void FileIOThread( FileSystem * file_system );
 
 public:
+	enum class Mode : uint32_t
+	{
+		WHOLE_FILE,			// whole file is mapped or read into memory when the stream is opened
+		STREAMING,			// file is read through a bounded buffer as the cursor moves, raw stream is not available
+							// the next buffer is read ahead with overlapped I/O while the current one is used
+	};
+
 	FileStream()							= delete;
 	FileStream( FileSystem * file_system );
 	FileStream( FileStream & other )		= delete;
@@ -30,35 +40,94 @@ public:
 	size_t					Tell() const;
 	size_t					Size() const;
 	bool					EndOfStream();
-	const Vector<char>	&	GetRawStream() const;
-	Vector<char>		&	GetEditableRawStream();
+	Mode					GetMode() const;
+	// read only view over the whole file, valid as long as the stream or the file data is alive
+	// not available in streaming mode
+	ArrayView<const char>	GetRawStream() const;
+	// file contents shared with this stream, keep this around to use the file contents after the stream is closed
+	// not available in streaming mode
+	SharedPointer<FileData>	GetFileData() const;
 
 	// read bytes similarly to fstream, returns the actual amount of bytes read
 	template<typename D>
 	size_t Read( D * data, size_t amount )
 	{
-		assert( ( cursor + amount * sizeof( D ) ) <= raw_stream.size() );
+		assert( ( cursor + amount * sizeof( D ) ) <= Size() );
 
-		size_t read_amount_bytes = std::min( amount * sizeof( D ), raw_stream.size() - cursor );
-		std::memcpy( data, raw_stream.data() + cursor, read_amount_bytes );
+		size_t read_amount_bytes = std::min( amount * sizeof( D ), Size() - cursor );
+		if( Mode::STREAMING == mode ) {
+			ReadStreaming( (char*)data, read_amount_bytes );
+		} else {
+			std::memcpy( data, raw_stream.data() + cursor, read_amount_bytes );
+		}
 		cursor += read_amount_bytes;
 		return read_amount_bytes;
 	}
 
+	// read bytes from a position without touching the cursor, returns the actual amount of bytes read
+	template<typename D>
+	size_t ReadRange( size_t position, D * data, size_t amount )
+	{
+		auto old_cursor		= cursor;
+		cursor				= std::min( position, Size() );
+		auto read_amount	= Read( data, amount );
+		cursor				= old_cursor;
+		return read_amount;
+	}
+
+	// returned reference is only valid until the next read
 	template<typename T>
 	const T & Read()
 	{
-		assert( ( cursor + sizeof( T ) ) < raw_stream.size() );
-		return *( (T*)( raw_stream.data() + cursor ) );
-		cursor += sizeof( T );
+		assert( ( cursor + sizeof( T ) ) <= Size() );
+		auto data		= AcquireBytes( sizeof( T ) );
+		cursor			+= sizeof( T );
+		return *( (const T*)data );
 	}
 
 	String					ReadLine();
 
 private:
-	FileSystem			*	p_file_system		= nullptr;
-	Vector<char>			raw_stream;
-	size_t					cursor				= 0;
+	void					SetFileData( SharedPointer<FileData> data );
+	bool					OpenStreaming( const Path & path );
+
+	// returns a pointer to at least amount bytes at the cursor, refills the stream buffer if needed
+	const char			*	AcquireBytes( size_t amount );
+	void					ReadStreaming( char * data, size_t amount );
+	// reads from the cursor forward, buffer always holds the next buffer size bytes of the file
+	// and the read of the buffer after it is started right away
+	void					FillStreamBuffer( size_t position );
+
+	// streaming mode only, lives on the heap so that the overlapped structure of a read
+	// in flight stays put when the stream is moved
+	struct StreamingFile
+	{
+		HANDLE				file_handle				= INVALID_HANDLE_VALUE;
+		HANDLE				read_event				= NULL;
+		OVERLAPPED			overlapped				{};
+		Vector<char>		read_ahead_buffer;
+		size_t				read_ahead_position		= 0;	// position of the first byte of the read ahead buffer in the file
+		bool				read_ahead_pending		= false;
+
+		~StreamingFile();
+		// blocking read, waits for the read ahead first as only one read can be in flight
+		bool				Read( size_t position, char * data, size_t amount );
+		void				StartReadAhead( size_t position, size_t amount );
+		// returns false if the read ahead failed, the read ahead buffer is empty after that
+		bool				WaitReadAhead();
+	};
+
+	FileSystem			*	p_file_system			= nullptr;
+	Mode					mode					= Mode::WHOLE_FILE;
+	SharedPointer<FileData>	file_data;
+	ArrayView<const char>	raw_stream;
+	size_t					cursor					= 0;
+
+	// streaming mode only
+	UniquePointer<StreamingFile>	streaming_file;
+	Vector<char>			stream_buffer;
+	size_t					stream_buffer_position	= 0;	// position of the first byte of the stream buffer in the file
+	size_t					stream_size				= 0;
 };
 
 }
@@ -1,5 +1,6 @@
 
 #include <fstream>
+#include <algorithm>
 
 #include <assert.h>
 
@@ -11,32 +12,92 @@
 namespace AE
 {
 
+void FileIOThread( FileSystem * file_system )
+{
+	assert( nullptr != file_system );
+
+	MEMORY_TAG( "File system I/O" );
+
+	while( true ) {
+		DWORD			bytes_transferred	= 0;
+		ULONG_PTR		key					= 0;
+		OVERLAPPED	*	overlapped			= nullptr;
+		BOOL succeeded	= GetQueuedCompletionStatus( file_system->io_completion_port, &bytes_transferred, &key, &overlapped, INFINITE );
+		// empty packets are only posted when the file system shuts down, after every request has finished
+		if( nullptr == overlapped ) {
+			return;
+		}
+
+		auto request	= reinterpret_cast<FileSystem::AsyncOpenRequest*>( overlapped );
+		if( FileSystem::IOCompletionKey( key ) == FileSystem::IOCompletionKey::OPEN_REQUEST ) {
+			file_system->StartAsyncOpen( request );
+		} else {
+			file_system->ContinueAsyncRead( request, FALSE != succeeded, bytes_transferred );
+		}
+	}
+}
+
 FileSystem::FileSystem( Engine * engine )
 	: SubSystem( engine, "FileSystem" )
 {
+	if( fsys::is_regular_file( BUILD_FILE_SYSTEM_DEFAULT_ARCHIVE ) ) {
+		MountArchive( BUILD_FILE_SYSTEM_DEFAULT_ARCHIVE, BUILD_FILE_SYSTEM_DEFAULT_ARCHIVE_MOUNT_POINT );
+	}
+
+	io_completion_port	= CreateIoCompletionPort( INVALID_HANDLE_VALUE, NULL, 0, 0 );
+	assert( NULL != io_completion_port && "Couldn't create the I/O completion port" );
+
+	for( auto & t : io_threads ) {
+		t				= std::thread( FileIOThread, this );
+	}
 }
 
 FileSystem::~FileSystem()
 {
+	// requests are always finished before exiting so that nobody is left waiting for a callback
+	{
+		std::unique_lock<std::mutex> requests_guard( mutex_async_requests );
+		async_requests_done.wait( requests_guard, [ this ]() {
+			return async_requests.empty();
+		} );
+	}
+	for( size_t i=0; i < io_threads.size(); ++i ) {
+		PostQueuedCompletionStatus( io_completion_port, 0, 0, NULL );
+	}
+	for( auto & t : io_threads ) {
+		t.join();
+	}
+	CloseHandle( io_completion_port );
 }
 
-FileStream * FileSystem::OpenFileStream( Path path )
+FileStream * FileSystem::OpenFileStream( Path path, FileStream::Mode mode )
 {
-	TODO( "File archive support" );
+	auto archive_stream		= OpenArchiveFileStream( path );
+	if( nullptr != archive_stream ) {
+		return archive_stream;
+	}
 
-	FileStream		*	ret		= nullptr;
-	if( fsys::is_regular_file( path ) ) {
-		std::ifstream file( path, std::fstream::out | std::fstream::binary | std::fstream::ate );
-		if( file.good() && file.is_open() ) {
-			int64_t		file_size	= int64_t( file.tellg() );
-			file.seekg( 0 );
+	if( FileStream::Mode::STREAMING == mode && fsys::is_regular_file( path ) ) {
+		auto filestream			= FileStream( this );
+		if( filestream.OpenStreaming( path ) ) {
+			return AddOpenedStream( std::move( filestream ) );
+		}
+	} else if( fsys::is_regular_file( path ) ) {
+		auto	file_data		= MakeSharedPointer<FileData>();
+		bool	file_opened		= false;
+#if BUILD_FILE_SYSTEM_MEMORY_MAP_FILES
+		// small files are cheaper to read than to map, mapping granularity is 64 KiB on windows
+		if( fsys::file_size( path ) >= BUILD_FILE_SYSTEM_MEMORY_MAP_MIN_FILE_SIZE ) {
+			file_opened			= file_data->MapFile( path );
+		}
+#endif
+		if( !file_opened ) {
+			file_opened			= file_data->ReadFile( path );
+		}
+		if( file_opened ) {
 			auto filestream			= FileStream( this );
-			filestream.raw_stream.resize( file_size );
-			file.read( filestream.raw_stream.data(), file_size );
-
-			std::lock_guard<std::mutex> opened_streams_guard( mutex_opened_streams );
-			opened_streams.push_back( std::move( filestream ) );
-			return &opened_streams.back();
+			filestream.SetFileData( file_data );
+			return AddOpenedStream( std::move( filestream ) );
 		}
 	}
 	p_logger->LogError( String( "File not found: " ) + path.string().c_str() );
@@ -46,10 +107,183 @@ FileStream * FileSystem::OpenFileStream( Path path )
 void FileSystem::CloseFileStream( FileStream * stream )
 {
 	if( nullptr		!= stream ) {
+		std::lock_guard<std::mutex> opened_streams_guard( mutex_opened_streams );
 		opened_streams.remove_if([stream](FileStream & i){
 			return stream == &i;
 		} );
 	}
 }
 
+void FileSystem::OpenFileStreamAsync( Path path, FileStream::Mode mode, std::function<void( FileStream* )> on_opened )
+{
+	assert( on_opened );
+	AsyncOpenRequest * request		= nullptr;
+	{
+		std::lock_guard<std::mutex> requests_guard( mutex_async_requests );
+		async_requests.emplace_back();
+		request						= &async_requests.back();
+		request->path				= std::move( path );
+		request->mode				= mode;
+		request->on_opened			= std::move( on_opened );
+	}
+	PostQueuedCompletionStatus( io_completion_port, 0, ULONG_PTR( IOCompletionKey::OPEN_REQUEST ), &request->overlapped );
+}
+
+bool FileSystem::MountArchive( const Path & archive_path, const Path & mount_point )
+{
+	FileArchive archive;
+	if( !archive.Open( archive_path, mount_point ) ) {
+		p_logger->LogError( String( "Couldn't mount archive: " ) + archive_path.string().c_str() );
+		return false;
+	}
+	p_logger->LogInfo( String( "Mounted archive: " ) + archive_path.string().c_str() + " with " +
+		std::to_string( archive.GetEntryCount() ).c_str() + " files at: " + mount_point.string().c_str() );
+
+	std::lock_guard<std::mutex> archives_guard( mutex_archives );
+	archives.push_front( std::move( archive ) );
+	return true;
+}
+
+FileStream * FileSystem::OpenArchiveFileStream( const Path & path )
+{
+	// only the lookup is done under the lock, entries are decompressed in parallel
+	SharedPointer<FileData>		archive_data;
+	FileArchive::Entry			archive_entry {};
+	{
+		std::lock_guard<std::mutex> archives_guard( mutex_archives );
+		for( auto & a : archives ) {
+			auto entry		= a.FindEntry( path );
+			if( entry ) {
+				archive_data	= a.GetArchiveData();
+				archive_entry	= *entry;
+				break;
+			}
+		}
+	}
+	if( !archive_data ) {
+		return nullptr;
+	}
+
+	auto archive_file_data		= FileArchive::OpenEntry( archive_data, archive_entry );
+	if( !archive_file_data ) {
+		p_logger->LogError( String( "Corrupted archive entry: " ) + path.string().c_str() );
+		return nullptr;
+	}
+	auto filestream				= FileStream( this );
+	filestream.SetFileData( archive_file_data );
+	return AddOpenedStream( std::move( filestream ) );
+}
+
+FileStream * FileSystem::AddOpenedStream( FileStream && stream )
+{
+	std::lock_guard<std::mutex> opened_streams_guard( mutex_opened_streams );
+	opened_streams.push_back( std::move( stream ) );
+	return &opened_streams.back();
+}
+
+void FileSystem::StartAsyncOpen( AsyncOpenRequest * request )
+{
+	assert( nullptr != request );
+
+	// archive entries are already in memory, mapped or decompressed
+	auto stream				= OpenArchiveFileStream( request->path );
+	if( nullptr != stream ) {
+		stream->file_data->Prefetch();
+		FinishAsyncOpen( request, stream );
+		return;
+	}
+
+	std::error_code error;
+	auto file_size			= fsys::file_size( request->path, error );
+	bool map_file			= BUILD_FILE_SYSTEM_MEMORY_MAP_FILES && !error && file_size >= BUILD_FILE_SYSTEM_MEMORY_MAP_MIN_FILE_SIZE;
+	if( FileStream::Mode::STREAMING == request->mode || map_file || error ) {
+		// streaming files read their first buffer and start reading ahead, mapped files request
+		// all of their pages, neither waits for more than one read at a time on this thread
+		stream				= OpenFileStream( request->path, request->mode );
+		if( nullptr != stream ) {
+			if( FileStream::Mode::STREAMING == stream->GetMode() ) {
+				if( stream->Size() ) {
+					stream->FillStreamBuffer( 0 );
+				}
+			} else if( stream->file_data ) {
+				stream->file_data->Prefetch();
+			}
+		}
+		FinishAsyncOpen( request, stream );
+		return;
+	}
+
+	// everything else is read with overlapped reads, the thread is free for other requests until the read completes
+	request->file_handle	= CreateFileW( request->path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+	LARGE_INTEGER handle_file_size {};
+	if( INVALID_HANDLE_VALUE == request->file_handle ||
+		!GetFileSizeEx( request->file_handle, &handle_file_size ) ||
+		NULL == CreateIoCompletionPort( request->file_handle, io_completion_port, ULONG_PTR( IOCompletionKey::READ ), 0 ) ) {
+		p_logger->LogError( String( "File not found: " ) + request->path.string().c_str() );
+		FinishAsyncOpen( request, nullptr );
+		return;
+	}
+	request->buffer.resize( size_t( handle_file_size.QuadPart ) );
+	request->bytes_read		= 0;
+	StartAsyncRead( request );
+}
+
+void FileSystem::StartAsyncRead( AsyncOpenRequest * request )
+{
+	assert( nullptr != request );
+
+	if( request->bytes_read == request->buffer.size() ) {
+		auto file_data			= MakeSharedPointer<FileData>();
+		file_data->SetBuffer( std::move( request->buffer ) );
+		auto filestream			= FileStream( this );
+		filestream.SetFileData( file_data );
+		FinishAsyncOpen( request, AddOpenedStream( std::move( filestream ) ) );
+		return;
+	}
+
+	// single read is limited to a DWORD, the completion packet is queued even if the read finishes right away
+	auto position				= uint64_t( request->bytes_read );
+	auto chunk_size				= DWORD( std::min<size_t>( request->buffer.size() - request->bytes_read, 1 << 30 ) );
+	request->overlapped			= OVERLAPPED {};
+	request->overlapped.Offset		= DWORD( position & 0xFFFFFFFF );
+	request->overlapped.OffsetHigh	= DWORD( position >> 32 );
+	if( !::ReadFile( request->file_handle, request->buffer.data() + request->bytes_read, chunk_size, NULL, &request->overlapped ) &&
+		GetLastError() != ERROR_IO_PENDING ) {
+		p_logger->LogError( String( "Couldn't read file: " ) + request->path.string().c_str() );
+		FinishAsyncOpen( request, nullptr );
+	}
+}
+
+void FileSystem::ContinueAsyncRead( AsyncOpenRequest * request, bool succeeded, DWORD bytes_transferred )
+{
+	assert( nullptr != request );
+
+	// the file can't be shorter than it was when it was opened, it's only opened for sharing reads
+	if( !succeeded || 0 == bytes_transferred ) {
+		p_logger->LogError( String( "Couldn't read file: " ) + request->path.string().c_str() );
+		FinishAsyncOpen( request, nullptr );
+		return;
+	}
+	request->bytes_read		+= bytes_transferred;
+	StartAsyncRead( request );
+}
+
+void FileSystem::FinishAsyncOpen( AsyncOpenRequest * request, FileStream * stream )
+{
+	assert( nullptr != request );
+
+	if( INVALID_HANDLE_VALUE != request->file_handle ) {
+		CloseHandle( request->file_handle );
+		request->file_handle	= INVALID_HANDLE_VALUE;
+	}
+	request->on_opened( stream );
+	{
+		std::lock_guard<std::mutex> requests_guard( mutex_async_requests );
+		async_requests.remove_if( [ request ]( AsyncOpenRequest & i ) {
+			return request == &i;
+		} );
+	}
+	async_requests_done.notify_all();
+}
+
 }
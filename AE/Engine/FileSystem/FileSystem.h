@@ -2,6 +2,10 @@
 
 #include <filesystem>
 #include <mutex>
+#include <thread>
+#include <array>
+#include <functional>
+#include <condition_variable>
 
 #include "../BUILD_OPTIONS.h"
 #include "../Platform.h"
@@ -9,6 +13,7 @@
 #include "../SubSystem.h"
 #include "../Memory/Memory.h"
 #include "FileStream.h"
+#include "FileArchive.h"
 #include "../CppFileSystem/CppFileSystem.h"
 
 namespace AE
@@ -18,16 +23,73 @@ class Logger;
 
 class FileSystem : public SubSystem
 {
+	friend void FileIOThread( FileSystem * file_system );
+
 public:
 	FileSystem( Engine * engine );
 	~FileSystem();
 
-	FileStream						*	OpenFileStream( Path path );
+	// Files inside mounted archives are always opened as whole files as they are already in memory
+	FileStream						*	OpenFileStream( Path path, FileStream::Mode mode = FileStream::Mode::WHOLE_FILE );
 	void								CloseFileStream( FileStream * stream );
 
+	// Opens a file stream on one of the I/O threads and returns immediately, on_opened is called
+	// from an I/O thread with the opened stream or nullptr if the file couldn't be opened
+	// Loose whole files are read with overlapped I/O, so any number of reads can be in flight
+	// no matter how many I/O threads there are. Whole files are fully read, or mapped with all
+	// pages requested from the disk, before on_opened is called. Streaming files have their
+	// first buffer read and the next one reading ahead
+	void								OpenFileStreamAsync( Path path, FileStream::Mode mode, std::function<void( FileStream* )> on_opened );
+
+	// Mounts an archive, files inside mounted archives are found before loose files,
+	// archives mounted later are searched first
+	bool								MountArchive( const Path & archive_path, const Path & mount_point );
+
 private:
+	// I/O threads wait on the completion port for both new requests and finished reads
+	enum class IOCompletionKey : ULONG_PTR
+	{
+		OPEN_REQUEST,
+		READ,
+	};
+
+	struct AsyncOpenRequest
+	{
+		// first member so that completion packets can be turned back into their request
+		OVERLAPPED						overlapped						{};
+		Path							path;
+		FileStream::Mode				mode;
+		std::function<void( FileStream* )>	on_opened;
+
+		// loose whole files only
+		HANDLE							file_handle						= INVALID_HANDLE_VALUE;
+		Vector<char>					buffer;
+		size_t							bytes_read						= 0;
+	};
+
+	// runs on an I/O thread, either finishes the request or starts an overlapped read
+	void								StartAsyncOpen( AsyncOpenRequest * request );
+	void								StartAsyncRead( AsyncOpenRequest * request );
+	void								ContinueAsyncRead( AsyncOpenRequest * request, bool succeeded, DWORD bytes_transferred );
+	// calls on_opened and removes the request
+	void								FinishAsyncOpen( AsyncOpenRequest * request, FileStream * stream );
+
+	// nullptr if the file isn't in any mounted archive or the entry is corrupted
+	FileStream						*	OpenArchiveFileStream( const Path & path );
+	FileStream						*	AddOpenedStream( FileStream && stream );
+
 	std::mutex							mutex_opened_streams;
 	List<FileStream>					opened_streams;
+
+	std::mutex							mutex_archives;
+	List<FileArchive>					archives;
+
+	// requests stay in the list until on_opened has been called, list nodes never move
+	std::mutex							mutex_async_requests;
+	std::condition_variable				async_requests_done;
+	List<AsyncOpenRequest>				async_requests;
+	HANDLE								io_completion_port					= NULL;
+	std::array<std::thread, BUILD_FILE_SYSTEM_IO_THREAD_COUNT>	io_threads;
 };
 
 }
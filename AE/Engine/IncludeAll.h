@@ -9,6 +9,9 @@
 // logger
 #include "Logger/Logger.h"
 
+// benchmarks
+#include "Profiler/Benchmark.h"
+
 // filesystem
 #include "FileSystem/FileSystem.h"
 
@@ -20,6 +23,8 @@
 #include "FileResource/XML/FileResource_XML.h"
 #include "FileResource/Image/FileResource_Image.h"
 #include "FileResource/Mesh/FileResource_Mesh.h"
+#include "FileResource/Mesh/CookedMeshFile.h"
+#include "FileResource/Mesh/MeshOptimize.h"
 
 // renderer
 #include "Renderer/Renderer.h"
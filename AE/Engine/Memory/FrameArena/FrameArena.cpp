@@ -0,0 +1,170 @@
+
+#include <memory>
+
+#include "FrameArena.h"
+
+namespace AE
+{
+
+namespace engine_internal
+{
+
+// Chunk memory starts after the chunk header at this alignment
+constexpr size_t	FRAME_ARENA_CHUNK_ALIGNMENT		= 16;
+constexpr size_t	FRAME_ARENA_CHUNK_HEADER_SIZE	= 32;
+
+FrameArena::FrameArena()
+{
+}
+
+FrameArena::~FrameArena()
+{
+	FreeChunks();
+}
+
+void * FrameArena::AllocateRaw( size_t size, size_t alignment )
+{
+	assert( owner_thread == std::thread::id() || owner_thread == std::this_thread::get_id() );
+	if( 0 == size ) size		= 1;
+	if( 0 == alignment ) alignment	= 1;
+
+	if( nullptr != current_chunk ) {
+		auto	chunk_memory	= GetChunkMemory( current_chunk );
+		auto	address			= reinterpret_cast<uintptr_t>( chunk_memory ) + offset;
+		size_t	padding			= ( alignment - address % alignment ) % alignment;
+		if( offset + padding + size <= current_chunk->size ) {
+			auto memory			= chunk_memory + offset + padding;
+			offset				+= padding + size;
+			last_allocation		= memory;
+			++frame_allocation_count;
+			return memory;
+		}
+	}
+
+	// current chunk is full, worst case padding is added to the new chunk size
+	if( !AddChunk( size + alignment ) ) return nullptr;
+	return AllocateRaw( size, alignment );
+}
+
+void FrameArena::FreeRaw( void * ptr, size_t size )
+{
+	if( nullptr != ptr && ptr == last_allocation ) {
+		auto chunk_memory	= GetChunkMemory( current_chunk );
+		if( reinterpret_cast<uint8_t*>( ptr ) + size == chunk_memory + offset ) {
+			offset			= size_t( reinterpret_cast<uint8_t*>( ptr ) - chunk_memory );
+		}
+		last_allocation		= nullptr;
+	}
+}
+
+void FrameArena::Reset()
+{
+	owner_thread		= std::this_thread::get_id();
+
+	size_t used_bytes	= 0;
+	if( nullptr != current_chunk ) {
+		used_bytes		= current_chunk->used_bytes_before + offset;
+	}
+	statistics.allocation_count		= frame_allocation_count;
+	statistics.used_bytes			= used_bytes;
+	statistics.peak_bytes			= std::max( statistics.peak_bytes, uint64_t( used_bytes ) );
+
+	// more than one chunk was needed during the last frame, replace them all with
+	// a single chunk as big as all of them together so the same frame fits in one chunk
+	if( nullptr != current_chunk && nullptr != current_chunk->previous ) {
+		size_t total_size	= 0;
+		for( auto c = current_chunk; c; c = c->previous ) {
+			total_size		+= c->size;
+		}
+		FreeChunks();
+		AddChunk( total_size );
+	}
+
+	offset					= 0;
+	last_allocation			= nullptr;
+	frame_allocation_count	= 0;
+
+#if AE_DEBUG
+	// make stale frame memory easy to spot in the debugger
+	if( nullptr != current_chunk ) {
+		std::memset( GetChunkMemory( current_chunk ), 0xCD, current_chunk->size );
+	}
+#endif
+}
+
+FrameArenaStatistics FrameArena::GetStatistics() const
+{
+	FrameArenaStatistics ret	= statistics;
+	ret.reserved_bytes			= 0;
+	for( auto c = current_chunk; c; c = c->previous ) {
+		ret.reserved_bytes		+= c->size;
+	}
+	return ret;
+}
+
+bool FrameArena::AddChunk( size_t minimum_size )
+{
+	size_t size			= std::max( minimum_size, size_t( BUILD_FRAME_ARENA_CHUNK_SIZE ) );
+	size				= ( size + FRAME_ARENA_CHUNK_ALIGNMENT - 1 ) / FRAME_ARENA_CHUNK_ALIGNMENT * FRAME_ARENA_CHUNK_ALIGNMENT;
+
+	// chunks are allocated directly from the system so that the arena
+	// does not depend on the memory pool construction and destruction order
+	auto memory			= reinterpret_cast<uint8_t*>( _aligned_malloc( FRAME_ARENA_CHUNK_HEADER_SIZE + size, FRAME_ARENA_CHUNK_ALIGNMENT ) );
+	assert( memory );
+	if( nullptr == memory ) return false;
+
+	auto chunk					= new( memory ) Chunk;
+	chunk->previous				= current_chunk;
+	chunk->size					= size;
+	chunk->used_bytes_before	= 0;
+	if( nullptr != current_chunk ) {
+		chunk->used_bytes_before	= current_chunk->used_bytes_before + offset;
+	}
+	current_chunk				= chunk;
+	offset						= 0;
+	last_allocation				= nullptr;
+	return true;
+}
+
+void FrameArena::FreeChunks()
+{
+	while( nullptr != current_chunk ) {
+		auto previous		= current_chunk->previous;
+		_aligned_free( current_chunk );
+		current_chunk		= previous;
+	}
+	offset				= 0;
+	last_allocation		= nullptr;
+}
+
+uint8_t * FrameArena::GetChunkMemory( Chunk * chunk )
+{
+	static_assert( sizeof( Chunk ) <= FRAME_ARENA_CHUNK_HEADER_SIZE, "Frame arena chunk header does not fit" );
+	return reinterpret_cast<uint8_t*>( chunk ) + FRAME_ARENA_CHUNK_HEADER_SIZE;
+}
+
+std::unique_ptr<FrameArena>		frame_arena( new FrameArena );
+
+void * FrameArena_AllocateRaw( size_t size, size_t alignment )
+{
+	return frame_arena->AllocateRaw( size, alignment );
+}
+
+void FrameArena_FreeRaw( void * ptr, size_t size )
+{
+	frame_arena->FreeRaw( ptr, size );
+}
+
+void FrameArena_Reset()
+{
+	frame_arena->Reset();
+}
+
+FrameArenaStatistics FrameArena_GetStatistics()
+{
+	return frame_arena->GetStatistics();
+}
+
+}
+
+}
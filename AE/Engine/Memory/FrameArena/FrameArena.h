@@ -0,0 +1,84 @@
+#pragma once
+
+#include <memory>
+#include <thread>
+
+#include "../../BUILD_OPTIONS.h"
+#include "../../Platform.h"
+
+#include "../MemoryTypes.h"
+
+namespace AE
+{
+
+namespace engine_internal
+{
+
+struct FrameArenaStatistics
+{
+	uint64_t					allocation_count				= 0;		// allocations made during the previous frame
+	uint64_t					used_bytes						= 0;		// bytes used during the previous frame
+	uint64_t					peak_bytes						= 0;		// most bytes used during a single frame so far
+	uint64_t					reserved_bytes					= 0;		// bytes currently reserved for chunks with _aligned_malloc
+};
+
+// Linear frame arena
+// Memory is handed out by bumping an offset inside a chunk and is never freed individually,
+// everything allocated during a frame is released at once when the arena is reset at the
+// beginning of the next frame. If a frame needs more memory than the chunk can hold, extra
+// chunks are allocated and on the next reset they are replaced by a single chunk big enough
+// to hold the whole frame, so after a few frames the arena settles to a single chunk.
+// Frame arena memory must not be kept over to the next frame and the arena must only be
+// used by the thread that runs the frame, worker threads should use the regular containers.
+class FrameArena
+{
+public:
+	FrameArena();
+	~FrameArena();
+
+	void					*	AllocateRaw( size_t size, size_t alignment );
+	// Frees are ignored except for the latest allocation which is rolled back,
+	// this lets a growing vector reuse its old space when nothing was allocated after it
+	void						FreeRaw( void * ptr, size_t size );
+
+	// Releases all allocations made since the last reset
+	void						Reset();
+
+	FrameArenaStatistics		GetStatistics() const;
+
+private:
+	// Chunk header, chunk memory follows right after this structure
+	struct Chunk
+	{
+		Chunk				*	previous						= nullptr;
+		size_t					size							= 0;		// usable bytes after the header
+		size_t					used_bytes_before				= 0;		// bytes used in all previous chunks
+	};
+
+	bool						AddChunk( size_t minimum_size );
+	void						FreeChunks();
+	uint8_t					*	GetChunkMemory( Chunk * chunk );
+
+	Chunk					*	current_chunk					= nullptr;
+	size_t						offset							= 0;		// offset into the current chunk
+	uint8_t					*	last_allocation					= nullptr;
+
+	uint64_t					frame_allocation_count			= 0;
+	FrameArenaStatistics		statistics;
+
+	std::thread::id				owner_thread;
+};
+
+extern std::unique_ptr<FrameArena>		frame_arena;
+
+void	*	FrameArena_AllocateRaw( size_t size, size_t alignment = 8 );
+
+void		FrameArena_FreeRaw( void * ptr, size_t size );
+
+void		FrameArena_Reset();
+
+FrameArenaStatistics	FrameArena_GetStatistics();
+
+}
+
+}
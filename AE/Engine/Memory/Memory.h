@@ -5,6 +5,8 @@
 
 #include "MemoryTypes.h"
 #include "MemoryPool/MemoryPool.h"
+#include "MemoryPool/MemoryPoolTelemetry.h"
+#include "FrameArena/FrameArena.h"
 
 namespace AE
 {
@@ -22,11 +24,25 @@ template<typename T, typename ...Args>
 SharedPointer<T> MakeSharedPointer( Args&&... args )
 {
 	static_assert( !std::is_array<T>::value, "Shared Pointer is not meant for arrays, use vector instead" );
-	return SharedPointer<T>(
-		engine_internal::MemoryPool_Allocate<SharedPointerData<T>>( 8 ),
-		engine_internal::MemoryPool_Allocate<T>( 8, std::forward<Args>( args )... ),
-		engine_internal::SharedPointerDataDeleter<SharedPointerData<T>>,
+	// reference counting structure and the object are placed in the same allocation,
+	// object is placed right after the structure at the next properly aligned offset
+	constexpr size_t object_alignment	= alignof( T ) > alignof( SharedPointerData ) ? alignof( T ) : alignof( SharedPointerData );
+	constexpr size_t object_offset		= ( sizeof( SharedPointerData ) + alignof( T ) - 1 ) / alignof( T ) * alignof( T );
+	auto memory			= reinterpret_cast<uint8_t*>( engine_internal::MemoryPool_AllocateRaw( object_offset + sizeof( T ), object_alignment > 8 ? object_alignment : 8 ) );
+	assert( memory );
+	auto object			= new( memory + object_offset ) T( std::forward<Args>( args )... );
+	auto structure		= new( memory ) SharedPointerData(
+		object,
+		engine_internal::SharedPointerDataDeleter<SharedPointerData>,
 		engine_internal::SharedPointerDeleter<T> );
+	return SharedPointer<T>( structure, object );
+}
+
+template<typename T, typename ...Args>
+IntrusivePointer<T> MakeIntrusivePointer( Args&&... args )
+{
+	static_assert( std::is_base_of<IntrusiveReferenceCount, T>::value, "Intrusive Pointer object must inherit IntrusiveReferenceCount" );
+	return IntrusivePointer<T>( engine_internal::MemoryPool_Allocate<T>( 8, std::forward<Args>( args )... ) );
 }
 
 }
@@ -2,8 +2,10 @@
 #include <memory>
 
 #include "MemoryPool.h"
+#include "MemoryPoolTelemetry.h"
 
 #include <iostream>
+#include <fstream>
 
 namespace AE
 {
@@ -11,48 +13,308 @@ namespace AE
 namespace engine_internal
 {
 
+// Every block handed out by the memory pool is preceded by this header
+struct BlockHeader
+{
+	uint32_t			size_class;				// size class index or MemoryPool::LARGE_BLOCK
+	uint32_t			alignment_offset;		// large blocks only, distance from the system allocation to the user pointer
+	uint64_t			size			: 48;	// requested size in bytes
+	uint64_t			tag				: 16;	// memory tag the allocation was recorded under, see MemoryPoolTelemetry.h
+};
+static_assert( sizeof( BlockHeader ) == MemoryPool::BLOCK_ALIGNMENT, "Memory pool block header must be exactly one block alignment in size" );
+static_assert( BUILD_MEMORY_POOL_SLAB_SIZE >= 4 * ( MemoryPool::MAX_SMALL_BLOCK_SIZE + MemoryPool::BLOCK_ALIGNMENT ), "Memory pool slab size is too small for the largest size class" );
+static_assert( BUILD_MEMORY_POOL_THREAD_CACHE_BLOCK_COUNT >= 2, "Memory pool thread cache must be able to hold at least 2 blocks" );
+
+// Usable block sizes of each size class, roughly 4 classes per power of two
+// to keep the internal fragmentation at or below 25%
+constexpr size_t size_class_block_sizes[ MemoryPool::SIZE_CLASS_COUNT ] = {
+	16,		32,		48,		64,
+	80,		96,		112,	128,
+	160,	192,	224,	256,
+	320,	384,	448,	512,
+	640,	768,	896,	1024,
+	1280,	1536,	1792,	2048,
+};
+static_assert( size_class_block_sizes[ MemoryPool::SIZE_CLASS_COUNT - 1 ] == MemoryPool::MAX_SMALL_BLOCK_SIZE, "Last size class must match the maximum small block size" );
+
+BlockHeader * GetBlockHeader( void * ptr )
+{
+	return reinterpret_cast<BlockHeader*>( reinterpret_cast<uint8_t*>( ptr ) - sizeof( BlockHeader ) );
+}
+
+// Set while the memory pool exists, thread caches of threads that outlive
+// the memory pool must not return their blocks to a destroyed pool
+std::atomic<MemoryPool*>		alive_memory_pool( nullptr );
+
+// Per thread cache of free blocks, one singly linked list per size class
+struct MemoryPoolThreadCache
+{
+	struct Bin
+	{
+		MemoryPool::FreeBlock	*	list		= nullptr;
+		uint32_t					count		= 0;
+	};
+
+	~MemoryPoolThreadCache()
+	{
+		Flush();
+	}
+
+	void Flush()
+	{
+		if( nullptr == owner || alive_memory_pool != owner ) return;
+		for( uint32_t i=0; i < MemoryPool::SIZE_CLASS_COUNT; ++i ) {
+			auto & bin		= bins[ i ];
+			if( nullptr != bin.list ) {
+				auto last	= bin.list;
+				while( nullptr != last->next ) last = last->next;
+				owner->ReturnBlocksToSizeClass( i, bin.list, last );
+			}
+			bin.list		= nullptr;
+			bin.count		= 0;
+		}
+	}
+
+	MemoryPool									*	owner		= nullptr;
+	Array<Bin, MemoryPool::SIZE_CLASS_COUNT>		bins		= {};
+};
+
+thread_local MemoryPoolThreadCache		thread_cache;
+
 MemoryPool::MemoryPool()
 {
+	allocation_counter		= 0;
+
+	uint32_t size_class_index	= 0;
+	for( size_t i=0; i < size_class_lookup.size(); ++i ) {
+		while( size_class_block_sizes[ size_class_index ] < i * BLOCK_ALIGNMENT ) {
+			++size_class_index;
+		}
+		size_class_lookup[ i ]	= uint8_t( size_class_index );
+	}
+	for( uint32_t i=0; i < SIZE_CLASS_COUNT; ++i ) {
+		size_classes[ i ].block_size	= size_class_block_sizes[ i ];
+	}
+
+	alive_memory_pool		= this;
 }
 
 MemoryPool::~MemoryPool()
 {
+	// any block still cached by a thread is released with the slabs below
+	alive_memory_pool		= nullptr;
+
+#if BUILD_MEMORY_POOL_TELEMETRY
+	if( 0 != allocation_counter ) {
+		// memory leaks, write out the report to find out which tags still hold memory
+		std::ofstream leak_report( "MemoryLeakReport.log" );
+		leak_report << allocation_counter << " allocations were not freed\n";
+		MemoryPool_WriteTelemetryReport( leak_report );
+	}
+#endif
 	assert( 0 == allocation_counter );
+
+	for( auto & c : size_classes ) {
+		LOCK_GUARD( c.mutex );
+		while( nullptr != c.slab_list ) {
+			auto next		= c.slab_list->next;
+			_aligned_free( c.slab_list );
+			c.slab_list		= next;
+		}
+		c.free_list			= nullptr;
+	}
 }
 
 void * MemoryPool::AllocateRaw( size_t size, size_t alignment )
 {
-	LOCK_GUARD( mutex_general );
-	TODO( "Implement proper memory pool functionality" );
-	++allocation_counter;
-//	return ::operator new( size );
-	return _aligned_malloc( size, alignment );
+	void * memory		= nullptr;
+	if( size <= MAX_SMALL_BLOCK_SIZE && alignment <= BLOCK_ALIGNMENT ) {
+		auto size_class_index	= size_class_lookup[ ( size + BLOCK_ALIGNMENT - 1 ) / BLOCK_ALIGNMENT ];
+		memory					= AllocateSmall( size_class_index );
+	} else {
+		memory					= AllocateLarge( size, alignment );
+	}
+	if( memory ) {
+		auto header		= GetBlockHeader( memory );
+		header->size	= size;
+		header->tag		= 0;
+#if BUILD_MEMORY_POOL_TELEMETRY
+		header->tag		= MemoryPool_GetCurrentTag();
+		MemoryPool_RecordAllocation( uint16_t( header->tag ), size );
+#endif
+		++allocation_counter;
+	}
+	return memory;
 }
 
 void * MemoryPool::ReallocateRaw( void * old_ptr, size_t new_size, size_t alignment )
 {
-	LOCK_GUARD( mutex_general );
-	TODO( "Implement proper memory pool functionality" );
-	auto memory = _aligned_realloc( old_ptr, new_size, alignment );
-	if( memory ) {
-		return memory;
-	} else {
+	if( nullptr == old_ptr ) {
+		return AllocateRaw( new_size, alignment );
+	}
+	if( 0 == new_size ) {
 		FreeRaw( old_ptr );
 		return nullptr;
 	}
+
+	// blocks can be reused in place if the new size still fits in and alignment is satisfied
+	auto header			= GetBlockHeader( old_ptr );
+	bool is_aligned		= ( reinterpret_cast<uintptr_t>( old_ptr ) % std::max( alignment, size_t( 1 ) ) ) == 0;
+	if( is_aligned ) {
+		if( header->size_class != LARGE_BLOCK && new_size <= size_classes[ header->size_class ].block_size ) {
+#if BUILD_MEMORY_POOL_TELEMETRY
+			MemoryPool_RecordFree( uint16_t( header->tag ), size_t( header->size ) );
+			MemoryPool_RecordAllocation( uint16_t( header->tag ), new_size );
+#endif
+			header->size	= new_size;
+			return old_ptr;
+		}
+		if( header->size_class == LARGE_BLOCK && new_size <= header->size ) {
+			return old_ptr;
+		}
+	}
+
+	auto memory			= AllocateRaw( new_size, alignment );
+	if( memory ) {
+		std::memcpy( memory, old_ptr, size_t( std::min( uint64_t( new_size ), uint64_t( header->size ) ) ) );
+	}
+	FreeRaw( old_ptr );
+	return memory;
 }
 
 void MemoryPool::FreeRaw( void * ptr )
 {
-	LOCK_GUARD( mutex_general );
-	TODO( "Implement proper memory pool functionality" );
-//	::operator delete( ptr );
 	if( ptr ) {
-		_aligned_free( ptr );
+		auto header		= GetBlockHeader( ptr );
+#if BUILD_MEMORY_POOL_TELEMETRY
+		MemoryPool_RecordFree( uint16_t( header->tag ), size_t( header->size ) );
+#endif
+		if( header->size_class == LARGE_BLOCK ) {
+			FreeLarge( ptr );
+		} else {
+			FreeSmall( header->size_class, ptr );
+		}
 		--allocation_counter;
 	}
 }
 
+void * MemoryPool::AllocateSmall( uint32_t size_class_index )
+{
+	auto & cache		= thread_cache;
+	if( cache.owner != this ) {
+		cache.Flush();
+		cache.owner		= this;
+	}
+
+	auto & bin			= cache.bins[ size_class_index ];
+	if( nullptr == bin.list ) {
+		bin.count		= TakeBlocksFromSizeClass( size_class_index, BUILD_MEMORY_POOL_THREAD_CACHE_BLOCK_COUNT / 2, &bin.list );
+		if( nullptr == bin.list ) return nullptr;
+	}
+	auto block			= bin.list;
+	bin.list			= block->next;
+	--bin.count;
+	return block;
+}
+
+void MemoryPool::FreeSmall( uint32_t size_class_index, void * ptr )
+{
+	auto & cache		= thread_cache;
+	if( cache.owner != this ) {
+		cache.Flush();
+		cache.owner		= this;
+	}
+
+	auto & bin			= cache.bins[ size_class_index ];
+	auto block			= reinterpret_cast<FreeBlock*>( ptr );
+	block->next			= bin.list;
+	bin.list			= block;
+	++bin.count;
+
+	// thread cache is full, return half of it so that blocks freed
+	// by one thread can be reused by the other threads
+	if( bin.count > BUILD_MEMORY_POOL_THREAD_CACHE_BLOCK_COUNT ) {
+		uint32_t	return_count	= bin.count / 2;
+		FreeBlock *	first			= bin.list;
+		FreeBlock *	last			= bin.list;
+		for( uint32_t i=1; i < return_count; ++i ) {
+			last	= last->next;
+		}
+		bin.list	= last->next;
+		bin.count	-= return_count;
+		ReturnBlocksToSizeClass( size_class_index, first, last );
+	}
+}
+
+void * MemoryPool::AllocateLarge( size_t size, size_t alignment )
+{
+	// user pointer is offset from the system allocation by at least the header size while keeping the alignment
+	size_t	offset		= std::max( alignment, BLOCK_ALIGNMENT );
+	auto	raw			= reinterpret_cast<uint8_t*>( _aligned_malloc( size + offset, offset ) );
+	if( nullptr == raw ) return nullptr;
+
+	auto	memory		= raw + offset;
+	auto	header		= GetBlockHeader( memory );
+	header->size_class			= LARGE_BLOCK;
+	header->alignment_offset	= uint32_t( offset );
+	return memory;
+}
+
+void MemoryPool::FreeLarge( void * ptr )
+{
+	auto header			= GetBlockHeader( ptr );
+	_aligned_free( reinterpret_cast<uint8_t*>( ptr ) - header->alignment_offset );
+}
+
+uint32_t MemoryPool::TakeBlocksFromSizeClass( uint32_t size_class_index, uint32_t count, FreeBlock ** return_list )
+{
+	auto & size_class	= size_classes[ size_class_index ];
+	LOCK_GUARD( size_class.mutex );
+
+	if( nullptr == size_class.free_list ) {
+		// carve a new slab into blocks, first block alignment worth of bytes is used for the slab link
+		auto slab		= reinterpret_cast<uint8_t*>( _aligned_malloc( BUILD_MEMORY_POOL_SLAB_SIZE, BLOCK_ALIGNMENT ) );
+		if( nullptr == slab ) return 0;
+		reinterpret_cast<Slab*>( slab )->next	= size_class.slab_list;
+		size_class.slab_list					= reinterpret_cast<Slab*>( slab );
+
+		size_t	stride			= size_class.block_size + sizeof( BlockHeader );
+		size_t	block_count		= ( BUILD_MEMORY_POOL_SLAB_SIZE - BLOCK_ALIGNMENT ) / stride;
+		// push in reverse so that blocks are handed out in address order
+		for( size_t i=block_count; i > 0; --i ) {
+			auto block_start			= slab + BLOCK_ALIGNMENT + ( i - 1 ) * stride;
+			auto header					= reinterpret_cast<BlockHeader*>( block_start );
+			header->size_class			= size_class_index;
+			header->alignment_offset	= 0;
+			header->size				= 0;
+			header->tag					= 0;
+			auto block					= reinterpret_cast<FreeBlock*>( block_start + sizeof( BlockHeader ) );
+			block->next					= size_class.free_list;
+			size_class.free_list		= block;
+		}
+	}
+
+	uint32_t	taken	= 0;
+	FreeBlock *	list	= *return_list;
+	while( taken < count && nullptr != size_class.free_list ) {
+		auto block				= size_class.free_list;
+		size_class.free_list	= block->next;
+		block->next				= list;
+		list					= block;
+		++taken;
+	}
+	*return_list		= list;
+	return taken;
+}
+
+void MemoryPool::ReturnBlocksToSizeClass( uint32_t size_class_index, FreeBlock * first, FreeBlock * last )
+{
+	auto & size_class	= size_classes[ size_class_index ];
+	LOCK_GUARD( size_class.mutex );
+	last->next				= size_class.free_list;
+	size_class.free_list	= first;
+}
+
 std::unique_ptr<MemoryPool>		memory_pool( new MemoryPool );
 
 void * MemoryPool_AllocateRaw( size_t size, size_t alignment )
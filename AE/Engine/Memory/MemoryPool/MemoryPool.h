@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <mutex>
+#include <atomic>
 
 #include "../../BUILD_OPTIONS.h"
 #include "../../Platform.h"
@@ -14,8 +15,19 @@ namespace AE
 namespace engine_internal
 {
 
+struct MemoryPoolThreadCache;
+
+// Segregated size class memory pool
+// Small allocations are rounded up to the nearest size class and served from slabs,
+// every thread keeps a small cache of free blocks per size class so most allocations
+// and frees never touch a mutex. When a thread cache runs empty or overflows, a batch of
+// blocks is moved between the thread cache and the size class free list at once.
+// Allocations bigger than the largest size class, or with an alignment requirement bigger
+// than the block alignment, are passed directly to the system allocator.
 class MemoryPool
 {
+	friend struct MemoryPoolThreadCache;
+
 public:
 	MemoryPool();
 	~MemoryPool();
@@ -37,10 +49,49 @@ public:
 		FreeRaw( ptr );
 	}
 
+	// Block alignment of all small allocations, also the size of the block header
+	static constexpr size_t		BLOCK_ALIGNMENT				= 16;
+	// Biggest allocation served from the size classes
+	static constexpr size_t		MAX_SMALL_BLOCK_SIZE		= 2048;
+	// Amount of size classes, see size_class_block_sizes in MemoryPool.cpp
+	static constexpr uint32_t	SIZE_CLASS_COUNT			= 24;
+	// Size class index that marks a block allocated directly from the system
+	static constexpr uint32_t	LARGE_BLOCK					= UINT32_MAX;
+
 private:
-	std::mutex			mutex_general;
+	struct FreeBlock
+	{
+		FreeBlock			*	next;
+	};
 
-	int64_t				allocation_counter			= 0;
+	struct Slab
+	{
+		Slab				*	next;
+	};
+
+	struct SizeClass
+	{
+		Mutex					mutex;
+		FreeBlock			*	free_list					= nullptr;
+		Slab				*	slab_list					= nullptr;
+		size_t					block_size					= 0;		// usable bytes of a block, header not included
+	};
+
+	void					*	AllocateSmall( uint32_t size_class_index );
+	void						FreeSmall( uint32_t size_class_index, void * ptr );
+	void					*	AllocateLarge( size_t size, size_t alignment );
+	void						FreeLarge( void * ptr );
+
+	// Moves up to "count" free blocks from the size class into "return_list", allocates a new slab if needed
+	// returns the amount of blocks moved
+	uint32_t					TakeBlocksFromSizeClass( uint32_t size_class_index, uint32_t count, FreeBlock ** return_list );
+	// Returns a linked list of free blocks back to the size class
+	void						ReturnBlocksToSizeClass( uint32_t size_class_index, FreeBlock * first, FreeBlock * last );
+
+	Array<SizeClass, SIZE_CLASS_COUNT>							size_classes;
+	Array<uint8_t, MAX_SMALL_BLOCK_SIZE / BLOCK_ALIGNMENT + 1>	size_class_lookup;
+
+	std::atomic<int64_t>		allocation_counter;
 };
 
 extern std::unique_ptr<MemoryPool>		memory_pool;
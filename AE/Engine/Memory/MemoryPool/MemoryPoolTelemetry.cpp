@@ -0,0 +1,186 @@
+
+#include <algorithm>
+#include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+
+#include "MemoryPoolTelemetry.h"
+
+namespace AE
+{
+
+namespace engine_internal
+{
+
+// All telemetry data is zero initialized static data so that it can be
+// used by allocations made before or after any dynamic initialization
+struct MemoryTagStatistics
+{
+	std::atomic<int64_t>		live_bytes;
+	std::atomic<int64_t>		peak_bytes;
+	std::atomic<int64_t>		live_count;
+	std::atomic<uint64_t>		allocation_count;
+	std::atomic<uint64_t>		allocated_bytes;
+	std::atomic<uint64_t>		histogram[ MEMORY_TELEMETRY_HISTOGRAM_BUCKET_COUNT ];
+
+	// values at the time of the previous report, used to calculate the allocation rate
+	uint64_t					reported_allocation_count;
+	uint64_t					reported_allocated_bytes;
+};
+
+std::atomic<const char*>		memory_tag_names[ MEMORY_TAG_MAX_COUNT ];
+std::atomic<uint32_t>			memory_tag_count;
+Mutex							memory_tag_mutex;
+
+MemoryTagStatistics				memory_tag_statistics[ MEMORY_TAG_MAX_COUNT ];
+
+Mutex							memory_telemetry_report_mutex;
+std::chrono::steady_clock::time_point	memory_telemetry_report_time;
+bool							memory_telemetry_report_time_set;
+
+thread_local uint16_t			current_memory_tag;
+
+uint32_t GetHistogramBucket( size_t size )
+{
+	uint32_t bucket		= 0;
+	while( size > 1 && bucket < MEMORY_TELEMETRY_HISTOGRAM_BUCKET_COUNT - 1 ) {
+		size			= ( size + 1 ) >> 1;
+		++bucket;
+	}
+	return bucket;
+}
+
+uint16_t MemoryPool_RegisterTag( const char * name )
+{
+	assert( nullptr != name );
+	LOCK_GUARD( memory_tag_mutex );
+	uint32_t count		= memory_tag_count;
+	// tag 0 is always the untagged allocations
+	for( uint32_t i=1; i < count; ++i ) {
+		if( std::strcmp( memory_tag_names[ i ], name ) == 0 ) {
+			return uint16_t( i );
+		}
+	}
+	if( 0 == count ) count = 1;
+	assert( count < MEMORY_TAG_MAX_COUNT && "Too many memory tags, increase MEMORY_TAG_MAX_COUNT" );
+	if( count >= MEMORY_TAG_MAX_COUNT ) return 0;
+
+	memory_tag_names[ count ]	= name;
+	memory_tag_count			= count + 1;
+	return uint16_t( count );
+}
+
+uint16_t MemoryPool_GetCurrentTag()
+{
+	return current_memory_tag;
+}
+
+MemoryTagScope::MemoryTagScope( uint16_t tag )
+{
+	previous_tag		= current_memory_tag;
+	current_memory_tag	= tag;
+}
+
+MemoryTagScope::~MemoryTagScope()
+{
+	current_memory_tag	= previous_tag;
+}
+
+void MemoryPool_RecordAllocation( uint16_t tag, size_t size )
+{
+	assert( tag < MEMORY_TAG_MAX_COUNT );
+	auto & s			= memory_tag_statistics[ tag ];
+	auto live			= s.live_bytes.fetch_add( int64_t( size ) ) + int64_t( size );
+	auto peak			= s.peak_bytes.load();
+	while( live > peak && !s.peak_bytes.compare_exchange_weak( peak, live ) );
+	++s.live_count;
+	++s.allocation_count;
+	s.allocated_bytes	+= size;
+	++s.histogram[ GetHistogramBucket( size ) ];
+}
+
+void MemoryPool_RecordFree( uint16_t tag, size_t size )
+{
+	assert( tag < MEMORY_TAG_MAX_COUNT );
+	auto & s			= memory_tag_statistics[ tag ];
+	s.live_bytes		-= int64_t( size );
+	--s.live_count;
+}
+
+void MemoryPool_WriteTelemetryReport( std::ostream & stream )
+{
+#if BUILD_MEMORY_POOL_TELEMETRY
+	LOCK_GUARD( memory_telemetry_report_mutex );
+
+	// rates need a previous report to measure from, the first report leaves the rate columns out
+	auto	now				= std::chrono::steady_clock::now();
+	bool	has_rates		= memory_telemetry_report_time_set;
+	double	seconds			= 0.0;
+	if( has_rates ) {
+		seconds				= std::max( std::chrono::duration<double>( now - memory_telemetry_report_time ).count(), 0.001 );
+	}
+	memory_telemetry_report_time		= now;
+	memory_telemetry_report_time_set	= true;
+
+	stream << "Memory pool report";
+	if( has_rates ) {
+		stream << ", allocation rate over the last " << std::fixed << std::setprecision( 3 ) << seconds << " seconds";
+	}
+	stream << "\n";
+	stream << std::left << std::setw( 32 ) << "Tag"
+		<< std::right
+		<< std::setw( 16 ) << "Live bytes"
+		<< std::setw( 12 ) << "Live count"
+		<< std::setw( 16 ) << "Peak bytes"
+		<< std::setw( 14 ) << "Allocations";
+	if( has_rates ) {
+		stream << std::setw( 14 ) << "Allocs/s"
+			<< std::setw( 16 ) << "Bytes/s";
+	}
+	stream << "\n";
+
+	uint32_t count			= std::max( memory_tag_count.load(), 1U );
+	for( uint32_t i=0; i < count; ++i ) {
+		auto & s					= memory_tag_statistics[ i ];
+		uint64_t allocation_count	= s.allocation_count;
+		uint64_t allocated_bytes	= s.allocated_bytes;
+		if( 0 == allocation_count ) continue;
+
+		const char * name			= ( 0 == i ) ? "Untagged" : memory_tag_names[ i ].load();
+		stream << std::left << std::setw( 32 ) << name
+			<< std::right
+			<< std::setw( 16 ) << s.live_bytes.load()
+			<< std::setw( 12 ) << s.live_count.load()
+			<< std::setw( 16 ) << s.peak_bytes.load()
+			<< std::setw( 14 ) << allocation_count;
+		if( has_rates ) {
+			double allocation_rate	= double( allocation_count - s.reported_allocation_count ) / seconds;
+			double byte_rate		= double( allocated_bytes - s.reported_allocated_bytes ) / seconds;
+			stream << std::setw( 14 ) << std::fixed << std::setprecision( 1 ) << allocation_rate
+				<< std::setw( 16 ) << std::fixed << std::setprecision( 1 ) << byte_rate;
+		}
+		stream << "\n";
+		s.reported_allocation_count	= allocation_count;
+		s.reported_allocated_bytes	= allocated_bytes;
+
+		// size histogram, only non empty buckets are listed
+		stream << "    sizes:";
+		for( uint32_t b=0; b < MEMORY_TELEMETRY_HISTOGRAM_BUCKET_COUNT; ++b ) {
+			uint64_t bucket_count	= s.histogram[ b ];
+			if( 0 == bucket_count ) continue;
+			stream << ( b == MEMORY_TELEMETRY_HISTOGRAM_BUCKET_COUNT - 1 ? " >" : " <=" ) << ( uint64_t( 1 ) << ( b == MEMORY_TELEMETRY_HISTOGRAM_BUCKET_COUNT - 1 ? b - 1 : b ) )
+				<< ":" << bucket_count;
+		}
+		stream << "\n";
+	}
+	stream.flush();
+#else
+	stream << "Memory pool telemetry is disabled, enable BUILD_MEMORY_POOL_TELEMETRY in BUILD_OPTIONS.h\n";
+#endif
+}
+
+}
+
+}
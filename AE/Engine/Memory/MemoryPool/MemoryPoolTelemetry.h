@@ -0,0 +1,63 @@
+#pragma once
+
+#include <ostream>
+
+#include "../../BUILD_OPTIONS.h"
+#include "../../Platform.h"
+
+namespace AE
+{
+
+namespace engine_internal
+{
+
+// Maximum amount of different memory tags, tag 0 is reserved for untagged allocations
+constexpr uint32_t			MEMORY_TAG_MAX_COUNT						= 64;
+// Allocation sizes are collected in power of two buckets, last bucket holds everything bigger
+constexpr uint32_t			MEMORY_TELEMETRY_HISTOGRAM_BUCKET_COUNT		= 24;
+
+// Registers a new memory tag or returns the existing tag with the same name,
+// name must point to a string with static storage duration, eg. a string literal
+uint16_t					MemoryPool_RegisterTag( const char * name );
+
+// Tag that new allocations from this thread are recorded under
+uint16_t					MemoryPool_GetCurrentTag();
+
+// Sets the memory tag for all allocations made by this thread while this object is alive
+class MemoryTagScope
+{
+public:
+	MemoryTagScope( uint16_t tag );
+	~MemoryTagScope();
+
+	MemoryTagScope( const MemoryTagScope & other )				= delete;
+	MemoryTagScope & operator=( const MemoryTagScope & other )	= delete;
+
+private:
+	uint16_t				previous_tag;
+};
+
+// Records allocations under a tag, called by the memory pool itself and for allocations
+// that are made outside of the memory pool but should still show up in the report
+void						MemoryPool_RecordAllocation( uint16_t tag, size_t size );
+void						MemoryPool_RecordFree( uint16_t tag, size_t size );
+
+// Writes live bytes, peak bytes, allocation rate and size histogram of every tag,
+// allocation rate is measured from the previous report so the first report has no rate columns
+void						MemoryPool_WriteTelemetryReport( std::ostream & stream );
+
+}
+
+}
+
+#define MEMORY_TAG_LINE_HELPER_COMBINE( str, line ) str##line
+#define MEMORY_TAG_LINE_HELPER( str, line ) MEMORY_TAG_LINE_HELPER_COMBINE( str, line )
+
+#if BUILD_MEMORY_POOL_TELEMETRY
+// Records all memory pool allocations made by this thread within the current scope under a named tag
+#define MEMORY_TAG( name )																											\
+	static const uint16_t MEMORY_TAG_LINE_HELPER( MEMORY_TAG_macro_id_at_line_, __LINE__ )	= ::AE::engine_internal::MemoryPool_RegisterTag( name );	\
+	::AE::engine_internal::MemoryTagScope MEMORY_TAG_LINE_HELPER( MEMORY_TAG_macro_object_at_line_, __LINE__ )( MEMORY_TAG_LINE_HELPER( MEMORY_TAG_macro_id_at_line_, __LINE__ ) )
+#else
+#define MEMORY_TAG( name )
+#endif
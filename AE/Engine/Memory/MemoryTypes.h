@@ -10,6 +10,8 @@
 #include <list>
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <atomic>
 #include <filesystem>
 #include <glm/glm.hpp>
 
@@ -120,6 +122,81 @@ bool operator!= ( const MemoryAllocator<T1>&,
 }
 
 
+void		MemoryPool_FreeRaw( void * ptr );
+
+void	*	FrameArena_AllocateRaw( size_t size, size_t alignment );
+void		FrameArena_FreeRaw( void * ptr, size_t size );
+
+// Allocator for transient containers that only live for the duration of a single frame,
+// memory comes from the frame arena and is released all at once when the next frame starts
+template<typename T>
+class FrameAllocator
+{
+public:
+	// type definitions
+	typedef T				value_type;
+	typedef T*				pointer;
+	typedef const T*		const_pointer;
+	typedef T&				reference;
+	typedef const T&		const_reference;
+	typedef std::size_t		size_type;
+	typedef std::ptrdiff_t	difference_type;
+
+	// rebind allocator to type U
+	template <class U>
+	struct rebind
+	{
+		typedef FrameAllocator<U> other;
+	};
+
+	FrameAllocator() throw( )
+	{
+	}
+	FrameAllocator( const FrameAllocator& ) throw( )
+	{
+	}
+	template <class U>
+	FrameAllocator( const FrameAllocator<U>& ) throw( )
+	{
+	}
+	~FrameAllocator() throw( )
+	{
+	}
+
+	// return maximum number of elements that can be allocated
+	size_type max_size() const throw( )
+	{
+		return std::numeric_limits<std::size_t>::max() / sizeof( T );
+	}
+
+	// allocate but don't initialize num elements of type T
+	pointer allocate( size_type num, const void* = 0 )
+	{
+		return (pointer)( FrameArena_AllocateRaw( num * sizeof( T ), alignof( T ) ) );
+	}
+
+	// deallocate storage p of deleted elements, only the latest allocation is actually returned
+	void deallocate( pointer p, size_type num )
+	{
+		FrameArena_FreeRaw( (void*)p, num * sizeof( T ) );
+	}
+};
+
+// return that all specializations of this allocator are interchangeable
+template <class T1, class T2>
+bool operator== ( const FrameAllocator<T1>&,
+	const FrameAllocator<T2>& ) throw( )
+{
+	return true;
+}
+template <class T1, class T2>
+bool operator!= ( const FrameAllocator<T1>&,
+	const FrameAllocator<T2>& ) throw( )
+{
+	return false;
+}
+
+
 
 template<typename T>
 class UniquePointer;
@@ -132,15 +209,18 @@ void UniquePointerDeleter( void * ptr )
 {
 	MemoryPool_Free( static_cast<T*>( ptr ) );
 };
+// Shared objects live in the same allocation as their SharedPointerData,
+// object deleter only destroys the object and the data deleter frees the memory
 template<typename T>
 void SharedPointerDeleter( void * ptr )
 {
-	MemoryPool_Free( static_cast<T*>( ptr ) );
+	static_cast<T*>( ptr )->~T();
 };
 template<typename T>
 void SharedPointerDataDeleter( void * ptr )
 {
-	MemoryPool_Free( static_cast<T*>( ptr ) );
+	static_cast<T*>( ptr )->~T();
+	MemoryPool_FreeRaw( ptr );
 };
 
 using UniquePointerDeleterFunction = void( *)( void* );
@@ -267,16 +347,33 @@ public:
 	}
 };
 
-template<typename T>
+// Reference count and deleters of a shared object
+// MakeSharedPointer() allocates this structure and the object itself in a single memory pool allocation,
+// this structure is not templated so that shared pointers of base classes can share it with derived classes
 class SharedPointerData
 {
 	template<typename TO>
 	friend class SharedPointer;
 
-	T													*	ptr					= nullptr;
+public:
+	SharedPointerData(
+		void * object_pointer,
+		engine_internal::SharedPointerDataDeleterFunction structure_deleter_function,
+		engine_internal::SharedPointerDeleterFunction deleter_function )
+	{
+		object				= object_pointer;
+		structure_deleter	= structure_deleter_function;
+		deleter				= deleter_function;
+	}
+
+	SharedPointerData( const SharedPointerData & other ) = delete;
+	SharedPointerData & operator=( const SharedPointerData & other ) = delete;
+
+private:
+	void												*	object				= nullptr;
 	engine_internal::SharedPointerDeleterFunction			deleter				= nullptr;
 	engine_internal::SharedPointerDataDeleterFunction		structure_deleter	= nullptr;
-	int64_t													counter				= 0;
+	std::atomic<int64_t>									counter				{ 0 };
 };
 
 // SharedPointer, USE MakeSharedPointer() FUNCTION TO CREATE THIS OBJECT
@@ -284,96 +381,84 @@ class SharedPointerData
 template<typename T>
 class SharedPointer
 {
+	template<typename TO>
 	friend class SharedPointer;
 
 private:
-	SharedPointerData<T>								*	data			= nullptr;;
+	SharedPointerData									*	data			= nullptr;
+	T													*	ptr				= nullptr;
 
 public:
 	void DecRef()
 	{
 		if( nullptr != data ) {
-			data->counter--;
-			if( data->counter < 0 )	data->counter = 0;
-			if( data->counter <= 0 ) {
-				if( nullptr != data->ptr ) {
+			// last reference destroys the object, acquire makes sure all writes from
+			// other threads that released their references are visible to the deleter
+			auto previous_count		= data->counter.fetch_sub( 1, std::memory_order_acq_rel );
+			assert( previous_count > 0 );
+			if( previous_count == 1 ) {
+				if( nullptr != data->object ) {
 					assert( nullptr != data->deleter );
-					data->deleter( data->ptr );
+					data->deleter( data->object );
 				}
+				// structure deleter frees the memory of both the structure and the object
 				data->structure_deleter( data );
-				data = nullptr;
 			}
+			data	= nullptr;
+			ptr		= nullptr;
 		}
 	}
 	void IncRef()
 	{
-		data->counter++;
+		// new references are always made from an existing one so no ordering is needed
+		data->counter.fetch_add( 1, std::memory_order_relaxed );
 	}
 
 	SharedPointer() {}
 
-	SharedPointer( nullptr_t )
-	{
-		DecRef();
-	}
+	SharedPointer( nullptr_t ) {}
 
 	// Do not construct from unique pointers
 	template<typename Any>
 	SharedPointer( UniquePointer<Any> ) = delete;
 
-	SharedPointer(
-		SharedPointerData<T> * structure_pointer,
-		T * data_pointer,
-		engine_internal::SharedPointerDataDeleterFunction structure_deleter_function,
-		engine_internal::SharedPointerDeleterFunction deleter_function )
+	SharedPointer( SharedPointerData * structure_pointer, T * data_pointer )
 	{
-		DecRef();
+		assert( nullptr != structure_pointer );
 		data					= structure_pointer;
-		data->ptr				= data_pointer;
-		data->deleter			= deleter_function;
-		data->structure_deleter	= structure_deleter_function;
+		ptr						= data_pointer;
 		IncRef();
 	}
 	// this function is purely to fix any errors with objects that assign 0 as a value to this object
 	SharedPointer( uint64_t na )
 	{
 		assert( na == 0 );
-		DecRef();
 	}
 
 	SharedPointer( SharedPointer<T> && other )
 	{
-		if( *this != other ) {
-			std::swap( data, other.data );
-		}
+		std::swap( data,	other.data );
+		std::swap( ptr,		other.ptr );
 	}
 	SharedPointer( const SharedPointer<T> & other )
 	{
-		if( *this != other ) {
-			DecRef();
-			data	= other.data;
-			IncRef();
-		}
+		Assign( other.data, other.ptr );
 	}
 
 	template<typename TO>
 	SharedPointer( SharedPointer<TO> && other )
 	{
-		// We want to assign child objects to base class shared pointers, we can't swap so treat this like normal reference
-		if( *this != other ) {
-			DecRef();
-			data	= other.data;
-			IncRef();
-		}
+		// child objects can be assigned to base class shared pointers, pointer is converted
+		// to the base class while the reference counting structure is shared as is
+		data			= other.data;
+		ptr				= other.ptr;
+		other.data		= nullptr;
+		other.ptr		= nullptr;
 	}
 	template<typename TO>
 	SharedPointer( const SharedPointer<TO> & other )
 	{
-		if( *this != other ) {
-			DecRef();
-			data	= other.data;
-			IncRef();
-		}
+		Assign( other.data, other.ptr );
 	}
 
 	~SharedPointer()
@@ -398,114 +483,235 @@ public:
 	}
 	void operator=( SharedPointer<T> && other )
 	{
-		if( *this != other ) {
-			std::swap( data, other.data );
-		}
+		std::swap( data,	other.data );
+		std::swap( ptr,		other.ptr );
 	}
 	void operator=( const SharedPointer<T> & other )
 	{
-		if( *this != other ) {
-			DecRef();
-			data	= other.data;
-			IncRef();
-		}
+		Assign( other.data, other.ptr );
 	}
 
 	template<typename TO>
 	void operator=( SharedPointer<TO> && other )
 	{
-		// We want to assign child objects to base class shared pointers, we can't swap so treat this like normal reference
-		if( *this != other ) {
+		if( data != other.data ) {
 			DecRef();
-			data	= other.data;
-			IncRef();
+			data		= other.data;
+			ptr			= other.ptr;
+			other.data	= nullptr;
+			other.ptr	= nullptr;
 		}
 	}
 	template<typename TO>
 	void operator=( const SharedPointer<TO> & other )
 	{
-		if( *this != other ) {
+		Assign( other.data, other.ptr );
+	}
+
+	template<typename TO>
+	bool operator==( const SharedPointer<TO> & other ) const
+	{
+		return ( Get() == other.Get() );
+	}
+	template<typename TO>
+	bool operator!=( const SharedPointer<TO> & other ) const
+	{
+		return !( *this == other );
+	}
+
+	T * operator->() const
+	{
+		assert( nullptr != ptr );
+		return ptr;
+	}
+	typename std::add_lvalue_reference<T>::type operator*() const
+	{
+		assert( nullptr != ptr );
+		return *ptr;
+	}
+
+	operator bool() const
+	{
+		return ( nullptr != ptr );
+	}
+
+	T * Get() const
+	{
+		return ptr;
+	}
+
+private:
+	template<typename TO>
+	void Assign( SharedPointerData * other_data, TO * other_ptr )
+	{
+		if( data != other_data ) {
+			// take the new reference first in case the old one is the last one holding the new object
+			if( nullptr != other_data ) {
+				other_data->counter.fetch_add( 1, std::memory_order_relaxed );
+			}
 			DecRef();
-			data	= other.data;
-			IncRef();
+			data		= other_data;
+			ptr			= other_ptr;
 		}
 	}
+};
+
+// Base class for objects that keep their own reference count, use with IntrusivePointer
+// Unlike SharedPointer there is no separate reference count allocation, the count is
+// stored inside the object itself. USE MakeIntrusivePointer() FUNCTION TO CREATE THESE OBJECTS
+class IntrusiveReferenceCount
+{
+	template<typename T>
+	friend class IntrusivePointer;
+
+public:
+	IntrusiveReferenceCount() {}
+	virtual ~IntrusiveReferenceCount() {}
 
-	bool operator==( const SharedPointer<T> & other )
+	IntrusiveReferenceCount( const IntrusiveReferenceCount & other ) = delete;
+	IntrusiveReferenceCount & operator=( const IntrusiveReferenceCount & other ) = delete;
+
+	uint32_t GetReferenceCount() const
 	{
-		if( nullptr != data && nullptr != other.data ) {
-			return ( data->ptr == other.data->ptr );
-		}
-		return ( nullptr == data && nullptr == other.data );
+		return reference_count.load( std::memory_order_acquire );
 	}
-	bool operator==( const SharedPointer<T> && other )
+
+private:
+	void IncRef()
 	{
-		if( nullptr != data && nullptr != other.data ) {
-			return ( data->ptr == other.data->ptr );
+		reference_count.fetch_add( 1, std::memory_order_relaxed );
+	}
+	void DecRef()
+	{
+		auto previous_count		= reference_count.fetch_sub( 1, std::memory_order_acq_rel );
+		assert( previous_count > 0 );
+		if( previous_count == 1 ) {
+			// memory pool needs the address of the whole object, not the address of this base class
+			void * memory		= dynamic_cast<void*>( this );
+			this->~IntrusiveReferenceCount();
+			engine_internal::MemoryPool_FreeRaw( memory );
 		}
-		return ( nullptr == data && nullptr == other.data );
 	}
+
+	std::atomic<uint32_t>		reference_count		{ 0 };
+};
+
+// IntrusivePointer, USE MakeIntrusivePointer() FUNCTION TO CREATE THIS OBJECT
+template<typename T>
+class IntrusivePointer
+{
 	template<typename TO>
-	bool operator==( const SharedPointer<TO> & other )
+	friend class IntrusivePointer;
+
+private:
+	T													*	ptr			= nullptr;
+
+	void Reset( T * new_ptr )
 	{
-		if( nullptr != data && nullptr != other.data ) {
-			return ( data->ptr == other.data->ptr );
+		if( nullptr != new_ptr ) {
+			new_ptr->IntrusiveReferenceCount::IncRef();
+		}
+		T * old_ptr		= ptr;
+		ptr				= new_ptr;
+		if( nullptr != old_ptr ) {
+			old_ptr->IntrusiveReferenceCount::DecRef();
 		}
-		return ( nullptr == data && nullptr == other.data );
 	}
+
+public:
+	IntrusivePointer() {}
+
+	IntrusivePointer( nullptr_t ) {}
+
+	explicit IntrusivePointer( T * pointer )
+	{
+		static_assert( std::is_base_of<IntrusiveReferenceCount, T>::value, "Not base of IntrusiveReferenceCount" );
+		Reset( pointer );
+	}
+
+	IntrusivePointer( const IntrusivePointer<T> & other )
+	{
+		Reset( other.ptr );
+	}
+	IntrusivePointer( IntrusivePointer<T> && other )
+	{
+		std::swap( ptr, other.ptr );
+	}
+
 	template<typename TO>
-	bool operator==( const SharedPointer<TO> && other )
+	IntrusivePointer( const IntrusivePointer<TO> & other )
 	{
-		if( nullptr != data && nullptr != other.data ) {
-			return ( data->ptr == other.data->ptr );
-		}
-		return ( nullptr == data && nullptr == other.data );
+		Reset( other.ptr );
+	}
+	template<typename TO>
+	IntrusivePointer( IntrusivePointer<TO> && other )
+	{
+		ptr				= other.ptr;
+		other.ptr		= nullptr;
 	}
 
-	bool operator!=( const SharedPointer<T> & other )
+	~IntrusivePointer()
 	{
-		return !( *this == other );
+		Reset( nullptr );
 	}
-	bool operator!=( const SharedPointer<T> && other )
+
+	void operator=( nullptr_t )
 	{
-		return !( *this == other );
+		Reset( nullptr );
+	}
+	void operator=( const IntrusivePointer<T> & other )
+	{
+		Reset( other.ptr );
+	}
+	void operator=( IntrusivePointer<T> && other )
+	{
+		std::swap( ptr, other.ptr );
 	}
 	template<typename TO>
-	bool operator!=( const SharedPointer<TO> & other )
+	void operator=( const IntrusivePointer<TO> & other )
 	{
-		return !( *this == other );
+		Reset( other.ptr );
 	}
 	template<typename TO>
-	bool operator!=( const SharedPointer<TO> && other )
+	void operator=( IntrusivePointer<TO> && other )
 	{
-		return !( *this == other );
+		if( ptr != other.ptr ) {
+			Reset( nullptr );
+			ptr			= other.ptr;
+			other.ptr	= nullptr;
+		}
 	}
 
-	T *& operator->()
+	template<typename TO>
+	bool operator==( const IntrusivePointer<TO> & other ) const
 	{
-		assert( nullptr != data );
-		return data->ptr;
+		return ( ptr == other.ptr );
+	}
+	template<typename TO>
+	bool operator!=( const IntrusivePointer<TO> & other ) const
+	{
+		return ( ptr != other.ptr );
+	}
+
+	T * operator->() const
+	{
+		assert( nullptr != ptr );
+		return ptr;
 	}
 	typename std::add_lvalue_reference<T>::type operator*() const
 	{
-		assert( nullptr != data );
-		return *data->ptr;
+		assert( nullptr != ptr );
+		return *ptr;
 	}
 
 	operator bool() const
 	{
-		if( nullptr != data ) {
-			return ( nullptr != data->ptr );
-		}
-		return false;
+		return ( nullptr != ptr );
 	}
 
 	T * Get() const
 	{
-		if( nullptr != data ) {
-			return data->ptr;
-		}
-		return nullptr;
+		return ptr;
 	}
 };
 
@@ -529,6 +735,53 @@ using Pair				= std::pair<T1, T2>;
 template<typename T1, typename T2>
 using Map				= std::map<T1, T2, std::less<T1>, engine_internal::MemoryAllocator<Pair<T1, T2>>>;
 
+template<typename T1, typename T2, typename Hash = std::hash<T1>>
+using UnorderedMap		= std::unordered_map<T1, T2, Hash, std::equal_to<T1>, engine_internal::MemoryAllocator<Pair<const T1, T2>>>;
+
+template<typename T1, typename T2, typename Hash = std::hash<T1>>
+using UnorderedMultiMap	= std::unordered_multimap<T1, T2, Hash, std::equal_to<T1>, engine_internal::MemoryAllocator<Pair<const T1, T2>>>;
+
+// Frame containers, contents are only valid until the end of the current frame, see FrameArena
+template<typename T>
+using FrameVector		= std::vector<T, engine_internal::FrameAllocator<T>>;
+
+using FrameString		= std::basic_string<char, std::char_traits<char>, engine_internal::FrameAllocator<char>>;
+
+// Non owning view over a contiguous array of elements, whoever gives out
+// the view is responsible for keeping the memory alive while it's in use
+template<typename T>
+class ArrayView
+{
+public:
+	ArrayView() {}
+	ArrayView( T * data_pointer, size_t element_count )
+	{
+		ptr			= data_pointer;
+		count		= element_count;
+	}
+	template<typename Container>
+	ArrayView( Container & container )
+	{
+		ptr			= container.data();
+		count		= container.size();
+	}
+
+	T			*	data() const							{ return ptr; }
+	size_t			size() const							{ return count; }
+	bool			empty() const							{ return 0 == count; }
+	T			*	begin() const							{ return ptr; }
+	T			*	end() const								{ return ptr + count; }
+	T			&	operator[]( size_t index ) const
+	{
+		assert( index < count );
+		return ptr[ index ];
+	}
+
+private:
+	T			*	ptr										= nullptr;
+	size_t			count									= 0;
+};
+
 using GridCoords2D		= glm::tvec2<int32_t, glm::highp>;
 
 template<typename T>
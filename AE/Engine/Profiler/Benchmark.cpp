@@ -0,0 +1,267 @@
+
+#include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Benchmark.h"
+
+#include "../Engine.h"
+#include "../Memory/Memory.h"
+#include "../Threading/Threading.h"
+#include "../FileResource/FileResourceManager.h"
+#include "../FileResource/Mesh/MeshDecode.h"
+
+namespace AE
+{
+
+namespace engine_internal
+{
+
+constexpr uint32_t			BENCHMARK_THREAD_COUNTS[]				= { 1, 2, 4, 8 };
+
+constexpr uint32_t			BENCHMARK_MEMORY_POOL_OPERATIONS		= 2000000;		// allocate and free pairs per thread
+constexpr uint32_t			BENCHMARK_MEMORY_POOL_LIVE_BLOCKS		= 64;			// blocks each thread keeps allocated at a time
+constexpr size_t			BENCHMARK_MEMORY_POOL_MAX_SIZE			= 512;
+
+constexpr uint32_t			BENCHMARK_RESOURCE_HANDLE_COPIES		= 2000000;		// copies per thread
+
+constexpr uint32_t			BENCHMARK_MESH_DECODE_VERTICES			= 4000000;
+constexpr uint32_t			BENCHMARK_MESH_DECODE_RUNS				= 5;			// best run is reported
+
+// xorshift, benchmarks only need a cheap repeatable sequence per thread
+uint32_t Benchmark_Random( uint32_t & state )
+{
+	state			^= state << 13;
+	state			^= state >> 17;
+	state			^= state << 5;
+	return state;
+}
+
+// starts all threads, releases them at the same time and returns the seconds until the last one finished
+double Benchmark_RunThreads( uint32_t thread_count, const std::function<void( uint32_t thread_index )> & function )
+{
+	std::atomic<uint32_t>		threads_ready		{ 0 };
+	std::atomic_bool			start				{ false };
+	std::vector<std::thread>	threads;
+	threads.reserve( thread_count );
+	for( uint32_t i=0; i < thread_count; ++i ) {
+		threads.emplace_back( [ &threads_ready, &start, &function, i ]() {
+			++threads_ready;
+			while( !start ) {
+				std::this_thread::yield();
+			}
+			function( i );
+		} );
+	}
+	while( threads_ready != thread_count ) {
+		std::this_thread::yield();
+	}
+	auto start_time		= std::chrono::steady_clock::now();
+	start				= true;
+	for( auto & t : threads ) {
+		t.join();
+	}
+	return std::chrono::duration<double>( std::chrono::steady_clock::now() - start_time ).count();
+}
+
+// allocate and free pairs per second of all threads combined
+template<typename AllocateFunction, typename FreeFunction>
+double Benchmark_MemoryPool_Run( uint32_t thread_count, AllocateFunction allocate, FreeFunction free_block )
+{
+	auto seconds		= Benchmark_RunThreads( thread_count, [ &allocate, &free_block ]( uint32_t thread_index ) {
+		uint32_t random_state	= 0x9E3779B9u * ( thread_index + 1 );
+		void * live_blocks[ BENCHMARK_MEMORY_POOL_LIVE_BLOCKS ] {};
+		for( uint32_t i=0; i < BENCHMARK_MEMORY_POOL_OPERATIONS; ++i ) {
+			auto random		= Benchmark_Random( random_state );
+			auto & block	= live_blocks[ random % BENCHMARK_MEMORY_POOL_LIVE_BLOCKS ];
+			free_block( block );
+			block			= allocate( 8 + ( random >> 8 ) % ( BENCHMARK_MEMORY_POOL_MAX_SIZE - 8 ) );
+			// touch the block so that the allocation isn't optimized away
+			*reinterpret_cast<uint8_t*>( block )	= uint8_t( i );
+		}
+		for( auto b : live_blocks ) {
+			free_block( b );
+		}
+	} );
+	return double( BENCHMARK_MEMORY_POOL_OPERATIONS ) * thread_count / seconds;
+}
+
+// object with the reference count inside it, holds the same value as the SharedPointer target
+class Benchmark_IntrusiveObject : public IntrusiveReferenceCount
+{
+public:
+	uint64_t			value			= 0;
+};
+
+// copies of a handle per second of all threads combined, make_copy copies the handle and drops the copy
+template<typename CopyFunction>
+double Benchmark_ResourceHandles_Run( uint32_t thread_count, CopyFunction make_copy )
+{
+	auto seconds		= Benchmark_RunThreads( thread_count, [ &make_copy ]( uint32_t thread_index ) {
+		for( uint32_t i=0; i < BENCHMARK_RESOURCE_HANDLE_COPIES; ++i ) {
+			make_copy();
+		}
+	} );
+	return double( BENCHMARK_RESOURCE_HANDLE_COPIES ) * thread_count / seconds;
+}
+
+// seconds of the fastest of the runs, the first run also pages in the destination
+template<typename DecodeFunction>
+double Benchmark_MeshDecode_Run( DecodeFunction decode )
+{
+	double best			= 0.0;
+	for( uint32_t i=0; i < BENCHMARK_MESH_DECODE_RUNS; ++i ) {
+		auto seconds	= Benchmark_RunThreads( 1, [ &decode ]( uint32_t thread_index ) {
+			decode();
+		} );
+		if( i == 0 || seconds < best ) {
+			best		= seconds;
+		}
+	}
+	return best;
+}
+
+}
+
+void Benchmark_MemoryPool( std::ostream & stream )
+{
+	stream << "Memory pool, " << engine_internal::BENCHMARK_MEMORY_POOL_OPERATIONS << " allocate and free pairs per thread, sizes 8 - "
+		<< engine_internal::BENCHMARK_MEMORY_POOL_MAX_SIZE << " bytes, " << engine_internal::BENCHMARK_MEMORY_POOL_LIVE_BLOCKS << " live blocks per thread\n";
+	stream << std::left << std::setw( 10 ) << "threads" << std::setw( 22 ) << "global mutex Mop/s" << std::setw( 22 ) << "memory pool Mop/s" << "speedup\n";
+
+	Mutex mutex_general;
+	for( auto thread_count : engine_internal::BENCHMARK_THREAD_COUNTS ) {
+		// the memory pool before size classes, one mutex around the system allocator
+		auto global_mutex	= engine_internal::Benchmark_MemoryPool_Run( thread_count,
+			[ &mutex_general ]( size_t size ) {
+				LOCK_GUARD( mutex_general );
+				return _aligned_malloc( size, 8 );
+			},
+			[ &mutex_general ]( void * ptr ) {
+				if( !ptr ) return;
+				LOCK_GUARD( mutex_general );
+				_aligned_free( ptr );
+			} );
+		auto memory_pool	= engine_internal::Benchmark_MemoryPool_Run( thread_count,
+			[]( size_t size ) {
+				return engine_internal::MemoryPool_AllocateRaw( size );
+			},
+			[]( void * ptr ) {
+				engine_internal::MemoryPool_FreeRaw( ptr );
+			} );
+		stream << std::left << std::fixed << std::setprecision( 2 )
+			<< std::setw( 10 ) << thread_count
+			<< std::setw( 22 ) << global_mutex / 1000000.0
+			<< std::setw( 22 ) << memory_pool / 1000000.0
+			<< memory_pool / global_mutex << "x\n";
+	}
+	stream.flush();
+}
+
+void Benchmark_ResourceHandles( Engine * engine, const Path & resource_path, std::ostream & stream )
+{
+	assert( nullptr != engine );
+	// the handle kept here holds one user for the whole benchmark, so copies never release the last user
+	auto resource		= engine->GetFileResourceManager()->RequestResource( resource_path );
+	if( !resource ) {
+		stream << "Unable to request resource: " << resource_path.string() << std::endl;
+		return;
+	}
+	auto shared			= MakeSharedPointer<uint64_t>( 0 );
+	auto intrusive		= MakeIntrusivePointer<engine_internal::Benchmark_IntrusiveObject>();
+	Mutex				mutex_count;
+	int64_t				count			= 1;
+
+	stream << "Resource handles, " << engine_internal::BENCHMARK_RESOURCE_HANDLE_COPIES << " copies per thread of the same handle\n";
+	stream << std::left << std::setw( 10 ) << "threads" << std::setw( 22 ) << "mutex count M/s" << std::setw( 22 ) << "SharedPointer M/s" << std::setw( 24 ) << "IntrusivePointer M/s" << "FileResourceHandle M/s\n";
+	for( auto thread_count : engine_internal::BENCHMARK_THREAD_COUNTS ) {
+		// resource user counts before they were atomic, increment and decrement under the resource mutex
+		auto mutex_guarded	= engine_internal::Benchmark_ResourceHandles_Run( thread_count, [ &mutex_count, &count ]() {
+			{
+				LOCK_GUARD( mutex_count );
+				++count;
+			}
+			{
+				LOCK_GUARD( mutex_count );
+				--count;
+			}
+		} );
+		auto shared_pointer	= engine_internal::Benchmark_ResourceHandles_Run( thread_count, [ &shared ]() {
+			auto copy		= shared;
+		} );
+		auto intrusive_pointer	= engine_internal::Benchmark_ResourceHandles_Run( thread_count, [ &intrusive ]() {
+			auto copy		= intrusive;
+		} );
+		auto handle			= engine_internal::Benchmark_ResourceHandles_Run( thread_count, [ &resource ]() {
+			auto copy		= resource;
+		} );
+		stream << std::left << std::fixed << std::setprecision( 2 )
+			<< std::setw( 10 ) << thread_count
+			<< std::setw( 22 ) << mutex_guarded / 1000000.0
+			<< std::setw( 22 ) << shared_pointer / 1000000.0
+			<< std::setw( 24 ) << intrusive_pointer / 1000000.0
+			<< handle / 1000000.0 << "\n";
+	}
+	assert( 1 == count );
+	stream.flush();
+}
+
+void Benchmark_MeshDecode( std::ostream & stream )
+{
+	auto vertex_count		= size_t( engine_internal::BENCHMARK_MESH_DECODE_VERTICES );
+	Vector<ME3D_Vertex>		source( vertex_count );
+	Vector<Vertex>			scalar_vertices( vertex_count );
+	uint32_t random_state	= 0x9E3779B9u;
+	for( auto & v : source ) {
+		for( auto & p : v.position ) {
+			p				= float( int32_t( engine_internal::Benchmark_Random( random_state ) % 20001 ) - 10000 ) * 0.01f;
+		}
+		for( auto & n : v.normals ) {
+			n				= int16_t( engine_internal::Benchmark_Random( random_state ) );
+		}
+		for( auto & u : v.uvs ) {
+			u				= int16_t( engine_internal::Benchmark_Random( random_state ) );
+		}
+		v.material_index	= int16_t( engine_internal::Benchmark_Random( random_state ) % 8 );
+	}
+
+	auto source_megabytes	= double( vertex_count * sizeof( ME3D_Vertex ) ) / ( 1024.0 * 1024.0 );
+	stream << "Mesh decode, " << vertex_count << " vertices, best of " << engine_internal::BENCHMARK_MESH_DECODE_RUNS << " runs\n";
+	stream << std::left << std::setw( 10 ) << "decoder" << std::setw( 14 ) << "ms" << std::setw( 18 ) << "Mvertices/s" << std::setw( 18 ) << "source MB/s" << "speedup\n";
+
+	auto scalar				= engine_internal::Benchmark_MeshDecode_Run( [ &source, &scalar_vertices, vertex_count ]() {
+		engine_internal::ME3D_DecodeVertices_Scalar( source.data(), scalar_vertices.data(), vertex_count );
+	} );
+	stream << std::left << std::fixed << std::setprecision( 2 )
+		<< std::setw( 10 ) << "scalar"
+		<< std::setw( 14 ) << scalar * 1000.0
+		<< std::setw( 18 ) << vertex_count / scalar / 1000000.0
+		<< std::setw( 18 ) << source_megabytes / scalar
+		<< "1.00x\n";
+
+#if AE_MESH_DECODE_SSE2
+	Vector<Vertex>			sse2_vertices( vertex_count );
+	auto sse2				= engine_internal::Benchmark_MeshDecode_Run( [ &source, &sse2_vertices, vertex_count ]() {
+		engine_internal::ME3D_DecodeVertices_SSE2( source.data(), sse2_vertices.data(), vertex_count );
+	} );
+	// both decoders multiply by the same scale so the results are expected to match exactly
+	bool matches			= std::memcmp( scalar_vertices.data(), sse2_vertices.data(), vertex_count * sizeof( Vertex ) ) == 0;
+	stream << std::left << std::fixed << std::setprecision( 2 )
+		<< std::setw( 10 ) << "SSE2"
+		<< std::setw( 14 ) << sse2 * 1000.0
+		<< std::setw( 18 ) << vertex_count / sse2 / 1000000.0
+		<< std::setw( 18 ) << source_megabytes / sse2
+		<< scalar / sse2 << "x\n";
+	stream << ( matches ? "SSE2 output matches the scalar output\n" : "SSE2 output DOESN'T match the scalar output\n" );
+#else
+	stream << "SSE2 decoder is not enabled for this build, see BUILD_MESH_DECODE_SIMD\n";
+#endif
+	stream.flush();
+}
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <ostream>
+
+#include "../BUILD_OPTIONS.h"
+#include "../Platform.h"
+
+#include "../CppFileSystem/CppFileSystem.h"
+
+namespace AE
+{
+
+class Engine;
+
+// Micro benchmarks of engine systems, run with "AE --benchmark <name>"
+// Every benchmark writes a table of it's results, results are only comparable
+// between runs on the same machine and build configuration
+
+// Allocates and frees small blocks of random sizes on 1, 2, 4 and 8 threads at once, memory pool
+// against a single mutex around the system allocator, which is what the memory pool used to be
+void						Benchmark_MemoryPool( std::ostream & stream );
+
+// Copies and destroys handles to the same object on 1, 2, 4 and 8 threads at once, file resource handles
+// against SharedPointer, IntrusivePointer and a mutex guarded count, which is what the resource user counts used to be
+// resource_path is requested from the file resource manager of the engine, it doesn't need to load
+void						Benchmark_ResourceHandles( Engine * engine, const Path & resource_path, std::ostream & stream );
+
+// Decodes a few million random .me3d vertices with the scalar and the SSE2 decoder on one thread,
+// the SSE2 decoder is skipped when it's not enabled for the build
+void						Benchmark_MeshDecode( std::ostream & stream );
+
+}
@@ -0,0 +1,290 @@
+
+#include <assert.h>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <vector>
+#include <string>
+
+#include "ResourceProfiler.h"
+
+#include "../Threading/Threading.h"
+#include "../Threading/JobSystem.h"
+
+namespace AE
+{
+
+namespace engine_internal
+{
+
+struct ResourceTimingStatistics
+{
+	std::atomic<uint64_t>		count;
+	std::atomic<uint64_t>		total;
+	std::atomic<uint64_t>		max;
+	std::atomic<uint64_t>		histogram[ RESOURCE_PROFILER_HISTOGRAM_BUCKET_COUNT ];
+};
+
+struct ResourceTraceEvent
+{
+	const char				*	name;
+	AssetID						asset_id;
+	uint64_t					start_time;
+	uint64_t					end_time;
+	uint32_t					thread_id;
+	uint32_t					async_id;			// 0 for spans of the calling thread
+};
+
+// Histograms are zero initialized static data, same as memory pool telemetry
+std::atomic<const char*>		resource_kind_names[ RESOURCE_PROFILER_KIND_MAX_COUNT ];
+std::atomic<uint32_t>			resource_kind_count;
+Mutex							resource_kind_mutex;
+
+ResourceTimingStatistics		resource_timing_statistics[ RESOURCE_PROFILER_KIND_MAX_COUNT ][ uint32_t( ResourceTiming::COUNT ) ];
+
+// Trace uses the standard allocator so that it doesn't depend on the lifetime of the memory pool
+Mutex							resource_trace_mutex;
+std::vector<ResourceTraceEvent>	resource_trace_events;
+std::vector<std::string>		resource_trace_thread_names;		// index is the trace thread id - 1
+uint64_t						resource_trace_dropped_events;
+std::atomic<uint32_t>			resource_trace_next_async_id		{ 1 };
+
+thread_local uint32_t			resource_trace_thread_id;
+
+const char * GetResourceTimingName( ResourceTiming timing )
+{
+	switch( timing ) {
+	case ResourceTiming::WAIT_FOR_DEPENDENCIES:	return "Wait for dependencies";
+	case ResourceTiming::QUEUE_WAIT:			return "Queue wait";
+	case ResourceTiming::IO:					return "I/O";
+	case ResourceTiming::PARSE:					return "Parse";
+	case ResourceTiming::DEVICE_UPLOAD:			return "Device upload";
+	case ResourceTiming::UNLOAD:				return "Unload";
+	case ResourceTiming::TOTAL:					return "Total";
+	default:									return "Unknown";
+	}
+}
+
+uint32_t GetTimingBucket( uint64_t microseconds )
+{
+	uint32_t value		= uint32_t( std::min<uint64_t>( microseconds, UINT32_MAX ) );
+	if( value < ( 1U << RESOURCE_PROFILER_SUB_BUCKET_BITS ) ) return value;
+
+	uint32_t msb		= 31;
+	while( !( value & ( 1U << msb ) ) ) --msb;
+	uint32_t shift		= msb - RESOURCE_PROFILER_SUB_BUCKET_BITS;
+	uint32_t sub_bucket	= ( value >> shift ) & ( ( 1U << RESOURCE_PROFILER_SUB_BUCKET_BITS ) - 1 );
+	return ( ( shift + 1 ) << RESOURCE_PROFILER_SUB_BUCKET_BITS ) + sub_bucket;
+}
+
+// middle of the range of values that fall into the bucket
+double GetTimingBucketValue( uint32_t bucket )
+{
+	if( bucket < ( 1U << RESOURCE_PROFILER_SUB_BUCKET_BITS ) ) return double( bucket );
+
+	uint32_t shift		= ( bucket >> RESOURCE_PROFILER_SUB_BUCKET_BITS ) - 1;
+	uint32_t sub_bucket	= bucket & ( ( 1U << RESOURCE_PROFILER_SUB_BUCKET_BITS ) - 1 );
+	double lower		= double( uint64_t( ( 1U << RESOURCE_PROFILER_SUB_BUCKET_BITS ) + sub_bucket ) << shift );
+	double width		= double( uint64_t( 1 ) << shift );
+	return lower + width * 0.5;
+}
+
+double GetTimingPercentile( const ResourceTimingStatistics & s, uint64_t count, double percentile )
+{
+	uint64_t rank		= uint64_t( std::ceil( double( count ) * percentile ) );
+	rank				= std::max<uint64_t>( rank, 1 );
+	uint64_t seen		= 0;
+	for( uint32_t b=0; b < RESOURCE_PROFILER_HISTOGRAM_BUCKET_COUNT; ++b ) {
+		seen			+= s.histogram[ b ];
+		if( seen >= rank ) {
+			return std::min( GetTimingBucketValue( b ), double( s.max.load() ) );
+		}
+	}
+	return double( s.max.load() );
+}
+
+void WriteJSONString( std::ostream & stream, const std::string & text )
+{
+	stream << '"';
+	for( auto c : text ) {
+		switch( c ) {
+		case '"':	stream << "\\\"";	break;
+		case '\\':	stream << "\\\\";	break;
+		case '\n':	stream << "\\n";	break;
+		case '\t':	stream << "\\t";	break;
+		default:
+			if( uint8_t( c ) < 0x20 ) {
+				stream << "\\u" << std::hex << std::setw( 4 ) << std::setfill( '0' ) << uint32_t( uint8_t( c ) ) << std::dec << std::setfill( ' ' );
+			} else {
+				stream << c;
+			}
+			break;
+		}
+	}
+	stream << '"';
+}
+
+// resource_trace_mutex must be locked when calling this
+uint32_t GetTraceThreadID()
+{
+	if( 0 == resource_trace_thread_id ) {
+		auto worker_index			= JobSystem::GetThisThreadWorkerIndex();
+		std::string name;
+		if( worker_index != UINT32_MAX ) {
+			name					= "Job worker " + std::to_string( worker_index );
+		} else {
+			name					= "Thread " + std::to_string( resource_trace_thread_names.size() );
+		}
+		resource_trace_thread_names.push_back( name );
+		resource_trace_thread_id	= uint32_t( resource_trace_thread_names.size() );
+	}
+	return resource_trace_thread_id;
+}
+
+uint16_t ResourceProfiler_RegisterKind( const char * name )
+{
+	assert( nullptr != name );
+	LOCK_GUARD( resource_kind_mutex );
+	uint32_t count		= resource_kind_count;
+	for( uint32_t i=0; i < count; ++i ) {
+		if( std::strcmp( resource_kind_names[ i ], name ) == 0 ) {
+			return uint16_t( i );
+		}
+	}
+	assert( count < RESOURCE_PROFILER_KIND_MAX_COUNT && "Too many resource kinds, increase RESOURCE_PROFILER_KIND_MAX_COUNT" );
+	if( count >= RESOURCE_PROFILER_KIND_MAX_COUNT ) return uint16_t( RESOURCE_PROFILER_KIND_MAX_COUNT - 1 );
+
+	resource_kind_names[ count ]	= name;
+	resource_kind_count				= count + 1;
+	return uint16_t( count );
+}
+
+uint64_t ResourceProfiler_Now()
+{
+	static const auto start_time	= std::chrono::steady_clock::now();
+	return uint64_t( std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start_time ).count() );
+}
+
+void ResourceProfiler_RecordTiming( uint16_t kind, ResourceTiming timing, uint64_t microseconds )
+{
+	assert( kind < RESOURCE_PROFILER_KIND_MAX_COUNT );
+	assert( timing < ResourceTiming::COUNT );
+	auto & s			= resource_timing_statistics[ kind ][ uint32_t( timing ) ];
+	++s.count;
+	s.total				+= microseconds;
+	auto max			= s.max.load();
+	while( microseconds > max && !s.max.compare_exchange_weak( max, microseconds ) );
+	++s.histogram[ GetTimingBucket( microseconds ) ];
+}
+
+void ResourceProfiler_RecordTraceEvent( const char * name, AssetID asset_id, uint64_t start_time, uint64_t end_time, bool async )
+{
+#if BUILD_RESOURCE_PROFILER_TRACE_EVENT_COUNT
+	assert( nullptr != name );
+	LOCK_GUARD( resource_trace_mutex );
+	if( resource_trace_events.size() >= BUILD_RESOURCE_PROFILER_TRACE_EVENT_COUNT ) {
+		++resource_trace_dropped_events;
+		return;
+	}
+	if( resource_trace_events.capacity() == 0 ) {
+		resource_trace_events.reserve( BUILD_RESOURCE_PROFILER_TRACE_EVENT_COUNT );
+	}
+	ResourceTraceEvent e;
+	e.name				= name;
+	e.asset_id			= asset_id;
+	e.start_time		= start_time;
+	e.end_time			= std::max( end_time, start_time );
+	e.thread_id			= GetTraceThreadID();
+	e.async_id			= async ? resource_trace_next_async_id++ : 0;
+	resource_trace_events.push_back( e );
+#endif
+}
+
+void ResourceProfiler_WriteReport( std::ostream & stream )
+{
+#if BUILD_INCLUDE_RESOURCE_STATISTICS
+	stream << "Resource timing report, times in milliseconds\n";
+	stream << std::left << std::setw( 32 ) << "Kind / timing"
+		<< std::right
+		<< std::setw( 10 ) << "Count"
+		<< std::setw( 12 ) << "Mean"
+		<< std::setw( 12 ) << "p50"
+		<< std::setw( 12 ) << "p95"
+		<< std::setw( 12 ) << "p99"
+		<< std::setw( 12 ) << "Max"
+		<< "\n";
+
+	uint32_t kind_count		= resource_kind_count;
+	for( uint32_t k=0; k < kind_count; ++k ) {
+		stream << resource_kind_names[ k ].load() << "\n";
+		for( uint32_t t=0; t < uint32_t( ResourceTiming::COUNT ); ++t ) {
+			auto & s			= resource_timing_statistics[ k ][ t ];
+			uint64_t count		= s.count;
+			if( 0 == count ) continue;
+
+			stream << "    " << std::left << std::setw( 28 ) << GetResourceTimingName( ResourceTiming( t ) )
+				<< std::right << std::fixed << std::setprecision( 3 )
+				<< std::setw( 10 ) << count
+				<< std::setw( 12 ) << double( s.total ) / double( count ) / 1000.0
+				<< std::setw( 12 ) << GetTimingPercentile( s, count, 0.50 ) / 1000.0
+				<< std::setw( 12 ) << GetTimingPercentile( s, count, 0.95 ) / 1000.0
+				<< std::setw( 12 ) << GetTimingPercentile( s, count, 0.99 ) / 1000.0
+				<< std::setw( 12 ) << double( s.max ) / 1000.0
+				<< "\n";
+		}
+	}
+	stream.flush();
+#else
+	stream << "Resource statistics are disabled, enable BUILD_INCLUDE_RESOURCE_STATISTICS in BUILD_OPTIONS.h\n";
+#endif
+}
+
+void ResourceProfiler_WriteTrace( std::ostream & stream )
+{
+	LOCK_GUARD( resource_trace_mutex );
+
+	stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first		= true;
+	auto Separator	= [ &stream, &first ]() {
+		if( !first ) stream << ",\n";
+		first		= false;
+	};
+	for( size_t i=0; i < resource_trace_thread_names.size(); ++i ) {
+		Separator();
+		stream << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << ( i + 1 ) << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+		WriteJSONString( stream, resource_trace_thread_names[ i ] );
+		stream << "}}";
+	}
+	for( auto & e : resource_trace_events ) {
+		std::string name	= e.name;
+		if( e.asset_id.IsValid() ) {
+			name			+= " ";
+			name			+= e.asset_id.GetPath().string();
+		}
+		if( e.async_id ) {
+			// async spans are drawn as their own tracks, they need a begin and an end event
+			Separator();
+			stream << "{\"ph\":\"b\",\"cat\":\"resource\",\"pid\":1,\"tid\":" << e.thread_id << ",\"id\":" << e.async_id << ",\"ts\":" << e.start_time << ",\"name\":";
+			WriteJSONString( stream, name );
+			stream << "}";
+			Separator();
+			stream << "{\"ph\":\"e\",\"cat\":\"resource\",\"pid\":1,\"tid\":" << e.thread_id << ",\"id\":" << e.async_id << ",\"ts\":" << e.end_time << ",\"name\":";
+			WriteJSONString( stream, name );
+			stream << "}";
+		} else {
+			Separator();
+			stream << "{\"ph\":\"X\",\"cat\":\"resource\",\"pid\":1,\"tid\":" << e.thread_id << ",\"ts\":" << e.start_time << ",\"dur\":" << ( e.end_time - e.start_time ) << ",\"name\":";
+			WriteJSONString( stream, name );
+			stream << "}";
+		}
+	}
+	stream << "\n],\"otherData\":{\"dropped_events\":" << resource_trace_dropped_events << "}}\n";
+	stream.flush();
+}
+
+}
+
+}
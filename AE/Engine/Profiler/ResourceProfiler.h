@@ -0,0 +1,60 @@
+#pragma once
+
+#include <ostream>
+
+#include "../BUILD_OPTIONS.h"
+#include "../Platform.h"
+
+#include "../FileSystem/AssetID.h"
+
+namespace AE
+{
+
+namespace engine_internal
+{
+
+// Maximum amount of different resource kinds, eg. "File XML" or "Device Mesh"
+constexpr uint32_t			RESOURCE_PROFILER_KIND_MAX_COUNT				= 16;
+// Timings are collected in power of two buckets that are split into 8 linear sub buckets,
+// first 8 buckets are exact microseconds, reported percentiles are within 1/16 of the real value
+constexpr uint32_t			RESOURCE_PROFILER_SUB_BUCKET_BITS				= 3;
+constexpr uint32_t			RESOURCE_PROFILER_HISTOGRAM_BUCKET_COUNT		= ( 32 - RESOURCE_PROFILER_SUB_BUCKET_BITS + 1 ) << RESOURCE_PROFILER_SUB_BUCKET_BITS;
+
+// Stages of a resource's life that are timed separately
+enum class ResourceTiming : uint32_t
+{
+	WAIT_FOR_DEPENDENCIES,				// device resource waiting for it's file resources
+	QUEUE_WAIT,							// waiting in the load list for a worker
+	IO,									// reading the file, from submitting the read until the file is opened
+	PARSE,								// file resource Load()
+	DEVICE_UPLOAD,						// device resource Load() and all continue operations, includes waiting for the device
+	UNLOAD,								// Unload() and all continue operations
+	TOTAL,								// from the first request until the resource is loaded
+
+	COUNT,
+};
+
+// Registers a new resource kind or returns the existing kind with the same name,
+// name must point to a string with static storage duration, eg. a string literal
+uint16_t					ResourceProfiler_RegisterKind( const char * name );
+
+// Microseconds from the start of the program, all profiler times use this clock
+uint64_t					ResourceProfiler_Now();
+
+// Adds a timing in microseconds to the histogram of a resource kind
+void						ResourceProfiler_RecordTiming( uint16_t kind, ResourceTiming timing, uint64_t microseconds );
+
+// Records a span of work done by the calling thread into the trace timeline, async spans are drawn
+// on their own track instead of the calling thread, use them for waits like file reads
+// name must point to a string with static storage duration, the resource path is added from the asset id
+void						ResourceProfiler_RecordTraceEvent( const char * name, AssetID asset_id, uint64_t start_time, uint64_t end_time, bool async = false );
+
+// Writes count, mean, p50, p95, p99 and max of every timing of every resource kind
+void						ResourceProfiler_WriteReport( std::ostream & stream );
+
+// Writes the recorded trace events as Chrome trace event JSON, open with chrome://tracing
+void						ResourceProfiler_WriteTrace( std::ostream & stream );
+
+}
+
+}
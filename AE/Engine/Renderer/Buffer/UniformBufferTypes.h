@@ -18,6 +18,9 @@ struct UniformBufferData_Camera
 struct UniformBufferData_Mesh
 {
 	FMat4		model_matrix;
+	// inverse transpose of the scene node transformation, model_matrix may include the non uniform
+	// position scale of compact meshes which must not be applied to normals
+	FMat4		normal_matrix;
 	// Todo
 };
 
@@ -7,6 +7,8 @@
 
 #include "../../Engine.h"
 #include "../Renderer.h"
+#include "DeviceResourceManager.h"
+#include "../../Profiler/ResourceProfiler.h"
 
 namespace AE
 {
@@ -32,6 +34,12 @@ DeviceResource::DeviceResource( Engine * engine, Type device_resource_type, Devi
 	ref_vk_device				= p_renderer->GetVulkanDevice();
 
 	assert( type != Type::UNDEFINED );
+
+#if BUILD_INCLUDE_RESOURCE_STATISTICS
+	// resources are created when they're first requested
+	profile_kind				= engine_internal::ResourceProfiler_RegisterKind( GetProfileKindName( type ) );
+	profile_request_time		= engine_internal::ResourceProfiler_Now();
+#endif
 }
 
 DeviceResource::~DeviceResource()
@@ -59,8 +67,7 @@ bool DeviceResource::IsResourceOK()
 
 uint32_t DeviceResource::GetResourceUsers()
 {
-	std::lock_guard<std::mutex> resource_guard( mutex );
-	return users;
+	return users.load( std::memory_order_acquire );
 }
 
 DeviceResource::Type DeviceResource::GetResourceType() const
@@ -73,6 +80,19 @@ DeviceResource::Flags DeviceResource::GetResourceFlags() const
 	return flags;
 }
 
+void DeviceResource::AddLoadFinishedCallback( std::function<void()> callback )
+{
+	assert( callback );
+	{
+		LOCK_GUARD( mutex );
+		if( !IsLoadFinishedState( state ) ) {
+			load_finished_callbacks.push_back( std::move( callback ) );
+			return;
+		}
+	}
+	callback();
+}
+
 void DeviceResource::Release()
 {
 	DecrementUsers();
@@ -80,18 +100,23 @@ void DeviceResource::Release()
 
 uint32_t DeviceResource::IncrementUsers()
 {
-	std::lock_guard<std::mutex> resource_guard( mutex );
-	++users;
-	assert( !( uint32_t( flags & Flags::UNIQUE ) && ( users != 1 ) ) );
-	return users;
+	auto new_users		= users.fetch_add( 1, std::memory_order_relaxed ) + 1;
+	assert( !( uint32_t( flags & Flags::UNIQUE ) && ( new_users != 1 ) ) );
+	return new_users;
 }
 
 uint32_t DeviceResource::DecrementUsers()
 {
-	std::lock_guard<std::mutex> resource_guard( mutex );
-	--users;
-	assert( !( uint32_t( flags & Flags::UNIQUE ) && ( users != 0 ) ) );
-	return users;
+	// the last user is released by the manager, the resource may be unloaded
+	// by a worker as soon as it's users reach 0 so it's not touched after that
+	auto current_users	= users.load( std::memory_order_relaxed );
+	while( current_users > 1 ) {
+		assert( !uint32_t( flags & Flags::UNIQUE ) );
+		if( users.compare_exchange_weak( current_users, current_users - 1, std::memory_order_acq_rel, std::memory_order_relaxed ) ) {
+			return current_users - 1;
+		}
+	}
+	return p_device_resource_manager->DecrementUsers( this );
 }
 
 DeviceResource::LoadingState DeviceResource::LoadFromManager()
@@ -100,13 +125,26 @@ DeviceResource::LoadingState DeviceResource::LoadFromManager()
 		std::lock_guard<std::mutex> resource_guard( mutex );
 		locked_worker_thread_id		= std::this_thread::get_id();
 	}
+#if BUILD_INCLUDE_RESOURCE_STATISTICS
+	profile_load_time	= engine_internal::ResourceProfiler_Now();
+	engine_internal::ResourceProfiler_RecordTiming( profile_kind, engine_internal::ResourceTiming::QUEUE_WAIT, profile_load_time - profile_queued_time );
+#endif
 	auto result			= Load();
+#if BUILD_INCLUDE_RESOURCE_STATISTICS
+	engine_internal::ResourceProfiler_RecordTraceEvent( "Device load", GetProfileAssetID(), profile_load_time, engine_internal::ResourceProfiler_Now() );
+#endif
 	return result;
 }
 
 DeviceResource::UnloadingState DeviceResource::UnloadFromManager()
 {
+#if BUILD_INCLUDE_RESOURCE_STATISTICS
+	profile_unload_time	= engine_internal::ResourceProfiler_Now();
+#endif
 	auto result			= Unload();
+#if BUILD_INCLUDE_RESOURCE_STATISTICS
+	engine_internal::ResourceProfiler_RecordTraceEvent( "Device unload", GetProfileAssetID(), profile_unload_time, engine_internal::ResourceProfiler_Now() );
+#endif
 	return result;
 }
 
@@ -126,20 +164,33 @@ DeviceResource::LoadingState DeviceResource::ContinueLoadingFromManager()
 {
 	assert( locked_worker_thread_id == std::this_thread::get_id() );
 	assert( nullptr != NextLoadOperation );
+#if BUILD_INCLUDE_RESOURCE_STATISTICS
+	auto start_time		= engine_internal::ResourceProfiler_Now();
+	auto result			= NextLoadOperation( this );
+	engine_internal::ResourceProfiler_RecordTraceEvent( "Device continue load", GetProfileAssetID(), start_time, engine_internal::ResourceProfiler_Now() );
+	return result;
+#else
 	return NextLoadOperation( this );
+#endif
 }
 
 DeviceResource::UnloadingState DeviceResource::ContinueUnloadingFromManager()
 {
 	assert( locked_worker_thread_id == std::this_thread::get_id() );
 	assert( nullptr != NextUnloadOperation );
+#if BUILD_INCLUDE_RESOURCE_STATISTICS
+	auto start_time		= engine_internal::ResourceProfiler_Now();
+	auto result			= NextUnloadOperation( this );
+	engine_internal::ResourceProfiler_RecordTraceEvent( "Device continue unload", GetProfileAssetID(), start_time, engine_internal::ResourceProfiler_Now() );
+	return result;
+#else
 	return NextUnloadOperation( this );
+#endif
 }
 
 std::thread::id DeviceResource::GetWorkerThreadID()
 {
-	std::lock_guard<std::mutex> resource_guard( mutex );
-	return locked_worker_thread_id;
+	return locked_worker_thread_id.load( std::memory_order_acquire );
 }
 
 DeviceResource::State DeviceResource::GetResourceState()
@@ -150,8 +201,50 @@ DeviceResource::State DeviceResource::GetResourceState()
 
 void DeviceResource::SetResourceState( DeviceResource::State new_state )
 {
-	std::lock_guard<std::mutex> resource_guard( mutex );
-	state		= new_state;
+#if BUILD_INCLUDE_RESOURCE_STATISTICS
+	// device upload and unload include all continue operations and waiting for the device in between
+	if( State::LOADED == new_state ) {
+		auto now		= engine_internal::ResourceProfiler_Now();
+		engine_internal::ResourceProfiler_RecordTiming( profile_kind, engine_internal::ResourceTiming::DEVICE_UPLOAD, now - profile_load_time );
+		engine_internal::ResourceProfiler_RecordTiming( profile_kind, engine_internal::ResourceTiming::TOTAL, now - profile_request_time );
+	} else if( State::UNLOADED == new_state ) {
+		auto now		= engine_internal::ResourceProfiler_Now();
+		engine_internal::ResourceProfiler_RecordTiming( profile_kind, engine_internal::ResourceTiming::UNLOAD, now - profile_unload_time );
+	}
+#endif
+	Vector<std::function<void()>> callbacks;
+	{
+		std::lock_guard<std::mutex> resource_guard( mutex );
+		state		= new_state;
+		if( IsLoadFinishedState( state ) ) {
+			callbacks.swap( load_finished_callbacks );
+		}
+	}
+	// called without the lock so that callbacks can use the resource
+	for( auto & c : callbacks ) {
+		c();
+	}
+}
+
+bool DeviceResource::IsLoadFinishedState( DeviceResource::State check_state )
+{
+	return ( State::LOADED == check_state || State::UNABLE_TO_LOAD == check_state );
+}
+
+const char * DeviceResource::GetProfileKindName( DeviceResource::Type resource_type )
+{
+	switch( resource_type ) {
+	case Type::GRAPHICS_PIPELINE:	return "Device graphics pipeline";
+	case Type::MESH:				return "Device mesh";
+	case Type::IMAGE:				return "Device image";
+	default:						return "Device unknown";
+	}
+}
+
+AssetID DeviceResource::GetProfileAssetID() const
+{
+	// device resources don't have a path of their own, the first file resource names them in the trace
+	return file_resource_ids.size() ? file_resource_ids[ 0 ] : AssetID();
 }
 
 void DeviceResource::SetNextLoadOperation( std::function<bool( DeviceResource* )> test, std::function<LoadingState( DeviceResource* )> operation )
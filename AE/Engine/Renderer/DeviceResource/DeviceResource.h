@@ -37,7 +37,7 @@ class DeviceResource_Image;
 class DeviceResource
 {
 	friend class DeviceResourceManager;
-	friend void DeviceWorkerThread( Engine * engine, DeviceResourceManager * device_resource_manager, std::atomic_bool * thread_sleeping );
+	friend void DeviceWorkerJob( Engine * engine, DeviceResourceManager * device_resource_manager, uint32_t worker_slot );
 	template<typename T>
 	friend class DeviceResourceHandle;
 
@@ -102,6 +102,11 @@ public:
 	Type						GetResourceType() const;
 	Flags						GetResourceFlags() const;
 
+	// Callback is called once when the resource has finished loading or failed to load, use IsResourceOK()
+	// to tell them apart. If the resource has already finished the callback is called right away, othervise
+	// it's called from the thread that finished the resource so it should be short and thread safe
+	void						AddLoadFinishedCallback( std::function<void()> callback );
+
 	// if you use DeviceResourceHandle you don't manually need to call this function
 	void						Release();
 
@@ -138,10 +143,16 @@ private:
 
 	std::thread::id				GetWorkerThreadID();
 
+	static bool					IsLoadFinishedState( DeviceResource::State check_state );
+	// name the resource is reported with in the resource profiler
+	static const char		*	GetProfileKindName( DeviceResource::Type resource_type );
+	AssetID						GetProfileAssetID() const;
+
 public:
 	State						GetResourceState();
 
 protected:
+	// calls load finished callbacks when the new state is a finished state
 	void						SetResourceState( DeviceResource::State new_state );
 
 	// MUST BE SET BEFORE EXITING Load() function or previous call to next unload operation if these functions return CONTINUE_LOADING
@@ -179,17 +190,45 @@ private:
 	std::function<UnloadingState( DeviceResource* )>			NextUnloadOperation				= nullptr;
 
 	Mutex						mutex;
-	uint32_t					users							= 0;
+	// users only go from 0 to 1 while the lookup shard of the resource is locked,
+	// so the count itself does not need the resource mutex
+	std::atomic<uint32_t>		users							{ 0 };
 	State						state							= State::UNLOADED;
 	Flags						flags							= Flags( 0 );
 	Type						type							= Type::UNDEFINED;
+	ResourcePriority			load_priority					= ResourcePriority::NORMAL;
+	// waiting for the resource to finish loading, called and cleared when the state is set to a finished state
+	Vector<std::function<void()>>								load_finished_callbacks;
 
 	// Passing around the vulkan objects from thread to thread is generally troublesome
 	// we need to lock onto one of the worker threads and only use that thread to do all loading operations
 	// Resource manager call to Load() function will lock all future load operations to the thread that called
 	// Load() originally. Similarly call to Unload() will lock all future unload operations to
 	// the same thread that called Unload() originally. See: NextLoadOperation and NextUnloadOperation
-	std::thread::id				locked_worker_thread_id;
+	// atomic because the manager reads it while holding it's unload queue lock instead of the resource mutex
+	std::atomic<std::thread::id>	locked_worker_thread_id;
+
+	// hash of the resource type and file resource ids, selects the lookup shard of the manager
+	uint64_t					lookup_hash						= 0;
+	// set when the resource is created, file resources themselves are requested after that
+	Vector<AssetID>				file_resource_ids;
+	// file resources that haven't finished loading yet, the resource is queued for loading when this reaches 0
+	std::atomic<uint32_t>		file_resources_left				{ 0 };
+
+	// resource is queued for unloading on it's locked worker thread when it's users drop to 0,
+	// guarded by the unload queue mutex of the manager
+	bool						in_unload_queue					= false;
+	uint32_t					unload_queue_index				= UINT32_MAX;
+	List<DeviceResource*>::iterator								unload_queue_position;
+
+#if BUILD_INCLUDE_RESOURCE_STATISTICS
+	// resource profiler kind and timestamps in profiler time
+	uint16_t					profile_kind					= 0;
+	uint64_t					profile_request_time			= 0;
+	uint64_t					profile_queued_time				= 0;
+	uint64_t					profile_load_time				= 0;
+	uint64_t					profile_unload_time				= 0;
+#endif
 
 protected:
 	Vector<FileResourceHandle<FileResource>>					file_resources;
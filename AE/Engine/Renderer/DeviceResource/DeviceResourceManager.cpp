@@ -1,8 +1,12 @@
 
+#include <algorithm>
+
 #include "DeviceResourceManager.h"
 
 #include "../../Engine.h"
 #include "../../Logger/Logger.h"
+#include "../../Threading/JobSystem.h"
+#include "../../Profiler/ResourceProfiler.h"
 #include "../Renderer.h"
 #include "../../FileResource/FileResourceManager.h"
 
@@ -18,232 +22,248 @@
 namespace AE
 {
 
-void DeviceWorkerThread( Engine * engine, DeviceResourceManager * device_resource_manager, std::atomic_bool * thread_sleeping )
+// one pass over the loading and unloading work of a worker slot, runs as a job pinned to the slot's job worker
+void DeviceWorkerJob( Engine * engine, DeviceResourceManager * device_resource_manager, uint32_t worker_slot )
 {
 	assert( nullptr != engine );
 	assert( nullptr != device_resource_manager );
 	Logger					*	p_logger			= engine->GetLogger();
 	assert( p_logger );
+	assert( worker_slot == device_resource_manager->GetThisTreadResourceIndex() );
 
-	auto this_thread_index		= device_resource_manager->GetThisTreadResourceIndex();
+	MEMORY_TAG( "Device resource worker" );
 
-	while( !device_resource_manager->worker_threads_should_exit ) {
+	// look for loading work first
+	bool load_operation_ran	= false;
+	if( device_resource_manager->allow_resource_loading ) {
+		// look for continuing load operations
 		{
-			std::unique_lock<std::mutex> wakeup_guard( device_resource_manager->worker_threads_wakeup_mutex );
-			*thread_sleeping	= true;
-			device_resource_manager->worker_threads_wakeup.wait( wakeup_guard );
-			*thread_sleeping	= false;
-		}
-		// look for loading work first
-		bool load_operation_ran	= false;
-		if( device_resource_manager->allow_resource_loading ) {
-			// look for continuing load operations
+			TODO( "device resource continue loading operations should also loop until all NextLoadOperationCanRun() functions return false within that loop" );
+			DeviceResource	*	resource			= nullptr;
+			bool				next_op_can_run		= false;
 			{
-				TODO( "device resource continue loading operations should also loop until all NextLoadOperationCanRun() functions return false within that loop" );
-				DeviceResource	*	resource			= nullptr;
-				bool				next_op_can_run		= false;
+				std::lock_guard<std::mutex> continue_load_list_guard( device_resource_manager->mutex_load_and_continue_load_list );
+				auto it = device_resource_manager->continue_load_list.begin();
+				while( it != device_resource_manager->continue_load_list.end() ) {
+					resource		= *it;
+					if( resource->GetWorkerThreadID() == std::this_thread::get_id() ) {
+						next_op_can_run		= resource->ContinueLoadingFromManagerCanRun();
+					}
+					if( next_op_can_run ) {
+						it			= device_resource_manager->continue_load_list.erase( it );
+						break;
+					} else {
+						++it;
+					}
+				}
+			}
+			if( nullptr != resource && next_op_can_run ) {
+				auto loading_state	= resource->ContinueLoadingFromManager();
+				switch( loading_state ) {
+				case AE::DeviceResource::LoadingState::UNABLE_TO_LOAD:
+				{
+					resource->SetResourceState( DeviceResource::State::UNABLE_TO_LOAD );
+					device_resource_manager->QueueForUnload( resource );
+					assert( 0 && "Unable to load resource" );
+					break;
+				}
+				case AE::DeviceResource::LoadingState::CONTINUE_LOADING:
 				{
 					std::lock_guard<std::mutex> continue_load_list_guard( device_resource_manager->mutex_load_and_continue_load_list );
-					auto it = device_resource_manager->continue_load_list.begin();
-					while( it != device_resource_manager->continue_load_list.end() ) {
-						resource		= *it;
-						if( resource->GetWorkerThreadID() == std::this_thread::get_id() ) {
-							next_op_can_run		= resource->ContinueLoadingFromManagerCanRun();
+					device_resource_manager->continue_load_list.push_back( resource );
+					break;
+				}
+				case AE::DeviceResource::LoadingState::LOADED:
+				{
+					resource->SetResourceState( DeviceResource::State::LOADED );
+					device_resource_manager->QueueForUnload( resource );
+					break;
+				}
+				default:
+					assert( 0 && "Illegal device resource loading state" );
+					break;
+				}
+			}
+		}
+		// look for new load operations
+		{
+			bool more_work_available		= true;
+			// loop and load everything until the load list is empty
+			// this way we don't have to wait a call from the resource manager
+			// to initiate resource loading if there is pending work
+			while( more_work_available ) {
+				DeviceResource	*	resource	= nullptr;
+				{
+					std::lock_guard<std::mutex> load_list_guard( device_resource_manager->mutex_load_and_continue_load_list );
+					auto res		= device_resource_manager->load_list.begin();
+					if( res != device_resource_manager->load_list.end() ) {
+						resource	= *res;
+						device_resource_manager->load_list.erase( res );
+					}
+					if( device_resource_manager->load_list.size() == 0 ) {
+						more_work_available		= false;
+					}
+				}
+				if( nullptr != resource ) {
+					bool can_load	= false;
+					{
+						std::lock_guard<std::mutex> resource_guard( resource->mutex );
+						assert( resource->state == DeviceResource::State::LOADING_QUEUED );
+						can_load	= ( resource->state == DeviceResource::State::LOADING_QUEUED );
+						if( can_load )	resource->state = DeviceResource::State::LOADING;
+					}
+					if( can_load ) {
+						auto load_state		= resource->LoadFromManager();
+						switch( load_state ) {
+						case AE::DeviceResource::LoadingState::UNABLE_TO_LOAD:
+						{
+							resource->SetResourceState( DeviceResource::State::UNABLE_TO_LOAD );
+							device_resource_manager->QueueForUnload( resource );
+							break;
+						}
+						case AE::DeviceResource::LoadingState::CONTINUE_LOADING:
+						{
+							std::lock_guard<std::mutex> continue_load_list_guard( device_resource_manager->mutex_load_and_continue_load_list );
+							device_resource_manager->continue_load_list.push_back( resource );
+							break;
+						}
+						case AE::DeviceResource::LoadingState::LOADED:
+						{
+							resource->SetResourceState( DeviceResource::State::LOADED );
+							device_resource_manager->QueueForUnload( resource );
+							break;
+						}
+						default:
+							assert( 0 && "Illegal device resource loading state" );
+							break;
+						}
+						load_operation_ran			= true;
+					}
+				}
+			}
+		}
+	}
+	// loading goes first, unloading is left for the next pass
+	if( load_operation_ran ) {
+		device_resource_manager->worker_jobs_requested[ worker_slot ]	= true;
+	}
+	// look for unloading and destroying work
+	if( device_resource_manager->allow_resource_unloading ) {
+		if( !load_operation_ran ) {
+			// look for continuing unload operations
+			{
+				UniquePointer<DeviceResource>	resource			= nullptr;
+				bool							next_op_can_run		= false;
+				{
+					std::lock_guard<std::mutex> continue_unload_list_guard( device_resource_manager->mutex_continue_unload_list );
+					auto it = device_resource_manager->continue_unload_list.begin();
+					while( it != device_resource_manager->continue_unload_list.end() ) {
+						if( ( *it )->GetWorkerThreadID() == std::this_thread::get_id() ) {
+							next_op_can_run		= ( *it )->ContinueUnloadingFromManagerCanRun();
 						}
 						if( next_op_can_run ) {
-							it			= device_resource_manager->continue_load_list.erase( it );
+							resource	= std::move( *it );
+							it			= device_resource_manager->continue_unload_list.erase( it );
 							break;
 						} else {
 							++it;
 						}
 					}
 				}
-				if( nullptr != resource && next_op_can_run ) {
-					auto loading_state	= resource->ContinueLoadingFromManager();
+				if( resource && next_op_can_run ) {
+					auto loading_state	= resource->ContinueUnloadingFromManager();
 					switch( loading_state ) {
-					case AE::DeviceResource::LoadingState::UNABLE_TO_LOAD:
+					case AE::DeviceResource::UnloadingState::UNABLE_TO_UNLOAD:
 					{
-						resource->SetResourceState( DeviceResource::State::UNABLE_TO_LOAD );
-						assert( 0 && "Unable to load resource" );
+						resource->SetResourceState( DeviceResource::State::UNABLE_TO_UNLOAD );
+						assert( 0 && "Failed to unload device resource, we'll try and destroy the object anyway" );
 						break;
 					}
-					case AE::DeviceResource::LoadingState::CONTINUE_LOADING:
+					case AE::DeviceResource::UnloadingState::CONTINUE_UNLOADING:
 					{
-						std::lock_guard<std::mutex> continue_load_list_guard( device_resource_manager->mutex_load_and_continue_load_list );
-						device_resource_manager->continue_load_list.push_back( resource );
+						std::lock_guard<std::mutex> continue_unload_list_guard( device_resource_manager->mutex_continue_unload_list );
+						device_resource_manager->continue_unload_list.push_back( std::move( resource ) );
 						break;
 					}
-					case AE::DeviceResource::LoadingState::LOADED:
+					case AE::DeviceResource::UnloadingState::UNLOADED:
 					{
-						resource->SetResourceState( DeviceResource::State::LOADED );
+						resource->SetResourceState( DeviceResource::State::UNLOADED );
 						break;
 					}
 					default:
-						assert( 0 && "Illegal device resource loading state" );
+						assert( 0 && "Illegal device resource unloading state" );
 						break;
 					}
 				}
 			}
-			// look for new load operations
+			// look for new unload operations
 			{
-				bool more_work_available		= true;
-				// loop and load everything until the load list is empty
-				// this way we don't have to wait a call from the resource manager
-				// to initiate resource loading if there is pending work
-				while( more_work_available ) {
-					DeviceResource	*	resource	= nullptr;
-					{
-						std::lock_guard<std::mutex> load_list_guard( device_resource_manager->mutex_load_and_continue_load_list );
-						auto res		= device_resource_manager->load_list.begin();
-						if( res != device_resource_manager->load_list.end() ) {
-							resource	= *res;
-							device_resource_manager->load_list.erase( res );
-						}
-						if( device_resource_manager->load_list.size() == 0 ) {
-							more_work_available		= false;
-						}
+				UniquePointer<DeviceResource>	resource	= nullptr;
+				DeviceResource				*	candidate	= nullptr;
+				{
+					// resources are queued per worker thread as some resources depend on
+					// per-thread vulkan memory or buffer pools of the thread that loaded them
+					LOCK_GUARD( device_resource_manager->mutex_unload_queues );
+					assert( worker_slot < device_resource_manager->unload_queues.size() );
+					auto & unload_queue		= device_resource_manager->unload_queues[ worker_slot ];
+					if( unload_queue.size() ) {
+						candidate			= unload_queue.front();
+						device_resource_manager->RemoveFromUnloadQueue( candidate );
 					}
-					if( nullptr != resource ) {
-						bool can_load	= false;
-						{
-							std::lock_guard<std::mutex> resource_guard( resource->mutex );
-							assert( resource->state == DeviceResource::State::LOADING_QUEUED );
-							can_load	= ( resource->state == DeviceResource::State::LOADING_QUEUED );
-							if( can_load )	resource->state = DeviceResource::State::LOADING;
-						}
-						if( can_load ) {
-							auto load_state		= resource->LoadFromManager();
-							switch( load_state ) {
-							case AE::DeviceResource::LoadingState::UNABLE_TO_LOAD:
-							{
-								resource->SetResourceState( DeviceResource::State::UNABLE_TO_LOAD );
-								break;
-							}
-							case AE::DeviceResource::LoadingState::CONTINUE_LOADING:
-							{
-								std::lock_guard<std::mutex> continue_load_list_guard( device_resource_manager->mutex_load_and_continue_load_list );
-								device_resource_manager->continue_load_list.push_back( resource );
-								break;
-							}
-							case AE::DeviceResource::LoadingState::LOADED:
-							{
-								resource->SetResourceState( DeviceResource::State::LOADED );
-								break;
-							}
-							default:
-								assert( 0 && "Illegal device resource loading state" );
-								break;
-							}
-							load_operation_ran			= true;
+				}
+				if( nullptr != candidate ) {
+					auto & shard	= device_resource_manager->GetResourceShard( candidate->lookup_hash );
+					std::lock_guard<std::mutex> shard_guard( shard.mutex );
+					std::lock_guard<std::mutex> resource_guard( candidate->mutex );
+					// users only go from 0 to 1 while the shard is locked so this check is final,
+					// resources that are still loading are queued again once loading finishes
+					assert( candidate->locked_worker_thread_id == std::this_thread::get_id() );
+					if( candidate->users == 0 &&
+						candidate->state != DeviceResource::State::LOADING &&
+						candidate->state != DeviceResource::State::LOADING_QUEUED ) {
+						auto range			= shard.resources.equal_range( candidate->lookup_hash );
+						auto it				= range.first;
+						while( it != range.second && it->second.Get() != candidate ) {
+							++it;
 						}
+						assert( it != range.second );
+						candidate->state	= DeviceResource::State::UNLOADING;
+						resource			= std::move( it->second );
+						shard.resources.erase( it );
+						// it may have been requested, released and queued again after we took it from the queue
+						LOCK_GUARD( device_resource_manager->mutex_unload_queues );
+						device_resource_manager->RemoveFromUnloadQueue( candidate );
 					}
 				}
-			}
-		}
-		// look for unloading and destroying work
-		if( device_resource_manager->allow_resource_unloading ) {
-			if( !load_operation_ran ) {
-				// look for continuing unload operations
-				{
-					UniquePointer<DeviceResource>	resource			= nullptr;
-					bool							next_op_can_run		= false;
+				if( resource ) {
+					auto state = resource->UnloadFromManager();
+					switch( state ) {
+					case AE::DeviceResource::UnloadingState::UNABLE_TO_UNLOAD:
 					{
-						std::lock_guard<std::mutex> continue_unload_list_guard( device_resource_manager->mutex_continue_unload_list );
-						auto it = device_resource_manager->continue_unload_list.begin();
-						while( it != device_resource_manager->continue_unload_list.end() ) {
-							if( resource->GetWorkerThreadID() == std::this_thread::get_id() ) {
-								next_op_can_run		= ( *it )->ContinueUnloadingFromManagerCanRun();
-							}
-							if( next_op_can_run ) {
-								resource	= std::move( *it );
-								it			= device_resource_manager->continue_unload_list.erase( it );
-								break;
-							} else {
-								++it;
-							}
-						}
+						resource->SetResourceState( DeviceResource::State::UNABLE_TO_UNLOAD );
+						assert( 0 && "Unable to unload resource, we'll try and delete it anyways" );
+						break;
 					}
-					if( resource && next_op_can_run ) {
-						auto loading_state	= resource->ContinueUnloadingFromManager();
-						switch( loading_state ) {
-						case AE::DeviceResource::UnloadingState::UNABLE_TO_UNLOAD:
-						{
-							resource->SetResourceState( DeviceResource::State::UNABLE_TO_UNLOAD );
-							assert( 0 && "Failed to unload device resource, we'll try and destroy the object anyway" );
-							break;
-						}
-						case AE::DeviceResource::UnloadingState::CONTINUE_UNLOADING:
-						{
-							std::lock_guard<std::mutex> continue_unload_list_guard( device_resource_manager->mutex_continue_unload_list );
-							device_resource_manager->continue_unload_list.push_back( std::move( resource ) );
-							break;
-						}
-						case AE::DeviceResource::UnloadingState::UNLOADED:
-						{
-							resource->SetResourceState( DeviceResource::State::UNLOADED );
-							break;
-						}
-						default:
-							assert( 0 && "Illegal device resource unloading state" );
-							break;
-						}
+					case AE::DeviceResource::UnloadingState::CONTINUE_UNLOADING:
+					{
+						std::lock_guard<std::mutex> continue_unload_list_guard( device_resource_manager->mutex_continue_unload_list );
+						device_resource_manager->continue_unload_list.push_back( std::move( resource ) );
+						break;
 					}
-				}
-				// look for new unload operations
-				{
-					UniquePointer<DeviceResource> resource = nullptr;
+					case AE::DeviceResource::UnloadingState::UNLOADED:
 					{
-						std::lock_guard<std::mutex> resources_list_guard( device_resource_manager->mutex_resources_list );
-						auto it = device_resource_manager->resources_list.begin();
-						while( it != device_resource_manager->resources_list.end() ) {
-							auto & res = *it;
-							std::lock_guard<std::mutex> resource_guard( res->mutex );
-							// only unload a resource if it's users match to 0 AND the resource was created using this same thread originally
-							// thread id check is mandatory for some resources depend on per-thread vulkan memory or buffer pools
-							if( res->users == 0 && res->locked_worker_thread_id == std::this_thread::get_id() ) {
-								if( res->state != DeviceResource::State::LOADING && res->state != DeviceResource::State::LOADING_QUEUED ) {
-									res->state		= DeviceResource::State::UNLOADING;
-									resource		= std::move( *it );
-									it				= device_resource_manager->resources_list.erase( it );
-									break;
-								} else {
-									++it;
-								}
-							} else {
-								++it;
-							}
-						}
+						resource->SetResourceState( DeviceResource::State::UNLOADED );
+						break;
 					}
-					if( resource ) {
-						auto state = resource->UnloadFromManager();
-						switch( state ) {
-						case AE::DeviceResource::UnloadingState::UNABLE_TO_UNLOAD:
-						{
-							resource->SetResourceState( DeviceResource::State::UNABLE_TO_UNLOAD );
-							assert( 0 && "Unable to unload resource, we'll try and delete it anyways" );
-							break;
-						}
-						case AE::DeviceResource::UnloadingState::CONTINUE_UNLOADING:
-						{
-							std::lock_guard<std::mutex> continue_unload_list_guard( device_resource_manager->mutex_continue_unload_list );
-							device_resource_manager->continue_unload_list.push_back( std::move( resource ) );
-							break;
-						}
-						case AE::DeviceResource::UnloadingState::UNLOADED:
-						{
-							resource->SetResourceState( DeviceResource::State::UNLOADED );
-							break;
-						}
-						default:
-							assert( 0 && "Illegal device resource unload state" );
-							break;
-						}
+					default:
+						assert( 0 && "Illegal device resource unload state" );
+						break;
 					}
 				}
 			}
 		}
 	}
-};
+}
 
 
 DeviceResourceManager::DeviceResourceManager( Engine * engine, Renderer * renderer, DeviceMemoryManager * device_memory_manager )
@@ -256,8 +276,11 @@ DeviceResourceManager::DeviceResourceManager( Engine * engine, Renderer * render
 	assert( nullptr != p_device_memory_manager );
 	p_logger					= p_engine->GetLogger();
 	p_file_resource_manager		= p_engine->GetFileResourceManager();
+	p_job_system				= p_engine->GetJobSystem();
 	assert( nullptr != p_logger );
 	assert( nullptr != p_file_resource_manager );
+	assert( nullptr != p_job_system );
+	assert( p_job_system->GetWorkerCount() >= BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT );
 
 	ref_vk_instance							= p_renderer->GetVulkanInstance();
 	ref_vk_device							= p_renderer->GetVulkanDevice();
@@ -271,12 +294,14 @@ DeviceResourceManager::DeviceResourceManager( Engine * engine, Renderer * render
 	allow_resource_requests					= false;
 	allow_resource_loading					= false;
 	allow_resource_unloading				= false;
-	worker_threads_should_exit				= false;
+	for( uint32_t i=0; i < BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT; ++i ) {
+		worker_jobs_running[ i ]			= false;
+		worker_jobs_requested[ i ]			= false;
+	}
 	{
 		LOCK_GUARD( *ref_vk_device.mutex );
 
 		for( uint32_t i=0; i < BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT; ++i ) {
-			worker_threads_sleeping[ i ]		= false;
 			{
 				// create primary render command pool
 				VkCommandPoolCreateInfo command_pool_CI {};
@@ -310,9 +335,6 @@ DeviceResourceManager::DeviceResourceManager( Engine * engine, Renderer * render
 				command_pool_CI.queueFamilyIndex				= primary_transfer_queue_family_index;
 				VulkanResultCheck( vkCreateCommandPool( ref_vk_device.object, &command_pool_CI, VULKAN_ALLOC, &vk_thread_command_pools_primary_transfer[ i ] ) );
 			}
-
-			auto thread				= std::thread( DeviceWorkerThread, p_engine, this, &worker_threads_sleeping[ i ] );
-			worker_threads[ i ]		= std::move( thread );
 		}
 	}
 }
@@ -331,32 +353,14 @@ DeviceResourceManager::~DeviceResourceManager()
 		LOCK_GUARD( *ref_vk_device.mutex );
 		VulkanResultCheck( vkDeviceWaitIdle( ref_vk_device.object ) );
 	}
-	// notify all threads they should close
-	worker_threads_should_exit				= true;
-
-	// wait until they're all joinable, keep waking them up until they become joinable
-	uint32_t worker_threads_joinable_count	= 0;
-	while( worker_threads_joinable_count != BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT ) {
-		SignalWorkers_All();
-		std::this_thread::yield();
-		std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
-
-		uint32_t worker_threads_joinable_count_temp		= 0;
-		for( auto & t : worker_threads ) {
-			worker_threads_joinable_count_temp += uint32_t( !!t.joinable() );
-		}
-		worker_threads_joinable_count	= worker_threads_joinable_count_temp;
-	}
-
-	// all worker threads should be joinable
-	for( auto & w : worker_threads ) {
-		w.join();
-	}
+	// no more worker jobs are scheduled, wait for the ones that are still queued or running
+	worker_jobs_should_exit					= true;
+	WaitIdle();
 
 	{
 		LOCK_GUARD( *ref_vk_device.mutex );
 
-		// sync device and CPU again because worker threads might have made some calls to the device
+		// sync device and CPU again because worker jobs might have made some calls to the device
 		VulkanResultCheck( vkDeviceWaitIdle( ref_vk_device.object ) );
 
 		// destroy all command pools
@@ -392,132 +396,328 @@ DeviceResourceManager::~DeviceResourceManager()
 	}
 }
 
-DeviceResourceHandle<DeviceResource> DeviceResourceManager::RequestResource( DeviceResource::Type resource_type, const Vector<Path> & file_resource_paths, DeviceResource::Flags resource_flags )
+DeviceResourceHandle<DeviceResource> DeviceResourceManager::RequestResource( DeviceResource::Type resource_type, const Vector<AssetID> & file_resource_ids, DeviceResource::Flags resource_flags, ResourcePriority priority )
 {
 	if( !allow_resource_requests ) return nullptr;
 
+	auto lookup_hash			= HashResourceKey( resource_type, file_resource_ids );
+	auto & shard				= GetResourceShard( lookup_hash );
+
 	DeviceResourceHandle<DeviceResource>	resource		= nullptr;
 	{
-		std::lock_guard<std::mutex>			resource_list_guard( mutex_resources_list );
+		std::lock_guard<std::mutex>			shard_guard( shard.mutex );
 
 		// we should create an unique resource if one was requested, othervise share an existing one if one exists
 		if( resource_flags & DeviceResource::Flags::UNIQUE ) {
-			resource		= RequestNewResource( resource_type, resource_flags );
+			resource		= RequestNewResource( shard, lookup_hash, resource_type, resource_flags );
 		} else {
-			resource		= RequestExistingResource( resource_type, file_resource_paths, resource_flags );
+			resource		= RequestExistingResource( shard, lookup_hash, resource_type, file_resource_ids );
 			if( resource ) {
+				BumpResourcePriority( resource.Get(), priority );
 				return resource;
 			} else {
-				resource	= RequestNewResource( resource_type, resource_flags );
+				resource	= RequestNewResource( shard, lookup_hash, resource_type, resource_flags );
 			}
 		}
 		assert( resource );
-		resource->state		= DeviceResource::State::LOADING_QUEUED;
+		std::lock_guard<std::mutex> resource_guard( resource->mutex );
+		resource->state				= DeviceResource::State::LOADING_QUEUED;
+		resource->load_priority		= priority;
+		// ids are set while the shard is locked so that other requests can match them
+		resource->file_resource_ids	= file_resource_ids;
 	}
 	// a new resource has to be created, we need to request it's file resources from file resource manager
 	{
-		bool all_file_resources_loaded	= true;
-		if( resource ) {
-			std::lock_guard<std::mutex> resource_guard( resource->mutex );
-			resource->file_resources.resize( file_resource_paths.size() );
-			for( size_t i=0; i < file_resource_paths.size(); ++i ) {
-				resource->file_resources[ i ]	= p_file_resource_manager->RequestResource( file_resource_paths[ i ] );
-				if( resource->file_resources[ i ] ) {
-					if( !resource->file_resources[ i ]->IsResourceReadyForUse() ) {
-						all_file_resources_loaded	= false;
-					}
-				} else {
-					p_logger->LogError( "Device Resource request failed, file resource not found: " + file_resource_paths[ i ].string() );
-					resource->state = DeviceResource::State::UNABLE_TO_LOAD;
-					assert( 0 && "Device Resource request failed, file resource not found" );
+		std::lock_guard<std::mutex> resource_guard( resource->mutex );
+		resource->file_resources.resize( file_resource_ids.size() );
+		for( size_t i=0; i < file_resource_ids.size(); ++i ) {
+			resource->file_resources[ i ]	= p_file_resource_manager->RequestResource( file_resource_ids[ i ], priority );
+			if( !resource->file_resources[ i ] ) {
+				p_logger->LogError( "Device Resource request failed, file resource not found: " + file_resource_ids[ i ].GetPath().string() );
+				assert( 0 && "Device Resource request failed, file resource not found" );
+			}
+		}
+	}
+	WaitForFileResources( resource.Get(), true );
+	return resource;
+}
+
+Vector<DeviceResourceHandle<DeviceResource>> DeviceResourceManager::RequestResources( const Vector<ResourceRequest> & requests )
+{
+	Vector<DeviceResourceHandle<DeviceResource>> resources( requests.size() );
+	if( !allow_resource_requests ) return resources;
+
+	// requests are handled shard by shard
+	Vector<uint64_t> lookup_hashes( requests.size() );
+	Vector<uint32_t> order( requests.size() );
+	for( uint32_t i=0; i < uint32_t( requests.size() ); ++i ) {
+		lookup_hashes[ i ]		= HashResourceKey( requests[ i ].type, requests[ i ].file_resource_ids );
+		order[ i ]				= i;
+	}
+	std::sort( order.begin(), order.end(), [ &lookup_hashes ]( uint32_t a, uint32_t b ) {
+		auto shard_a	= GetResourceShardIndex( lookup_hashes[ a ] );
+		auto shard_b	= GetResourceShardIndex( lookup_hashes[ b ] );
+		if( shard_a != shard_b ) return shard_a < shard_b;
+		return lookup_hashes[ a ] < lookup_hashes[ b ];
+	} );
+
+	Vector<uint32_t>	created;
+	Vector<uint32_t>	existing;
+	size_t group_begin			= 0;
+	while( group_begin < order.size() ) {
+		auto shard_index		= GetResourceShardIndex( lookup_hashes[ order[ group_begin ] ] );
+		auto & shard			= resource_shards[ shard_index ];
+		std::lock_guard<std::mutex> shard_guard( shard.mutex );
+
+		size_t group_end		= group_begin;
+		while( group_end < order.size() && GetResourceShardIndex( lookup_hashes[ order[ group_end ] ] ) == shard_index ) {
+			auto index			= order[ group_end ];
+			auto & request		= requests[ index ];
+			++group_end;
+
+			// resources created earlier in the batch are found here too, the same request is only created once
+			if( !( request.flags & DeviceResource::Flags::UNIQUE ) ) {
+				resources[ index ]	= RequestExistingResource( shard, lookup_hashes[ index ], request.type, request.file_resource_ids );
+				if( resources[ index ] ) {
+					existing.push_back( index );
+					continue;
 				}
 			}
+			resources[ index ]	= RequestNewResource( shard, lookup_hashes[ index ], request.type, request.flags );
+			if( resources[ index ] ) {
+				std::lock_guard<std::mutex> resource_guard( resources[ index ]->mutex );
+				resources[ index ]->state				= DeviceResource::State::LOADING_QUEUED;
+				resources[ index ]->load_priority		= request.priority;
+				// ids are set while the shard is locked so that other requests can match them
+				resources[ index ]->file_resource_ids	= request.file_resource_ids;
+				created.push_back( index );
+			}
 		}
+		group_begin				= group_end;
+	}
+	for( auto index : existing ) {
+		BumpResourcePriority( resources[ index ].Get(), requests[ index ].priority );
+	}
+
+	// file resources of all new resources are requested in one batch, priority may
+	// have been bumped by a later request in this batch so it's read from the resource
+	Vector<FileResourceManager::ResourceRequest> file_requests;
+	for( auto index : created ) {
+		auto resource		= resources[ index ].Get();
+		ResourcePriority priority;
 		{
-			// check if all file resources are already available, if yes, we start loading the resource immediately
-			// othervise we'll put the resource on a preload list where the resource will wait until all file resources become available
-			if( all_file_resources_loaded ) {
-				std::lock_guard<std::mutex>			load_list_guard( mutex_load_and_continue_load_list );
-				load_list.push_back( resource.Get() );
-				SignalWorkers_One();
-			} else {
-				std::lock_guard<std::mutex>			preload_list_guard( mutex_preload_list );
-				preload_list.push_back( resource.Get() );
+			std::lock_guard<std::mutex> resource_guard( resource->mutex );
+			priority		= resource->load_priority;
+		}
+		for( auto & id : requests[ index ].file_resource_ids ) {
+			file_requests.push_back( { id, priority } );
+		}
+	}
+	auto file_resources		= p_file_resource_manager->RequestResources( file_requests );
+
+	size_t file_resource_index		= 0;
+	bool waiting_finished			= false;
+	for( auto index : created ) {
+		auto resource		= resources[ index ].Get();
+		auto & file_resource_ids	= requests[ index ].file_resource_ids;
+		{
+			std::lock_guard<std::mutex> resource_guard( resource->mutex );
+			resource->file_resources.resize( file_resource_ids.size() );
+			for( size_t i=0; i < file_resource_ids.size(); ++i ) {
+				resource->file_resources[ i ]	= std::move( file_resources[ file_resource_index++ ] );
+				if( !resource->file_resources[ i ] ) {
+					p_logger->LogError( "Device Resource request failed, file resource not found: " + file_resource_ids[ i ].GetPath().string() );
+					assert( 0 && "Device Resource request failed, file resource not found" );
+				}
 			}
 		}
+		waiting_finished	|= WaitForFileResources( resource, false );
 	}
-	return resource;
+	if( waiting_finished ) {
+		SignalWorkers_One();
+		NotifyWorkDone();
+	}
+	return resources;
+}
+
+DeviceResourceHandle<DeviceResource> DeviceResourceManager::RequestResource( DeviceResource::Type resource_type, const Vector<Path> & file_resource_paths, DeviceResource::Flags resource_flags, ResourcePriority priority )
+{
+	if( !allow_resource_requests ) return nullptr;
+
+	Vector<AssetID> file_resource_ids;
+	file_resource_ids.reserve( file_resource_paths.size() );
+	for( auto & p : file_resource_paths ) {
+		file_resource_ids.push_back( AssetID( p ) );
+	}
+	return RequestResource( resource_type, file_resource_ids, resource_flags, priority );
 }
 
-DeviceResourceHandle<DeviceResource_Mesh> DeviceResourceManager::RequestResource_Mesh( const Vector<Path>& file_resource_paths, DeviceResource::Flags resource_flags )
+DeviceResourceHandle<DeviceResource_Mesh> DeviceResourceManager::RequestResource_Mesh( const Vector<AssetID>& file_resource_ids, DeviceResource::Flags resource_flags, ResourcePriority priority )
 {
-	return DeviceResourceHandle<DeviceResource_Mesh>( RequestResource( AE::DeviceResource::Type::MESH, file_resource_paths, resource_flags ) );
+	return DeviceResourceHandle<DeviceResource_Mesh>( RequestResource( AE::DeviceResource::Type::MESH, file_resource_ids, resource_flags, priority ) );
 }
 
-DeviceResourceHandle<DeviceResource_Image> DeviceResourceManager::RequestResource_Image( const Vector<Path>& file_resource_paths, DeviceResource::Flags resource_flags )
+DeviceResourceHandle<DeviceResource_Image> DeviceResourceManager::RequestResource_Image( const Vector<AssetID>& file_resource_ids, DeviceResource::Flags resource_flags, ResourcePriority priority )
 {
-	return DeviceResourceHandle<DeviceResource_Image>( RequestResource( AE::DeviceResource::Type::IMAGE, file_resource_paths, resource_flags ) );
+	return DeviceResourceHandle<DeviceResource_Image>( RequestResource( AE::DeviceResource::Type::IMAGE, file_resource_ids, resource_flags, priority ) );
 }
 
-DeviceResourceHandle<DeviceResource_GraphicsPipeline> DeviceResourceManager::RequestResource_GraphicsPipeline( const Vector<Path>& file_resource_paths, DeviceResource::Flags resource_flags )
+DeviceResourceHandle<DeviceResource_GraphicsPipeline> DeviceResourceManager::RequestResource_GraphicsPipeline( const Vector<AssetID>& file_resource_ids, DeviceResource::Flags resource_flags, ResourcePriority priority )
 {
-	return DeviceResourceHandle<DeviceResource_GraphicsPipeline>( RequestResource( AE::DeviceResource::Type::GRAPHICS_PIPELINE, file_resource_paths, resource_flags ) );
+	return DeviceResourceHandle<DeviceResource_GraphicsPipeline>( RequestResource( AE::DeviceResource::Type::GRAPHICS_PIPELINE, file_resource_ids, resource_flags, priority ) );
 }
 
 void DeviceResourceManager::SignalWorkers_One()
 {
-	worker_threads_wakeup.notify_one();
+	auto slot						= worker_jobs_next_slot++ % BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT;
+	worker_jobs_requested[ slot ]	= true;
+	ScheduleWorkerJob( slot );
 }
 
 void DeviceResourceManager::SignalWorkers_All()
 {
-	worker_threads_wakeup.notify_all();
-}
-
-void DeviceResourceManager::ParsePreloadList()
-{
-	std::lock_guard<std::mutex>		preload_list_guard( mutex_preload_list );
-	auto pl_it			= preload_list.begin();
-	while( pl_it != preload_list.end() ) {
-		bool file_resources_ready		= true;
-		for( auto & f : ( *pl_it )->file_resources ) {
-			// check each file resource within this device resource if they're ready
-			auto current_file_resource_state		= f->GetResourceState();
-			if( current_file_resource_state != FileResource::State::LOADED ) {
-				file_resources_ready	= false;
-				// check if an error happened
-				if( current_file_resource_state == FileResource::State::UNABLE_TO_LOAD ||
-					current_file_resource_state == FileResource::State::UNABLE_TO_LOAD_FILE_NOT_FOUND ) {
-					// if unable to load any of the file resources, we just remove this device resource from
-					// the preload_list, we hang on to the resource handle as usual until it's reference counter reaches 0
-					// ( already in resource_list )
-					{
-						LOCK_GUARD( ( *pl_it )->mutex );
-						// Assign a random worker thread id so that the resource gets destroyed and won't hang the program
-						( *pl_it )->locked_worker_thread_id		= worker_threads[ rand() % BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT ].get_id();
-						( *pl_it )->state						= DeviceResource::State::UNABLE_TO_LOAD;
-					}
-					pl_it										= preload_list.erase( pl_it );
-					// side effect: this skips the next resource on the list because
-					// pl_it practically gets incremented twice, not worth fixing though
-				}
-				break;
-			}
+	for( uint32_t i=0; i < BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT; ++i ) {
+		worker_jobs_requested[ i ]	= true;
+		ScheduleWorkerJob( i );
+	}
+}
+
+void DeviceResourceManager::ScheduleWorkerJob( uint32_t worker_slot )
+{
+	assert( worker_slot < BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT );
+	if( worker_jobs_should_exit ) return;
+	if( worker_jobs_running[ worker_slot ].exchange( true ) ) return;
+
+	p_job_system->SubmitToWorker( worker_slot, [ this, worker_slot ]() {
+		RunWorkerJob( worker_slot );
+	} );
+}
+
+void DeviceResourceManager::RunWorkerJob( uint32_t worker_slot )
+{
+	while( worker_jobs_requested[ worker_slot ].exchange( false ) ) {
+		DeviceWorkerJob( p_engine, this, worker_slot );
+	}
+	worker_jobs_running[ worker_slot ]	= false;
+	// work may have been requested after the last pass while this job was still marked as running
+	if( worker_jobs_requested[ worker_slot ] ) {
+		ScheduleWorkerJob( worker_slot );
+	}
+	NotifyWorkDone();
+}
+
+void DeviceResourceManager::NotifyWorkDone()
+{
+	// locking makes sure a waiter is either still before its check or already waiting, so no notification is missed
+	{
+		LOCK_GUARD( mutex_work_done );
+	}
+	work_done.notify_all();
+}
+
+void DeviceResourceManager::WaitUntil( std::function<bool()> is_done )
+{
+	while( true ) {
+		bool poll_fences	= HasPendingDeviceWork();
+		if( poll_fences ) {
+			SignalWorkers_All();
 		}
-		if( file_resources_ready ) {
-			std::lock_guard<std::mutex>		load_list_guard( mutex_load_and_continue_load_list );
-			load_list.push_back( *pl_it );
-			pl_it		= preload_list.erase( pl_it );
+		std::unique_lock<std::mutex> work_done_guard( mutex_work_done );
+		if( is_done() ) return;
+		if( poll_fences ) {
+			work_done.wait_for( work_done_guard, std::chrono::microseconds( BUILD_DEVICE_RESOURCE_MANAGER_FENCE_POLL_INTERVAL ) );
 		} else {
-			++pl_it;
+			work_done.wait( work_done_guard );
 		}
 	}
 }
 
+bool DeviceResourceManager::HasPendingDeviceWork()
+{
+	{
+		std::lock_guard<std::mutex> continue_load_list_guard( mutex_load_and_continue_load_list );
+		if( continue_load_list.size() ) return true;
+	}
+	{
+		std::lock_guard<std::mutex> continue_unload_list_guard( mutex_continue_unload_list );
+		if( continue_unload_list.size() ) return true;
+	}
+	return false;
+}
+
+bool DeviceResourceManager::WaitForFileResources( DeviceResource * resource, bool signal_workers )
+{
+	assert( nullptr != resource );
+	// one extra so that the resource isn't queued before all callbacks have been added
+	uint32_t file_resources_left	= 1;
+	for( auto & f : resource->file_resources ) {
+		if( f ) ++file_resources_left;
+	}
+	resource->file_resources_left	= file_resources_left;
+	++resources_waiting_for_files;
+
+	// the resource is queued for loading by the thread that finishes it's last file resource, usually a file
+	// resource worker job, or right here if all of them have already finished. Callbacks are added without the
+	// resource lock because they're called right away for finished file resources
+	for( auto & f : resource->file_resources ) {
+		if( f ) {
+			f->AddLoadFinishedCallback( [ this, resource ]() {
+				FileResourceFinished( resource, true );
+			} );
+		}
+	}
+	return FileResourceFinished( resource, signal_workers );
+}
+
+bool DeviceResourceManager::FileResourceFinished( DeviceResource * resource, bool signal_workers )
+{
+	assert( nullptr != resource );
+	// resource stays queued for loading until this, so it can't be unloaded while file resources are pending
+	if( --resource->file_resources_left != 0 ) return false;
+
+#if BUILD_INCLUDE_RESOURCE_STATISTICS
+	resource->profile_queued_time	= engine_internal::ResourceProfiler_Now();
+	engine_internal::ResourceProfiler_RecordTiming( resource->profile_kind, engine_internal::ResourceTiming::WAIT_FOR_DEPENDENCIES, resource->profile_queued_time - resource->profile_request_time );
+#endif
+
+	bool file_resources_loaded		= true;
+	for( auto & f : resource->file_resources ) {
+		if( !f || !f->IsResourceReadyForUse() ) {
+			file_resources_loaded	= false;
+			break;
+		}
+	}
+	if( file_resources_loaded ) {
+		std::lock_guard<std::mutex> load_list_guard( mutex_load_and_continue_load_list );
+		InsertToLoadList( resource );
+	} else {
+		// we hang on to the resource as usual until it's users drop to 0, it's locked onto
+		// one of the worker threads so that it gets destroyed and won't hang the program
+		resource->SetResourceState( DeviceResource::State::UNABLE_TO_LOAD );
+		{
+			// resources can't be queued for unloading before they have a worker thread, so it's
+			// given together with the users check and the resource is not touched after that
+			LOCK_GUARD( mutex_unload_queues );
+			resource->locked_worker_thread_id		= p_job_system->GetWorkerThreadID( worker_jobs_next_slot++ % BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT );
+			if( resource->users == 0 ) {
+				AddToUnloadQueue( resource );
+			}
+		}
+	}
+	// counted down only after the resource is on the load list so that pending load work is never missed
+	--resources_waiting_for_files;
+	if( signal_workers ) {
+		if( file_resources_loaded ) {
+			SignalWorkers_One();
+		}
+		NotifyWorkDone();
+	}
+	return true;
+}
+
 void DeviceResourceManager::Update()
 {
 	SignalWorkers_One();
-	ParsePreloadList();
 }
 
 bool DeviceResourceManager::HasPendingLoadWork()
@@ -527,11 +727,7 @@ bool DeviceResourceManager::HasPendingLoadWork()
 		if( load_list.size() ) return true;
 		if( continue_load_list.size() ) return true;
 	}
-	{
-		std::lock_guard<std::mutex> preload_list_guard( mutex_preload_list );
-		if( preload_list.size() ) return true;
-	}
-	return false;
+	return resources_waiting_for_files > 0;
 }
 
 bool DeviceResourceManager::HasPendingUnloadWork()
@@ -541,9 +737,9 @@ bool DeviceResourceManager::HasPendingUnloadWork()
 		if( continue_unload_list.size() ) return true;
 	}
 	{
-		std::lock_guard<std::mutex> resources_list_guard( mutex_resources_list );
-		for( auto & r : resources_list ) {
-			if( !r->GetResourceUsers() ) return true;
+		LOCK_GUARD( mutex_unload_queues );
+		for( auto & q : unload_queues ) {
+			if( q.size() ) return true;
 		}
 	}
 	return false;
@@ -551,58 +747,49 @@ bool DeviceResourceManager::HasPendingUnloadWork()
 
 bool DeviceResourceManager::IsIdle()
 {
-	for( auto & s : worker_threads_sleeping ) {
-		if( !s ) return false;
+	for( auto & r : worker_jobs_running ) {
+		if( r ) return false;
 	}
 	return true;
 }
 
 void DeviceResourceManager::WaitIdle()
 {
-	while( !IsIdle() ) {
-		std::this_thread::yield();
-	}
+	WaitUntil( [ this ]() {
+		return IsIdle();
+	} );
 }
 
 void DeviceResourceManager::WaitJobless()
 {
-	while( HasPendingLoadWork() || HasPendingUnloadWork() || !IsIdle() ) {
-		p_file_resource_manager->SignalWorkers_All();
-		ParsePreloadList();
-		SignalWorkers_All();
-		std::this_thread::yield();
-		std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
-	}
+	SignalWorkers_All();
+	WaitUntil( [ this ]() {
+		return !HasPendingLoadWork() && !HasPendingUnloadWork() && IsIdle();
+	} );
 }
 
 void DeviceResourceManager::WaitUntilNoLoadWork()
 {
-	while( HasPendingLoadWork() || !IsIdle() ) {
-		p_file_resource_manager->SignalWorkers_All();
-		ParsePreloadList();
-		SignalWorkers_All();
-		std::this_thread::yield();
-		std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
-	}
+	SignalWorkers_All();
+	WaitUntil( [ this ]() {
+		return !HasPendingLoadWork() && IsIdle();
+	} );
 }
 
 void DeviceResourceManager::WaitUntilNoUnloadWork()
 {
-	while( HasPendingUnloadWork() || !IsIdle() ) {
-		p_file_resource_manager->SignalWorkers_All();
-		SignalWorkers_All();
-		std::this_thread::yield();
-		std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
-	}
+	SignalWorkers_All();
+	WaitUntil( [ this ]() {
+		return !HasPendingUnloadWork() && IsIdle();
+	} );
 }
 
 uint32_t DeviceResourceManager::GetThisTreadResourceIndex()
 {
-	for( size_t i=0; i < worker_threads.size(); ++i ) {
-		const auto * const t	= &worker_threads[ i ];
-		if( t->get_id() == std::this_thread::get_id() ) {
-			return uint32_t( i );
-		}
+	// worker slots map directly to the first job system workers
+	auto worker_index	= JobSystem::GetThisThreadWorkerIndex();
+	if( worker_index < BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT ) {
+		return worker_index;
 	}
 	return UINT32_MAX;
 }
@@ -676,49 +863,40 @@ VkCommandPool DeviceResourceManager::GetPrimaryTransferCommandPoolForThisThread(
 void DeviceResourceManager::ScrapDeviceResources()
 {
 	// set all resources to have no users
-	{
-		std::lock_guard<std::mutex> lock_guard( mutex_resources_list );
-		for( auto & r : resources_list ) {
-			std::lock_guard<std::mutex> resource_guard( r->mutex );
-			r->users		= 0;
+	for( auto & shard : resource_shards ) {
+		std::lock_guard<std::mutex> lock_guard( shard.mutex );
+		for( auto & r : shard.resources ) {
+			{
+				std::lock_guard<std::mutex> resource_guard( r.second->mutex );
+				r.second->users		= 0;
+			}
+			QueueForUnload( r.second.Get() );
 		}
 	}
 
 	// wait until all resources have been destroyed
-	uint32_t resource_count = UINT32_MAX;
-	while( resource_count ) {
-		SignalWorkers_All();
-		std::this_thread::yield();
-		std::this_thread::sleep_for( std::chrono::milliseconds( 150 ) );
-		{
-			std::lock_guard<std::mutex> lock_guard( mutex_resources_list );
-			resource_count	= uint32_t( resources_list.size() );
+	SignalWorkers_All();
+	WaitUntil( [ this ]() {
+		for( auto & shard : resource_shards ) {
+			std::lock_guard<std::mutex> lock_guard( shard.mutex );
+			if( shard.resources.size() ) return false;
 		}
-		{
-			std::lock_guard<std::mutex> lock_guard( mutex_continue_unload_list );
-			resource_count	+= uint32_t( continue_unload_list.size() );
-		}
-	}
+		std::lock_guard<std::mutex> lock_guard( mutex_continue_unload_list );
+		return !continue_unload_list.size();
+	} );
 }
 
-DeviceResourceHandle<DeviceResource> DeviceResourceManager::RequestExistingResource( DeviceResource::Type resource_type, const Vector<Path> & file_resource_paths, DeviceResource::Flags resource_flags )
+DeviceResourceHandle<DeviceResource> DeviceResourceManager::RequestExistingResource( ResourceShard & shard, uint64_t lookup_hash, DeviceResource::Type resource_type, const Vector<AssetID> & file_resource_ids )
 {
-	for( auto & r : resources_list ) {
-		bool found_suitable = true;
+	auto range = shard.resources.equal_range( lookup_hash );
+	for( auto it = range.first; it != range.second; ++it ) {
+		auto & r			= it->second;
+		bool found_suitable = false;
 		{
 			std::lock_guard<std::mutex> resource_guard( r->mutex );
-			if( ( r->type == resource_type ) &&
+			found_suitable	= ( r->type == resource_type ) &&
 				!( r->flags & DeviceResource::Flags::UNIQUE ) &&
-				( r->file_resources.size() == file_resource_paths.size() ) ) {
-				for( size_t i=0; i < file_resource_paths.size(); ++i ) {
-					if( r->file_resources[ i ]->GetPath() != file_resource_paths[ i ] ) {
-						found_suitable		= false;
-						break;
-					}
-				} 
-			} else {
-				found_suitable				= false;
-			}
+				( r->file_resource_ids == file_resource_ids );
 		}
 		if( found_suitable ) {
 			// found compatible resource
@@ -728,14 +906,128 @@ DeviceResourceHandle<DeviceResource> DeviceResourceManager::RequestExistingResou
 	return nullptr;
 };
 
-DeviceResourceHandle<DeviceResource> DeviceResourceManager::RequestNewResource( DeviceResource::Type resource_type, DeviceResource::Flags resource_flags )
+uint64_t DeviceResourceManager::HashResourceKey( DeviceResource::Type resource_type, const Vector<AssetID> & file_resource_ids )
+{
+	// FNV-1a over the type and file resource ids
+	uint64_t hash			= 14695981039346656037ULL;
+	auto HashValue = [ &hash ]( uint64_t value ) {
+		for( uint32_t i=0; i < sizeof( value ); ++i ) {
+			hash			^= ( value >> ( i * 8 ) ) & 0xFF;
+			hash			*= 1099511628211ULL;
+		}
+	};
+	HashValue( uint64_t( resource_type ) );
+	for( auto & id : file_resource_ids ) {
+		HashValue( id.GetValue() );
+	}
+	return hash;
+}
+
+DeviceResourceManager::ResourceShard & DeviceResourceManager::GetResourceShard( uint64_t lookup_hash )
+{
+	return resource_shards[ GetResourceShardIndex( lookup_hash ) ];
+}
+
+uint32_t DeviceResourceManager::GetResourceShardIndex( uint64_t lookup_hash )
+{
+	return uint32_t( lookup_hash % BUILD_RESOURCE_MANAGER_LOOKUP_SHARD_COUNT );
+}
+
+void DeviceResourceManager::InsertToLoadList( DeviceResource * resource )
+{
+	// insert after every resource with the same or higher priority so equal priorities load in request order
+	auto it = load_list.rbegin();
+	while( it != load_list.rend() && uint32_t( ( *it )->load_priority ) < uint32_t( resource->load_priority ) ) {
+		++it;
+	}
+	load_list.insert( it.base(), resource );
+}
+
+void DeviceResourceManager::BumpResourcePriority( DeviceResource * resource, ResourcePriority priority )
+{
+	assert( nullptr != resource );
+	{
+		std::lock_guard<std::mutex> resource_guard( resource->mutex );
+		if( uint32_t( priority ) <= uint32_t( resource->load_priority ) ) return;
+		resource->load_priority		= priority;
+		for( auto & f : resource->file_resources ) {
+			if( f ) p_file_resource_manager->BumpResourcePriority( f.Get(), priority );
+		}
+	}
+	std::lock_guard<std::mutex> load_list_guard( mutex_load_and_continue_load_list );
+	auto it = std::find( load_list.begin(), load_list.end(), resource );
+	if( it != load_list.end() ) {
+		load_list.erase( it );
+		InsertToLoadList( resource );
+	}
+}
+
+void DeviceResourceManager::QueueForUnload( DeviceResource * resource )
+{
+	assert( nullptr != resource );
+	LOCK_GUARD( mutex_unload_queues );
+	if( resource->users == 0 ) {
+		AddToUnloadQueue( resource );
+	}
+}
+
+uint32_t DeviceResourceManager::DecrementUsers( DeviceResource * resource )
+{
+	assert( nullptr != resource );
+	LOCK_GUARD( mutex_unload_queues );
+	auto previous_users	= resource->users.fetch_sub( 1, std::memory_order_acq_rel );
+	assert( previous_users > 0 );
+	if( previous_users == 1 ) {
+		AddToUnloadQueue( resource );
+	}
+	return previous_users - 1;
+}
+
+void DeviceResourceManager::AddToUnloadQueue( DeviceResource * resource )
+{
+	if( resource->in_unload_queue ) return;
+
+	// resource is unloaded with the same thread that loaded it
+	auto thread_index		= GetWorkerThreadIndex( resource->GetWorkerThreadID() );
+	if( thread_index == UINT32_MAX ) return;
+
+	auto & unload_queue					= unload_queues[ thread_index ];
+	resource->in_unload_queue			= true;
+	resource->unload_queue_index		= thread_index;
+	resource->unload_queue_position		= unload_queue.insert( unload_queue.end(), resource );
+	// only the worker slot that loaded the resource can unload it
+	worker_jobs_requested[ thread_index ]	= true;
+	ScheduleWorkerJob( thread_index );
+}
+
+void DeviceResourceManager::RemoveFromUnloadQueue( DeviceResource * resource )
+{
+	if( resource->in_unload_queue ) {
+		unload_queues[ resource->unload_queue_index ].erase( resource->unload_queue_position );
+		resource->in_unload_queue			= false;
+		resource->unload_queue_index		= UINT32_MAX;
+	}
+}
+
+uint32_t DeviceResourceManager::GetWorkerThreadIndex( std::thread::id thread_id )
+{
+	for( uint32_t i=0; i < BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT; ++i ) {
+		if( p_job_system->GetWorkerThreadID( i ) == thread_id ) {
+			return i;
+		}
+	}
+	return UINT32_MAX;
+}
+
+DeviceResourceHandle<DeviceResource> DeviceResourceManager::RequestNewResource( ResourceShard & shard, uint64_t lookup_hash, DeviceResource::Type resource_type, DeviceResource::Flags resource_flags )
 {
 	DeviceResourceHandle<DeviceResource>	resource	= nullptr;
 	auto resource_unique	= CreateResource( resource_type, resource_flags );
 	assert( resource_unique );
 	if( resource_unique ) {
 		resource			= DeviceResourceHandle<DeviceResource>( resource_unique.Get() );
-		resources_list.push_back( std::move( resource_unique ) );
+		resource_unique->lookup_hash	= lookup_hash;
+		shard.resources.insert( std::pair<uint64_t, UniquePointer<DeviceResource>>( lookup_hash, std::move( resource_unique ) ) );
 	}
 	return resource;
 }
@@ -7,6 +7,8 @@
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <functional>
+#include <condition_variable>
 
 #include "../DeviceMemory/DeviceMemoryInfo.h"
 #include "../DeviceResource/DeviceResource.h"
@@ -19,6 +21,7 @@ namespace AE
 
 class Engine;
 class Logger;
+class JobSystem;
 class Renderer;
 class DeviceMemoryManager;
 class DeviceResource;
@@ -32,32 +35,48 @@ class DeviceResourceManager
 {
 	friend class Engine;
 	friend class DeviceResource;
-	friend void DeviceWorkerThread( Engine * engine, DeviceResourceManager * device_resource_manager, std::atomic_bool * thread_sleeping );
+	friend void DeviceWorkerJob( Engine * engine, DeviceResourceManager * device_resource_manager, uint32_t worker_slot );
 
 public:
+	struct ResourceRequest
+	{
+		DeviceResource::Type					type;
+		Vector<AssetID>							file_resource_ids;
+		DeviceResource::Flags					flags						= DeviceResource::Flags( 0 );
+		ResourcePriority						priority					= ResourcePriority::NORMAL;
+	};
+
 	DeviceResourceManager( Engine * engine, Renderer * renderer, DeviceMemoryManager * device_memory_manager );
 	~DeviceResourceManager();
 
-	DeviceResourceHandle<DeviceResource>		RequestResource( DeviceResource::Type resource_type, const Vector<Path> & file_resource_paths, DeviceResource::Flags resource_flags = DeviceResource::Flags( 0 ) );
+	// priority is passed on to the file resources, requesting an existing resource with a higher priority bumps its priority
+	DeviceResourceHandle<DeviceResource>		RequestResource( DeviceResource::Type resource_type, const Vector<AssetID> & file_resource_ids, DeviceResource::Flags resource_flags = DeviceResource::Flags( 0 ), ResourcePriority priority = ResourcePriority::NORMAL );
+	// interns the paths first, prefer keeping the asset ids when requesting the same resource often
+	DeviceResourceHandle<DeviceResource>		RequestResource( DeviceResource::Type resource_type, const Vector<Path> & file_resource_paths, DeviceResource::Flags resource_flags = DeviceResource::Flags( 0 ), ResourcePriority priority = ResourcePriority::NORMAL );
+
+	// requests many resources at once, handles are returned in request order
+	// each lookup shard is locked once for the whole batch, equal requests share one resource unless they're unique,
+	// file resources of all new resources are requested as one batch and workers are signaled once
+	Vector<DeviceResourceHandle<DeviceResource>>	RequestResources( const Vector<ResourceRequest> & requests );
 
 	// 2: Add device resource specialized request functions here
-	DeviceResourceHandle<DeviceResource_Mesh>					RequestResource_Mesh( const Vector<Path> & file_resource_paths, DeviceResource::Flags resource_flags = DeviceResource::Flags( 0 ) );
-	DeviceResourceHandle<DeviceResource_Image>					RequestResource_Image( const Vector<Path> & file_resource_paths, DeviceResource::Flags resource_flags = DeviceResource::Flags( 0 ) );
-	DeviceResourceHandle<DeviceResource_GraphicsPipeline>		RequestResource_GraphicsPipeline( const Vector<Path> & file_resource_paths, DeviceResource::Flags resource_flags = DeviceResource::Flags( 0 ) );
+	DeviceResourceHandle<DeviceResource_Mesh>					RequestResource_Mesh( const Vector<AssetID> & file_resource_ids, DeviceResource::Flags resource_flags = DeviceResource::Flags( 0 ), ResourcePriority priority = ResourcePriority::NORMAL );
+	DeviceResourceHandle<DeviceResource_Image>					RequestResource_Image( const Vector<AssetID> & file_resource_ids, DeviceResource::Flags resource_flags = DeviceResource::Flags( 0 ), ResourcePriority priority = ResourcePriority::NORMAL );
+	DeviceResourceHandle<DeviceResource_GraphicsPipeline>		RequestResource_GraphicsPipeline( const Vector<AssetID> & file_resource_ids, DeviceResource::Flags resource_flags = DeviceResource::Flags( 0 ), ResourcePriority priority = ResourcePriority::NORMAL );
 
 	void										SignalWorkers_One();
 	void										SignalWorkers_All();
 
-	void										ParsePreloadList();
 	void										Update();					// general update of the resource manager, should be called once in every frame
-	bool										HasPendingLoadWork();		// fast, just checks the size of a load list
-	bool										HasPendingUnloadWork();		// relatively slow, loops through every resource in memory
-	bool										IsIdle();					// tells if the worker threads are idle, fast but doesn't tell if there's pending work
+	bool										HasPendingLoadWork();		// fast, just checks the sizes of the load lists and the count of resources waiting for file resources
+	bool										HasPendingUnloadWork();		// fast, just checks the sizes of the unload queues
+	bool										IsIdle();					// tells if no worker jobs are running, fast but doesn't tell if there's pending work
 	void										WaitIdle();					// pauses the excecution of the calling thread until resource manager becomes idle, can be used in realtime but not preferred
-	void										WaitJobless();				// pauses the excecution of the calling thread until resource manager is completely without work and worker threads become idle, NO REALTIME USE
-	void										WaitUntilNoLoadWork();		// pauses the excecution of the calling thread until all pending resources have been loaded and worker threads become idle, NO REALTIME USE
-	void										WaitUntilNoUnloadWork();	// pauses the excecution of the calling thread until all pending resources have been unloaded and worker threads become idle, NO REALTIME USE
+	void										WaitJobless();				// pauses the excecution of the calling thread until resource manager is completely without work and worker jobs have finished, NO REALTIME USE
+	void										WaitUntilNoLoadWork();		// pauses the excecution of the calling thread until all pending resources have been loaded and worker jobs have finished, NO REALTIME USE
+	void										WaitUntilNoUnloadWork();	// pauses the excecution of the calling thread until all pending resources have been unloaded and worker jobs have finished, NO REALTIME USE
 
+	// worker slot of the calling thread, UINT32_MAX if the thread doesn't run device resource worker jobs
 	uint32_t									GetThisTreadResourceIndex();
 
 	void										AllowResourceRequests( bool allow );
@@ -71,16 +90,67 @@ public:
 private:
 	void										ScrapDeviceResources();
 
-	DeviceResourceHandle<DeviceResource>		RequestExistingResource( DeviceResource::Type resource_type, const Vector<Path> & file_resource_paths, DeviceResource::Flags resource_flags );
-	DeviceResourceHandle<DeviceResource>		RequestNewResource( DeviceResource::Type resource_type, DeviceResource::Flags resource_flags );
+	// resources are stored by a hash of their type and file resource ids, each shard has its own
+	// mutex so that requests for different resources rarely contend on the same lock
+	struct ResourceShard
+	{
+		Mutex													mutex;
+		UnorderedMultiMap<uint64_t, UniquePointer<DeviceResource>>	resources;
+	};
+
+	static uint64_t								HashResourceKey( DeviceResource::Type resource_type, const Vector<AssetID> & file_resource_ids );
+	ResourceShard							&	GetResourceShard( uint64_t lookup_hash );
+	static uint32_t								GetResourceShardIndex( uint64_t lookup_hash );
+
+	// shard mutex must be locked when calling these
+	DeviceResourceHandle<DeviceResource>		RequestExistingResource( ResourceShard & shard, uint64_t lookup_hash, DeviceResource::Type resource_type, const Vector<AssetID> & file_resource_ids );
+	DeviceResourceHandle<DeviceResource>		RequestNewResource( ResourceShard & shard, uint64_t lookup_hash, DeviceResource::Type resource_type, DeviceResource::Flags resource_flags );
 
 	UniquePointer<DeviceResource>				CreateResource( DeviceResource::Type resource_type, DeviceResource::Flags resource_flags );
 
+	// load list is kept in priority order, mutex_load_and_continue_load_list must be locked when calling this
+	void										InsertToLoadList( DeviceResource * resource );
+	// raises the priority of the resource and its file resources, lower priorities are ignored
+	void										BumpResourcePriority( DeviceResource * resource, ResourcePriority priority );
+
+	// queues a resource with no users for unloading on the worker thread it was loaded with, resources are checked
+	// again before unloading because they may have been requested again while waiting in the queue
+	// resources that haven't been loaded by any worker thread yet are queued once their loading finishes
+	void										QueueForUnload( DeviceResource * resource );
+	// releases a user of a resource and queues it for unloading if it was the last one, both are done while
+	// mutex_unload_queues is locked so that the resource can't be unloaded before it's users are released
+	uint32_t									DecrementUsers( DeviceResource * resource );
+	// mutex_unload_queues must be locked when calling these
+	void										AddToUnloadQueue( DeviceResource * resource );
+	void										RemoveFromUnloadQueue( DeviceResource * resource );
+	uint32_t									GetWorkerThreadIndex( std::thread::id thread_id );
+
+	// worker slots are pinned to the first job system workers because resources keep using the
+	// command pools and the thread they were loaded with, one job per slot runs at a time
+	void										ScheduleWorkerJob( uint32_t worker_slot );
+	// runs worker passes for as long as they're requested, body of every worker job
+	void										RunWorkerJob( uint32_t worker_slot );
+	// wakes up threads blocked in the wait functions so they can check their condition again
+	void										NotifyWorkDone();
+	// blocks the calling thread until is_done returns true, condition is checked every time a worker job
+	// finishes or a resource stops waiting for it's file resources
+	void										WaitUntil( std::function<bool()> is_done );
+	// resources waiting for the device to finish their command buffers
+	bool										HasPendingDeviceWork();
+	// registers a new resource on it's file resources once they have been requested, returns true if
+	// all of them had already finished, signal_workers false leaves signaling to the caller in that case
+	bool										WaitForFileResources( DeviceResource * resource, bool signal_workers );
+	// load finished callback of the file resources of a device resource, the last one to finish
+	// queues the device resource for loading, or marks it unable to load if any of them failed
+	// returns true if this call was the last one
+	bool										FileResourceFinished( DeviceResource * resource, bool signal_workers );
+
 	Engine									*	p_engine					= nullptr;
 	Logger									*	p_logger					= nullptr;
 	Renderer								*	p_renderer					= nullptr;
 	DeviceMemoryManager						*	p_device_memory_manager		= nullptr;
 	FileResourceManager						*	p_file_resource_manager		= nullptr;
+	JobSystem								*	p_job_system				= nullptr;
 
 	VkInstance									ref_vk_instance				= VK_NULL_HANDLE;
 	VkPhysicalDevice							ref_vk_physical_device		= VK_NULL_HANDLE;
@@ -91,25 +161,28 @@ private:
 	uint32_t									primary_transfer_queue_family_index		= UINT32_MAX;
 	VkBool32									queue_families_are_same					= VK_FALSE;
 
-	std::condition_variable						worker_threads_wakeup;
-	Mutex										worker_threads_wakeup_mutex;
-	std::atomic_bool							worker_threads_should_exit;
+	std::atomic_bool							worker_jobs_should_exit		{ false };
+	std::atomic<uint32_t>						worker_jobs_next_slot		{ 0 };
+	Mutex										mutex_work_done;
+	std::condition_variable						work_done;
 	Array<VkCommandPool, BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT>				vk_thread_command_pools_primary_render;
 	Array<VkCommandPool, BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT>				vk_thread_command_pools_secondary_render;
 	Array<VkCommandPool, BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT>				vk_thread_command_pools_primary_transfer;
-	Array<std::atomic_bool, BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT>			worker_threads_sleeping;
-	Array<std::thread, BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT>				worker_threads;
+	Array<std::atomic_bool, BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT>			worker_jobs_running;
+	Array<std::atomic_bool, BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT>			worker_jobs_requested;
 
-	Mutex										mutex_resources_list;
-	Mutex										mutex_preload_list;
 	Mutex										mutex_load_and_continue_load_list;
 	Mutex										mutex_continue_unload_list;
+	Mutex										mutex_unload_queues;
 
-	List<UniquePointer<DeviceResource>>			resources_list;
-	List<DeviceResource*>						preload_list;
+	Array<ResourceShard, BUILD_RESOURCE_MANAGER_LOOKUP_SHARD_COUNT>						resource_shards;
 	List<DeviceResource*>						load_list;
 	List<DeviceResource*>						continue_load_list;
 	List<UniquePointer<DeviceResource>>			continue_unload_list;
+	Array<List<DeviceResource*>, BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT>		unload_queues;
+
+	// requested device resources that are still waiting for their file resources to finish
+	std::atomic<uint32_t>						resources_waiting_for_files	{ 0 };
 
 	std::atomic_bool							allow_resource_requests;
 	std::atomic_bool							allow_resource_loading;
@@ -31,6 +31,11 @@ VkPipeline DeviceResource_GraphicsPipeline::GetVulkanPipeline() const
 	return vk_pipeline;
 }
 
+VertexFormat DeviceResource_GraphicsPipeline::GetVertexFormat() const
+{
+	return vertex_format;
+}
+
 bool ContinueGraphicsPipelineLoadTest_1( DeviceResource * resource )
 {
 	auto res			= static_cast<DeviceResource_GraphicsPipeline*>( resource );
@@ -230,51 +235,59 @@ DeviceResource::LoadingState ContinueGraphicsPipelineLoad_1( DeviceResource * re
 	}
 
 
-	// vertex input state, currently this data does not change so we might as well dump
-	// all of this somewhere else and just reference that, but keeping it here for now as
-	// I'm not sure if I will do more ways to input vertices to the pipeline in the future
+	// vertex input state, vertex format is selected per pipeline, both formats feed the same
+	// shader inputs, compact vertices are normalized to floats by the vertex input
 	Vector<VkVertexInputBindingDescription> vertex_binding_descriptions;
 	Vector<VkVertexInputAttributeDescription> vertex_attribute_descriptions;
 	VkPipelineVertexInputStateCreateInfo vertex_input_state_CI {};
 	{
+		auto xml_vertex_input		= xml_root->FirstChildElement( "VERTEX_INPUT" );
+		auto vertex_format_str		= xml_file->GetFieldValue_Text( xml_vertex_input, "vertex_format", "" );
+		res->vertex_format			= VertexFormat::FLOAT;
+		if( vertex_format_str.size() ) {
+			if( vertex_format_str == "FLOAT" )				res->vertex_format = VertexFormat::FLOAT;
+			else if( vertex_format_str == "COMPACT" )		res->vertex_format = VertexFormat::COMPACT;
+			else {
+				res->p_logger->LogWarning( String( "Graphics pipeline xml file: " ) + xml_file->GetPath().string().c_str() + " unknown <VERTEX_INPUT> vertex_format, fallback to FLOAT" );
+			}
+		}
+
+		struct AttributeInfo
+		{
+			VkFormat		format;
+			uint32_t		offset;
+		};
+		Array<AttributeInfo, 4>		attributes;
+		uint32_t					stride		= 0;
+		if( res->vertex_format == VertexFormat::COMPACT ) {
+			stride			= sizeof( VertexCompact );
+			// 4 component position, 4th component is the material and not used by the shader
+			attributes[ 0 ]	= { VK_FORMAT_R16G16B16A16_SNORM,	uint32_t( offsetof( VertexCompact, position ) ) };
+			attributes[ 1 ]	= { VK_FORMAT_R16G16B16A16_SNORM,	uint32_t( offsetof( VertexCompact, normal ) ) };
+			attributes[ 2 ]	= { VK_FORMAT_R16G16_SNORM,			uint32_t( offsetof( VertexCompact, uv ) ) };
+			attributes[ 3 ]	= { VK_FORMAT_R16_SINT,				uint32_t( offsetof( VertexCompact, material ) ) };
+		} else {
+			stride			= sizeof( Vertex );
+			attributes[ 0 ]	= { VK_FORMAT_R32G32B32_SFLOAT,		uint32_t( offsetof( Vertex, position ) ) };
+			attributes[ 1 ]	= { VK_FORMAT_R32G32B32_SFLOAT,		uint32_t( offsetof( Vertex, normal ) ) };
+			attributes[ 2 ]	= { VK_FORMAT_R32G32_SFLOAT,		uint32_t( offsetof( Vertex, uv ) ) };
+			attributes[ 3 ]	= { VK_FORMAT_R32_SINT,				uint32_t( offsetof( Vertex, material ) ) };
+		}
+
 		{
 			vertex_binding_descriptions.push_back( {} );
 			auto & binding_desc		= vertex_binding_descriptions.back();
 			binding_desc.binding	= 0;
-			binding_desc.stride		= sizeof( Vertex );
+			binding_desc.stride		= stride;
 			binding_desc.inputRate	= VK_VERTEX_INPUT_RATE_VERTEX;
 		}
-		{
-			vertex_attribute_descriptions.push_back( {} );
-			auto & attribute_desc	= vertex_attribute_descriptions.back();
-			attribute_desc.location	= 0;
-			attribute_desc.binding	= 0;
-			attribute_desc.format	= VK_FORMAT_R32G32B32_SFLOAT;
-			attribute_desc.offset	= offsetof( Vertex, position );
-		}
-		{
-			vertex_attribute_descriptions.push_back( {} );
-			auto & attribute_desc	= vertex_attribute_descriptions.back();
-			attribute_desc.location	= 1;
-			attribute_desc.binding	= 0;
-			attribute_desc.format	= VK_FORMAT_R32G32B32_SFLOAT;
-			attribute_desc.offset	= offsetof( Vertex, normal );
-		}
-		{
-			vertex_attribute_descriptions.push_back( {} );
-			auto & attribute_desc	= vertex_attribute_descriptions.back();
-			attribute_desc.location	= 2;
-			attribute_desc.binding	= 0;
-			attribute_desc.format	= VK_FORMAT_R32G32_SFLOAT;
-			attribute_desc.offset	= offsetof( Vertex, uv );
-		}
-		{
+		for( uint32_t i=0; i < uint32_t( attributes.size() ); ++i ) {
 			vertex_attribute_descriptions.push_back( {} );
 			auto & attribute_desc	= vertex_attribute_descriptions.back();
-			attribute_desc.location	= 3;
+			attribute_desc.location	= i;
 			attribute_desc.binding	= 0;
-			attribute_desc.format	= VK_FORMAT_R32_SINT;
-			attribute_desc.offset	= offsetof( Vertex, material );
+			attribute_desc.format	= attributes[ i ].format;
+			attribute_desc.offset	= attributes[ i ].offset;
 		}
 		vertex_input_state_CI.sType								= VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 		vertex_input_state_CI.pNext								= nullptr;
@@ -720,6 +733,7 @@ DeviceResource::UnloadingState DeviceResource_GraphicsPipeline::Unload()
 	fragment_shader_resource					= nullptr;
 
 	image_count									= 0;
+	vertex_format								= VertexFormat::FLOAT;
 	dynamic_states.clear();
 	return UnloadingState::UNLOADED;
 }
@@ -4,6 +4,7 @@
 #include "../../../Platform.h"
 
 #include "../DeviceResource.h"
+#include "../../../FileResource/Mesh/MeshInfo.h"
 
 namespace AE
 {
@@ -21,6 +22,7 @@ public:
 
 	uint32_t									GetImageCount() const;
 	VkPipeline									GetVulkanPipeline() const;
+	VertexFormat								GetVertexFormat() const;
 
 private:
 	LoadingState								Load();
@@ -43,6 +45,9 @@ private:
 	// this is the amount of images the pipeline uses in the shaders
 	uint32_t									image_count									= 0;
 
+	// vertex layout the pipeline reads, meshes drawn with this pipeline must be stored in the same format
+	VertexFormat								vertex_format								= VertexFormat::FLOAT;
+
 	Vector<VkDynamicState>						dynamic_states;
 };
 
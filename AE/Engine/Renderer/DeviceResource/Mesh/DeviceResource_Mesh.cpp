@@ -80,10 +80,13 @@ DeviceResource::LoadingState DeviceResource_Mesh::Load()
 		return DeviceResource::LoadingState::UNABLE_TO_LOAD;
 	}
 
+	auto & mesh_data				= p_file_mesh_resource->GetMeshData();
+	// cooked meshes point straight into the mapped file, it's copied into the staging buffer only once
+	auto device_block				= mesh_data.GetDeviceBlock();
+
 	TODO( "This is an estimate and might be wrong, Create dummy buffers in the beginning of the application to check the real memory requirements for index and vertex buffers" );
 	auto reserve_byte_size =
-		p_file_mesh_resource->GetVerticesByteSize() +
-		p_file_mesh_resource->GetPolygonsByteSize() +
+		device_block.size() +
 		p_renderer->GetPhysicalDeviceLimits().minUniformBufferOffsetAlignment * 2;
 
 	// create all buffers, both indices and vertices are in one buffer
@@ -100,6 +103,10 @@ DeviceResource::LoadingState DeviceResource_Mesh::Load()
 			total_byte_size		= buffer_memory_requirements.size;
 			index_offset		= 0;
 			vertex_offset		= uint32_t( RoundToAlignment( p_file_mesh_resource->GetPolygonsByteSize(), buffer_memory_requirements.alignment ) );
+			// device block of the mesh is copied as is when it's vertex offset is aligned for this device
+			if( mesh_data.index_offset == 0 && mesh_data.vertex_offset % buffer_memory_requirements.alignment == 0 ) {
+				vertex_offset	= mesh_data.vertex_offset;
+			}
 		}
 		staging_buffer_memory	= p_device_memory_manager->AllocateAndBindBufferMemory( vk_staging_buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT );
 		buffer_memory			= p_device_memory_manager->AllocateAndBindBufferMemory( vk_buffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT );
@@ -121,8 +128,12 @@ DeviceResource::LoadingState DeviceResource_Mesh::Load()
 		}
 		assert( nullptr != data );
 		if( nullptr != data ) {
-			std::memcpy( data + index_offset, p_file_mesh_resource->GetPolygons().data(), GetPolygonsByteSize() );
-			std::memcpy( data + vertex_offset, p_file_mesh_resource->GetVertices().data(), GetVerticesByteSize() );
+			if( index_offset == mesh_data.index_offset && vertex_offset == mesh_data.vertex_offset ) {
+				std::memcpy( data, device_block.data(), device_block.size() );
+			} else {
+				std::memcpy( data + index_offset, p_file_mesh_resource->GetPolygons().data(), GetPolygonsByteSize() );
+				std::memcpy( data + vertex_offset, device_block.data() + mesh_data.vertex_offset, GetVerticesByteSize() );
+			}
 			{
 				LOCK_GUARD( *ref_vk_device.mutex );
 				vkUnmapMemory( ref_vk_device.object, staging_buffer_memory.memory );
@@ -457,17 +468,22 @@ DeviceResource::UnloadingState DeviceResource_Mesh::Unload()
 	return DeviceResource::UnloadingState::UNLOADED;
 }
 
-const Vector<Vertex>& DeviceResource_Mesh::GetVertices() const
+ArrayView<const Vertex> DeviceResource_Mesh::GetVertices() const
 {
 	return p_file_mesh_resource->GetVertices();
 }
 
+ArrayView<const VertexCompact> DeviceResource_Mesh::GetCompactVertices() const
+{
+	return p_file_mesh_resource->GetCompactVertices();
+}
+
 const Vector<CopyVertex>& DeviceResource_Mesh::GetCopyVertices() const
 {
 	return p_file_mesh_resource->GetCopyVertices();
 }
 
-const Vector<Polygon>& DeviceResource_Mesh::GetPolygons() const
+ArrayView<const Polygon> DeviceResource_Mesh::GetPolygons() const
 {
 	return p_file_mesh_resource->GetPolygons();
 }
@@ -510,6 +526,18 @@ Vector<Polygon>& DeviceResource_Mesh::GetEditablePolygons()
 }
 */
 
+VertexFormat DeviceResource_Mesh::GetVertexFormat() const
+{
+	return p_file_mesh_resource->GetVertexFormat();
+}
+
+Mat4 DeviceResource_Mesh::GetPositionTransform() const
+{
+	auto & mesh_data		= p_file_mesh_resource->GetMeshData();
+	auto transform			= glm::translate( Mat4( 1 ), Vec3( mesh_data.position_offset ) );
+	return glm::scale( transform, Vec3( mesh_data.position_scale ) );
+}
+
 size_t DeviceResource_Mesh::GetVerticesByteSize() const
 {
 	return p_file_mesh_resource->GetVerticesByteSize();
@@ -525,7 +553,7 @@ size_t DeviceResource_Mesh::GetPolygonsByteSize() const
 	return p_file_mesh_resource->GetPolygonsByteSize();
 }
 
-void DeviceResource_Mesh::UpdateVulkanBuffer_Index( const Vector<Polygon>& polygons )
+void DeviceResource_Mesh::UpdateVulkanBuffer_Index( ArrayView<const Polygon> polygons )
 {
 	if( GetResourceFlags() & Flags::STATIC ) return;	// We shouldn't update a static device resource, it's already in memory anyways
 
@@ -553,7 +581,7 @@ void DeviceResource_Mesh::UpdateVulkanBuffer_Index( const Vector<Polygon>& polyg
 	}
 }
 
-void DeviceResource_Mesh::UpdateVulkanBuffer_Vertex( const Vector<Vertex>& vertices )
+void DeviceResource_Mesh::UpdateVulkanBuffer_Vertex( ArrayView<const Vertex> vertices )
 {
 	if( GetResourceFlags() & Flags::STATIC ) return;	// We shouldn't update a static device resource, it's already in memory anyways
 
@@ -581,6 +609,34 @@ void DeviceResource_Mesh::UpdateVulkanBuffer_Vertex( const Vector<Vertex>& verti
 	}
 }
 
+void DeviceResource_Mesh::UpdateVulkanBuffer_Vertex( ArrayView<const VertexCompact> vertices )
+{
+	if( GetResourceFlags() & Flags::STATIC ) return;	// We shouldn't update a static device resource, it's already in memory anyways
+
+	if( vertices.size() != p_file_mesh_resource->GetCompactVertices().size() ) {
+		p_logger->LogWarning( "Tried updating mesh vertex data from differently sized array than what is currently in memory" );
+		assert( 0 );
+	}
+
+	{
+		char * data;
+		{
+			LOCK_GUARD( *ref_vk_device.mutex );
+			VulkanResultCheck( vkMapMemory( ref_vk_device.object, staging_buffer_memory.memory, staging_buffer_memory.offset, staging_buffer_memory.size, 0, (void**)&data ) );
+		}
+		assert( nullptr != data );
+		if( nullptr != data ) {
+			std::memcpy( data + vertex_offset, vertices.data(), GetVerticesByteSize() );
+			{
+				LOCK_GUARD( *ref_vk_device.mutex );
+				vkUnmapMemory( ref_vk_device.object, staging_buffer_memory.memory );
+			}
+		} else {
+			assert( 0 && "Can't map staging buffer memory" );
+		}
+	}
+}
+
 void DeviceResource_Mesh::RecordVulkanCommand_TransferToPhysicalDevice( VkCommandBuffer command_buffer, bool transfer_indices )
 {
 	VkBufferCopy region {};
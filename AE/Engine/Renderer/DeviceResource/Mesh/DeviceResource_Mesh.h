@@ -25,9 +25,10 @@ public:
 	LoadingState						Load();
 	UnloadingState						Unload();
 
-	const Vector<Vertex>			&	GetVertices() const;
+	ArrayView<const Vertex>				GetVertices() const;
+	ArrayView<const VertexCompact>		GetCompactVertices() const;
 	const Vector<CopyVertex>		&	GetCopyVertices() const;
-	const Vector<Polygon>			&	GetPolygons() const;
+	ArrayView<const Polygon>			GetPolygons() const;
 
 	// There isn't a reason why the editable versions should ever be returned, the base model should be kept intact
 	/*
@@ -36,12 +37,19 @@ public:
 	Vector<Polygon>					&	GetEditablePolygons();
 	*/
 
+	// graphics pipelines drawing this mesh need to read the same vertex format
+	VertexFormat						GetVertexFormat() const;
+
+	// maps stored vertex positions into model space, identity unless the vertices are compact
+	Mat4								GetPositionTransform() const;
+
 	size_t								GetVerticesByteSize() const;
 	size_t								GetCopyVerticesByteSize() const;
 	size_t								GetPolygonsByteSize() const;
 
-	void								UpdateVulkanBuffer_Index( const Vector<Polygon> & polygons );
-	void								UpdateVulkanBuffer_Vertex( const Vector<Vertex> & vertices );
+	void								UpdateVulkanBuffer_Index( ArrayView<const Polygon> polygons );
+	void								UpdateVulkanBuffer_Vertex( ArrayView<const Vertex> vertices );
+	void								UpdateVulkanBuffer_Vertex( ArrayView<const VertexCompact> vertices );
 
 	void								RecordVulkanCommand_TransferToPhysicalDevice( VkCommandBuffer command_buffer, bool transfer_indices = false );
 	void								RecordVulkanCommand_Render( VkCommandBuffer command_buffer, VkPipelineLayout pipeline_layout );
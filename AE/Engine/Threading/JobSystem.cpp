@@ -0,0 +1,375 @@
+
+#include <assert.h>
+#include <algorithm>
+#include <sstream>
+
+#include "JobSystem.h"
+
+#include "../Logger/Logger.h"
+
+namespace AE
+{
+
+namespace engine_internal
+{
+
+thread_local uint32_t					this_thread_job_worker_index		= UINT32_MAX;
+
+uint32_t JobSystem_GetWorkerCount()
+{
+	uint32_t thread_count			= BUILD_JOB_SYSTEM_THREAD_COUNT;
+	if( 0 == thread_count ) {
+		auto hardware_threads		= std::thread::hardware_concurrency();
+		thread_count				= ( hardware_threads > 1 ) ? hardware_threads - 1 : 1;
+	}
+	// device resource manager pins it's worker jobs to the first workers
+	return std::max<uint32_t>( thread_count, BUILD_DEVICE_RESOURCE_MANAGER_WORKER_THREAD_COUNT );
+}
+
+}
+
+void JobWorkerThread( JobSystem * job_system, uint32_t worker_index )
+{
+	assert( nullptr != job_system );
+	assert( worker_index < job_system->workers.size() );
+	engine_internal::this_thread_job_worker_index	= worker_index;
+
+	MEMORY_TAG( "Job worker" );
+
+	auto & worker		= job_system->workers[ worker_index ];
+	while( !job_system->workers_should_exit ) {
+		auto job		= job_system->FindJob( worker_index, true );
+		if( job ) {
+			job_system->Execute( job );
+			continue;
+		}
+		// sleeping is set again after every wake up, the thread that woke us clears it
+		std::unique_lock<std::mutex> sleep_guard( job_system->mutex_sleep );
+		while( !job_system->workers_should_exit && 0 == job_system->stealable_job_count &&
+			0 == job_system->background_job_count && 0 == worker.pinned_job_count ) {
+			worker.sleeping	= true;
+			worker.wake.wait( sleep_guard );
+		}
+		worker.sleeping	= false;
+	}
+}
+
+bool Job::IsFinished() const
+{
+	return finished;
+}
+
+JobSystem::JobSystem( Engine * engine )
+	: SubSystem( engine, "JobSystem" ), workers( engine_internal::JobSystem_GetWorkerCount() )
+{
+	// all workers exist before any of the threads start looking for jobs to steal
+	for( uint32_t i=0; i < uint32_t( workers.size() ); ++i ) {
+		workers[ i ].thread			= std::thread( JobWorkerThread, this, i );
+	}
+
+	std::stringstream ss;
+	ss << "Job system running " << workers.size() << " worker threads";
+	p_logger->LogInfo( ss.str() );
+}
+
+JobSystem::~JobSystem()
+{
+	// jobs still in the queues are dropped, systems using the job system must wait for their jobs before this
+	workers_should_exit				= true;
+	WakeAll();
+	for( auto & w : workers ) {
+		w.thread.join();
+	}
+}
+
+JobHandle JobSystem::Submit( std::function<void()> function, const Vector<JobHandle> & dependencies )
+{
+	auto job		= CreateJob( std::move( function ), UINT32_MAX, false );
+	AddDependencies( job, dependencies );
+	return job;
+}
+
+JobHandle JobSystem::SubmitToWorker( uint32_t worker_index, std::function<void()> function )
+{
+	assert( worker_index < workers.size() );
+	auto job		= CreateJob( std::move( function ), worker_index, false );
+	AddDependencies( job, {} );
+	return job;
+}
+
+JobHandle JobSystem::SubmitBackground( std::function<void()> function )
+{
+	auto job		= CreateJob( std::move( function ), UINT32_MAX, true );
+	AddDependencies( job, {} );
+	return job;
+}
+
+void JobSystem::Wait( const JobHandle & job )
+{
+	if( !job ) return;
+
+	auto worker_index	= GetThisThreadWorkerIndex();
+	auto worker			= ( worker_index < workers.size() ) ? &workers[ worker_index ] : nullptr;
+	while( !job->finished ) {
+		// background jobs are never picked up here, they can run for a long time
+		auto other		= FindJob( worker_index, false );
+		if( other ) {
+			Execute( other );
+			continue;
+		}
+		// nothing to help with, sleep until the job finishes or more jobs are queued
+		++waiting_threads;
+		{
+			std::unique_lock<std::mutex> sleep_guard( mutex_sleep );
+			auto is_done	= [ this, &job, worker ]() {
+				return job->finished || stealable_job_count > 0 || ( worker && worker->pinned_job_count > 0 );
+			};
+			if( worker ) {
+				worker->waiting		= true;
+				while( !is_done() ) {
+					worker->sleeping	= true;
+					worker->wake.wait( sleep_guard );
+				}
+				worker->sleeping	= false;
+				worker->waiting		= false;
+			} else {
+				jobs_available.wait( sleep_guard, is_done );
+			}
+		}
+		--waiting_threads;
+	}
+}
+
+void JobSystem::Wait( const Vector<JobHandle> & jobs )
+{
+	for( auto & j : jobs ) {
+		Wait( j );
+	}
+}
+
+void JobSystem::ParallelFor( size_t count, size_t batch_size, std::function<void( size_t begin, size_t end )> function )
+{
+	if( 0 == count ) return;
+	batch_size		= std::max<size_t>( batch_size, 1 );
+
+	// function lives on this stack frame, it's safe to reference as we wait for all batches below
+	Vector<JobHandle> jobs;
+	jobs.reserve( ( count + batch_size - 1 ) / batch_size );
+	for( size_t begin=0; begin < count; begin += batch_size ) {
+		auto end	= std::min( begin + batch_size, count );
+		jobs.push_back( Submit( [ &function, begin, end ]() {
+			function( begin, end );
+		} ) );
+	}
+	Wait( jobs );
+}
+
+uint32_t JobSystem::GetWorkerCount() const
+{
+	return uint32_t( workers.size() );
+}
+
+std::thread::id JobSystem::GetWorkerThreadID( uint32_t worker_index ) const
+{
+	assert( worker_index < workers.size() );
+	return workers[ worker_index ].thread.get_id();
+}
+
+uint32_t JobSystem::GetThisThreadWorkerIndex()
+{
+	return engine_internal::this_thread_job_worker_index;
+}
+
+JobHandle JobSystem::CreateJob( std::function<void()> function, uint32_t pinned_worker_index, bool background )
+{
+	auto job					= MakeIntrusivePointer<Job>();
+	job->function				= std::move( function );
+	job->pinned_worker_index	= pinned_worker_index;
+	job->background				= background;
+	return job;
+}
+
+void JobSystem::AddDependencies( const JobHandle & job, const Vector<JobHandle> & dependencies )
+{
+	for( auto & d : dependencies ) {
+		if( !d ) continue;
+		LOCK_GUARD( d->mutex );
+		if( d->finished ) continue;
+		++job->dependencies_left;
+		d->dependents.push_back( job );
+	}
+	// remove the extra dependency, job is queued right away if all dependencies had already finished
+	if( --job->dependencies_left == 0 ) {
+		Enqueue( job );
+	}
+}
+
+void JobSystem::Enqueue( const JobHandle & job )
+{
+	if( job->pinned_worker_index != UINT32_MAX ) {
+		auto & worker		= workers[ job->pinned_worker_index ];
+		LOCK_GUARD( worker.mutex );
+		worker.pinned_jobs.push_back( job );
+		++worker.pinned_job_count;
+	} else if( job->background ) {
+		LOCK_GUARD( mutex_background_jobs );
+		background_jobs.push_back( job );
+		++background_job_count;
+	} else {
+		auto worker_index	= GetThisThreadWorkerIndex();
+		if( worker_index < workers.size() ) {
+			auto & worker	= workers[ worker_index ];
+			LOCK_GUARD( worker.mutex );
+			worker.jobs.push_back( job );
+			++stealable_job_count;
+		} else {
+			LOCK_GUARD( mutex_shared_jobs );
+			shared_jobs.push_back( job );
+			++stealable_job_count;
+		}
+	}
+	WakeForJob( job );
+}
+
+void JobSystem::WakeForJob( const JobHandle & job )
+{
+	LOCK_GUARD( mutex_sleep );
+
+	// pinned jobs can only run on their owner
+	if( job->pinned_worker_index != UINT32_MAX ) {
+		auto & worker		= workers[ job->pinned_worker_index ];
+		if( worker.sleeping ) {
+			worker.sleeping	= false;
+			worker.wake.notify_one();
+		}
+		return;
+	}
+
+	// sleeping flag is cleared right away so that the next job wakes up a different worker
+	for( auto & w : workers ) {
+		if( !w.sleeping ) continue;
+		if( job->background && w.waiting ) continue;
+		w.sleeping			= false;
+		w.wake.notify_one();
+		return;
+	}
+	// every worker is busy, a thread waiting from outside the job system can help
+	if( !job->background ) {
+		jobs_available.notify_one();
+	}
+}
+
+void JobSystem::WakeWaiters()
+{
+	LOCK_GUARD( mutex_sleep );
+	for( auto & w : workers ) {
+		if( w.waiting ) {
+			w.wake.notify_one();
+		}
+	}
+	jobs_available.notify_all();
+}
+
+void JobSystem::WakeAll()
+{
+	LOCK_GUARD( mutex_sleep );
+	for( auto & w : workers ) {
+		w.wake.notify_one();
+	}
+	jobs_available.notify_all();
+}
+
+JobHandle JobSystem::FindJob( uint32_t worker_index, bool allow_background )
+{
+	JobHandle job		= nullptr;
+	uint32_t count		= uint32_t( workers.size() );
+
+	// own pinned jobs in submission order, then own jobs newest first
+	if( worker_index < count ) {
+		auto & worker	= workers[ worker_index ];
+		LOCK_GUARD( worker.mutex );
+		if( worker.pinned_jobs.size() ) {
+			job			= worker.pinned_jobs.front();
+			worker.pinned_jobs.pop_front();
+			--worker.pinned_job_count;
+			return job;
+		}
+		if( worker.jobs.size() ) {
+			job			= worker.jobs.back();
+			worker.jobs.pop_back();
+			--stealable_job_count;
+			return job;
+		}
+	}
+	if( 0 == stealable_job_count ) return FindBackgroundJob( allow_background );
+
+	// jobs submitted from outside the job system
+	{
+		LOCK_GUARD( mutex_shared_jobs );
+		if( shared_jobs.size() ) {
+			job			= shared_jobs.front();
+			shared_jobs.pop_front();
+			--stealable_job_count;
+			return job;
+		}
+	}
+
+	// steal the oldest job of another worker
+	uint32_t start		= ( worker_index < count ) ? worker_index + 1 : 0;
+	for( uint32_t i=0; i < count; ++i ) {
+		auto victim_index	= ( start + i ) % count;
+		if( victim_index == worker_index ) continue;
+		auto & victim	= workers[ victim_index ];
+		LOCK_GUARD( victim.mutex );
+		if( victim.jobs.size() ) {
+			job			= victim.jobs.front();
+			victim.jobs.pop_front();
+			--stealable_job_count;
+			return job;
+		}
+	}
+	return FindBackgroundJob( allow_background );
+}
+
+JobHandle JobSystem::FindBackgroundJob( bool allow_background )
+{
+	if( !allow_background || 0 == background_job_count ) return nullptr;
+
+	LOCK_GUARD( mutex_background_jobs );
+	if( background_jobs.empty() ) return nullptr;
+	auto job			= background_jobs.front();
+	background_jobs.pop_front();
+	--background_job_count;
+	return job;
+}
+
+void JobSystem::Execute( const JobHandle & job )
+{
+	assert( job );
+	if( job->function ) {
+		job->function();
+	}
+	// release anything captured by the function right away
+	job->function		= nullptr;
+
+	Vector<JobHandle> ready;
+	{
+		LOCK_GUARD( job->mutex );
+		job->finished	= true;
+		for( auto & d : job->dependents ) {
+			if( --d->dependencies_left == 0 ) {
+				ready.push_back( d );
+			}
+		}
+		job->dependents.clear();
+	}
+	// idle workers don't care about finished jobs, only threads blocked in Wait() do
+	if( waiting_threads > 0 ) {
+		WakeWaiters();
+	}
+	for( auto & d : ready ) {
+		Enqueue( d );
+	}
+}
+
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+#include "../BUILD_OPTIONS.h"
+#include "../Platform.h"
+
+#include "../SubSystem.h"
+#include "../Memory/Memory.h"
+#include "Threading.h"
+
+namespace AE
+{
+
+class Engine;
+class JobSystem;
+
+// Job submitted to the job system, handles are shared so that jobs can be
+// waited on and used as dependencies after they have been submitted
+// The reference count is inside the job, so a job is a single allocation
+class Job : public IntrusiveReferenceCount
+{
+	friend class JobSystem;
+	friend void JobWorkerThread( JobSystem * job_system, uint32_t worker_index );
+
+public:
+	bool								IsFinished() const;
+
+private:
+	std::function<void()>				function;
+	uint32_t							pinned_worker_index				= UINT32_MAX;
+	bool								background						= false;
+
+	// 1 extra while dependencies are being added so that the job can't start too early
+	std::atomic<uint32_t>				dependencies_left				{ 1 };
+
+	// finished is only set while the mutex is locked so that no dependent is missed
+	Mutex								mutex;
+	std::atomic_bool					finished						{ false };
+	Vector<IntrusivePointer<Job>>		dependents;
+};
+
+using JobHandle							= IntrusivePointer<Job>;
+
+// Engine wide work stealing job scheduler
+// Every worker thread has its own queue, workers take their own newest jobs first and steal
+// the oldest jobs of other workers when they run out. Jobs submitted from other threads go
+// into a shared queue. Pinned jobs only run on one worker and are never stolen, they are used
+// by systems that keep per thread state, eg. vulkan command pools. Background jobs are long running
+// jobs like resource loading, only idle workers run them.
+// Threads that wait for a job help by running other jobs in the meantime and sleep when there are none,
+// they never pick up background jobs so that a wait can't get stuck behind a load burst.
+class JobSystem : public SubSystem
+{
+	friend void JobWorkerThread( JobSystem * job_system, uint32_t worker_index );
+
+public:
+	JobSystem( Engine * engine );
+	~JobSystem();
+
+	// job starts once all dependencies have finished, finished or empty dependencies are ignored
+	JobHandle							Submit( std::function<void()> function, const Vector<JobHandle> & dependencies = {} );
+	// job only runs on the given worker thread
+	JobHandle							SubmitToWorker( uint32_t worker_index, std::function<void()> function );
+	// job only runs on idle worker threads, never from Wait()
+	JobHandle							SubmitBackground( std::function<void()> function );
+
+	// runs other jobs while waiting, can be called from any thread including worker threads
+	void								Wait( const JobHandle & job );
+	void								Wait( const Vector<JobHandle> & jobs );
+
+	// splits the range into batches, runs them as jobs and waits until all of them are done
+	void								ParallelFor( size_t count, size_t batch_size, std::function<void( size_t begin, size_t end )> function );
+
+	uint32_t							GetWorkerCount() const;
+	std::thread::id						GetWorkerThreadID( uint32_t worker_index ) const;
+	// worker index of the calling thread, UINT32_MAX if called from outside the job system
+	static uint32_t						GetThisThreadWorkerIndex();
+
+private:
+	struct Worker
+	{
+		Mutex							mutex;
+		List<JobHandle>					jobs;								// own end is the back, thieves take from the front
+		List<JobHandle>					pinned_jobs;
+		std::atomic<uint32_t>			pinned_job_count				{ 0 };
+		std::thread						thread;
+
+		// guarded by mutex_sleep
+		std::condition_variable			wake;
+		bool							sleeping						= false;
+		bool							waiting							= false;	// sleeping inside Wait()
+	};
+
+	JobHandle							CreateJob( std::function<void()> function, uint32_t pinned_worker_index, bool background );
+	void								AddDependencies( const JobHandle & job, const Vector<JobHandle> & dependencies );
+	// queues a job whose dependencies have finished
+	void								Enqueue( const JobHandle & job );
+	// wakes one sleeping thread that can run the job, locking the sleep mutex makes sure
+	// a thread that is about to sleep sees the new job count
+	void								WakeForJob( const JobHandle & job );
+	// wakes threads sleeping in Wait() so they can check their jobs
+	void								WakeWaiters();
+	void								WakeAll();
+	// worker_index is UINT32_MAX for threads outside the job system
+	JobHandle							FindJob( uint32_t worker_index, bool allow_background );
+	JobHandle							FindBackgroundJob( bool allow_background );
+	void								Execute( const JobHandle & job );
+
+	// created once with the final worker count, workers are never moved
+	Vector<Worker>						workers;
+
+	Mutex								mutex_shared_jobs;
+	List<JobHandle>						shared_jobs;
+
+	Mutex								mutex_background_jobs;
+	List<JobHandle>						background_jobs;
+
+	// jobs that any worker can run, pinned jobs are counted per worker
+	std::atomic<uint32_t>				stealable_job_count				{ 0 };
+	std::atomic<uint32_t>				background_job_count			{ 0 };
+
+	// workers sleep on their own condition variable so that pinned jobs only wake their owner,
+	// threads outside the job system sleep on jobs_available while they wait
+	Mutex								mutex_sleep;
+	std::condition_variable				jobs_available;
+	std::atomic_bool					workers_should_exit				{ false };
+	// threads sleeping in Wait(), finished jobs wake them up while this isn't 0
+	std::atomic<uint32_t>				waiting_threads					{ 0 };
+};
+
+}
@@ -3,10 +3,12 @@
 
 #include <assert.h>
 #include <iostream>
+#include <atomic>
 
 #include "../Memory/MemoryTypes.h"
 
 #include "../Memory/MemoryPool/MemoryPool.h"
+#include "../Memory/MemoryPool/MemoryPoolTelemetry.h"
 
 namespace AE
 {
@@ -14,7 +16,32 @@ namespace AE
 #if BUILD_VULKAN_MEMORY_ALLOCATOR_TYPE == 1 || BUILD_VULKAN_MEMORY_ALLOCATOR_TYPE == 2
 
 #if BUILD_VULKAN_MEMORY_ALLOCATOR_TYPE == 2
-int64_t vulkan_allocation_counter		= 0;
+std::atomic<int64_t> vulkan_allocation_counter( 0 );
+
+// Vulkan allocations are recorded under a separate memory tag for every allocation scope,
+// driver internal allocations are not made through the memory pool but are recorded as well
+uint16_t GetVulkanMemoryTag( VkSystemAllocationScope allocation_scope, bool internal )
+{
+	static const uint16_t tags[ 2 ][ VK_SYSTEM_ALLOCATION_SCOPE_RANGE_SIZE ] {
+		{
+			engine_internal::MemoryPool_RegisterTag( "Vulkan command" ),
+			engine_internal::MemoryPool_RegisterTag( "Vulkan object" ),
+			engine_internal::MemoryPool_RegisterTag( "Vulkan cache" ),
+			engine_internal::MemoryPool_RegisterTag( "Vulkan device" ),
+			engine_internal::MemoryPool_RegisterTag( "Vulkan instance" ),
+		},
+		{
+			engine_internal::MemoryPool_RegisterTag( "Vulkan internal command" ),
+			engine_internal::MemoryPool_RegisterTag( "Vulkan internal object" ),
+			engine_internal::MemoryPool_RegisterTag( "Vulkan internal cache" ),
+			engine_internal::MemoryPool_RegisterTag( "Vulkan internal device" ),
+			engine_internal::MemoryPool_RegisterTag( "Vulkan internal instance" ),
+		}
+	};
+	uint32_t scope_index	= uint32_t( allocation_scope ) - uint32_t( VK_SYSTEM_ALLOCATION_SCOPE_BEGIN_RANGE );
+	assert( scope_index < VK_SYSTEM_ALLOCATION_SCOPE_RANGE_SIZE );
+	return tags[ internal ? 1 : 0 ][ scope_index ];
+}
 #endif
 
 void * VulkanMemoryAllocationFunc(
@@ -23,10 +50,14 @@ void * VulkanMemoryAllocationFunc(
 	size_t						alignment,
 	VkSystemAllocationScope		allocationScope )
 {
-	auto memory					= engine_internal::MemoryPool_AllocateRaw( size, alignment );
-	TODO( "All Vulkan memory debuggin reports" );
 #if BUILD_VULKAN_MEMORY_ALLOCATOR_TYPE == 2
-	++vulkan_allocation_counter;
+	engine_internal::MemoryTagScope memory_tag( GetVulkanMemoryTag( allocationScope, false ) );
+	auto memory					= engine_internal::MemoryPool_AllocateRaw( size, alignment );
+	if( memory ) {
+		++vulkan_allocation_counter;
+	}
+#else
+	auto memory					= engine_internal::MemoryPool_AllocateRaw( size, alignment );
 #endif
 	return memory;
 }
@@ -38,9 +69,17 @@ void * VulkanMemoryReallocationFunc(
 	size_t						alignment,
 	VkSystemAllocationScope		allocationScope )
 {
-	auto memory					= engine_internal::MemoryPool_ReallocateRaw( pOriginal, size, alignment );
 #if BUILD_VULKAN_MEMORY_ALLOCATOR_TYPE == 2
-
+	engine_internal::MemoryTagScope memory_tag( GetVulkanMemoryTag( allocationScope, false ) );
+	auto memory					= engine_internal::MemoryPool_ReallocateRaw( pOriginal, size, alignment );
+	// reallocation works as allocation or free if either the original pointer or size is missing
+	if( nullptr == pOriginal && memory ) {
+		++vulkan_allocation_counter;
+	} else if( nullptr != pOriginal && 0 == size ) {
+		--vulkan_allocation_counter;
+	}
+#else
+	auto memory					= engine_internal::MemoryPool_ReallocateRaw( pOriginal, size, alignment );
 #endif
 	return memory;
 }
@@ -63,8 +102,8 @@ void VulkanMemoryInternalAllocationNotificationFunc(
 	VkInternalAllocationType	allocationType,
 	VkSystemAllocationScope		allocationScope )
 {
-#if BUILD_VULKAN_MEMORY_ALLOCATOR_TYPE == 2
-
+#if BUILD_VULKAN_MEMORY_ALLOCATOR_TYPE == 2 && BUILD_MEMORY_POOL_TELEMETRY
+	engine_internal::MemoryPool_RecordAllocation( GetVulkanMemoryTag( allocationScope, true ), size );
 #endif
 }
 
@@ -74,8 +113,8 @@ void VulkanMemoryInternalFreeNotificationFunc(
 	VkInternalAllocationType	allocationType,
 	VkSystemAllocationScope		allocationScope )
 {
-#if BUILD_VULKAN_MEMORY_ALLOCATOR_TYPE == 2
-
+#if BUILD_VULKAN_MEMORY_ALLOCATOR_TYPE == 2 && BUILD_MEMORY_POOL_TELEMETRY
+	engine_internal::MemoryPool_RecordFree( GetVulkanMemoryTag( allocationScope, true ), size );
 #endif
 }
 
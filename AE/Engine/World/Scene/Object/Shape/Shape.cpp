@@ -36,7 +36,10 @@ void SceneNode_Shape::Update_Buffers()
 	if( mesh_info ) {
 		UniformBufferData_Mesh ub_data {};
 		TODO( "double check the matrix multiplication order" );
-		ub_data.model_matrix	= inherited_transformation_matrix;
+		// compact vertices are stored inside the mesh bounds, the position transform maps them back to model space
+		ub_data.model_matrix	= inherited_transformation_matrix * mesh_info->mesh_resource->GetPositionTransform();
+		// normals are stored unscaled in both vertex formats so they only need the scene node transformation
+		ub_data.normal_matrix	= Mat4( glm::transpose( glm::inverse( Mat3( inherited_transformation_matrix ) ) ) );
 
 		mesh_info->uniform_buffer->CopyDataToHostBuffer( &ub_data, sizeof( ub_data ) );
 	}
@@ -45,12 +45,24 @@ SceneBase::SceneBase( Engine * engine, SceneManager * scene_manager, SceneBase *
 	type						= scene_node_type;
 	assert( type != Type::UNDEFINED );
 
+	resource_wait_state				= MakeSharedPointer<ResourceWaitState>();
+	resource_wait_state->scene_node	= this;
+
 	config_file_path			= scene_node_path;
 	config_file					= p_engine->GetFileResourceManager()->RequestResource( config_file_path );
+	if( config_file ) {
+		WaitForResource( config_file );
+	} else {
+		p_scene_manager->QueueResourceAvailabilityUpdate( this );
+	}
 }
 
 SceneBase::~SceneBase()
 {
+	// resources may still finish after this, their callbacks only see the cleared wait state
+	LOCK_GUARD( resource_wait_state->mutex );
+	resource_wait_state->scene_node		= nullptr;
+	p_scene_manager->CancelResourceAvailabilityUpdate( this );
 }
 
 SceneNode * SceneBase::CreateChild( SceneBase::Type scene_node_type, Path scene_node_path )
@@ -87,9 +99,10 @@ SceneNode * SceneBase::CreateChild( SceneBase::Type scene_node_type, Path scene_
 	return nullptr;
 }
 
-Vector<SceneNode*> SceneBase::GetChildNodes()
+FrameVector<SceneNode*> SceneBase::GetChildNodes()
 {
-	Vector<SceneNode*> ret;
+	FrameVector<SceneNode*> ret;
+	ret.reserve( child_list.size() );
 	for( auto & node : child_list ) {
 		ret.push_back( node.Get() );
 	}
@@ -152,6 +165,18 @@ void SceneBase::Update_ResoureAvailability()
 	}
 }
 
+void SceneBase::ResourceFinished( const SharedPointer<ResourceWaitState> & wait_state )
+{
+	// more resources may be registered after the count reaches 0, the scene node is then
+	// queued again when those finish, extra availability updates don't do any harm
+	if( --wait_state->resources_left == 0 ) {
+		LOCK_GUARD( wait_state->mutex );
+		if( wait_state->scene_node ) {
+			wait_state->scene_node->p_scene_manager->QueueResourceAvailabilityUpdate( wait_state->scene_node );
+		}
+	}
+}
+
 bool SceneBase::IsConfigFileParsed()
 {
 	return is_config_file_parsed;
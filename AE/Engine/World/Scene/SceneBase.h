@@ -4,6 +4,7 @@
 #include "../../Platform.h"
 
 #include "../../Memory/MemoryTypes.h"
+#include "../../Threading/Threading.h"
 #include "../../Vulkan/Vulkan.h"
 
 #include "../../FileResource/XML/FileResource_XML.h"
@@ -69,10 +70,11 @@ public:
 	virtual									~SceneBase();
 
 	SceneNode							*	CreateChild( SceneBase::Type scene_node_type, Path scene_node_path = "" );
-	Vector<SceneNode*>						GetChildNodes();
+	// Returned list is allocated from the frame arena and is only valid during the current frame
+	FrameVector<SceneNode*>					GetChildNodes();
 
-	// Resource update function, call every once in a while to check if resources
-	// are loaded in and we can use this object, this function IS NOT recursive to child scene nodes
+	// Resource update function, called by the scene manager after the resources this scene node waits for
+	// have finished loading, this function IS NOT recursive to child scene nodes
 	// This function is called only until all resources have been loaded in
 	void									Update_ResoureAvailability();
 
@@ -138,6 +140,8 @@ protected:
 	// Returns the state of the resources, check the enum, it's self explanatory.
 	// In case UNABLE_TO_LOAD, this object will not partake in any actions in the world,
 	// including rendering operations.
+	// Every resource checked here must be registered with WaitForResource() when it's requested,
+	// scene nodes are not polled, this is only called again after a waited resource has finished.
 	virtual ResourcesLoadState				CheckResourcesLoaded()			= 0;
 
 	// After all resources are properly loaded in, this is the next function that
@@ -159,6 +163,11 @@ protected:
 
 	FileResourceHandle<FileResource_XML>	config_file						= nullptr;
 
+	// Registers a resource this scene node needs before it can be used, Update_ResoureAvailability()
+	// is queued on the scene manager once all registered resources have finished loading or failed
+	template<typename HandleType>
+	void									WaitForResource( HandleType & resource );
+
 	// Calculates a new transformation matrix from position, scale and rotation
 	// Matrix is stored in transformation_matrix variable, it's also returned out of convenience
 	const Mat4							&	CalculateTransformationMatrix();
@@ -186,12 +195,27 @@ protected:
 	bool									is_visible						= true;
 
 private:
+	// shared with the load finished callbacks of the resources this scene node waits for, callbacks
+	// can outlive the scene node so scene_node is cleared while the mutex is locked when it's destroyed
+	struct ResourceWaitState
+	{
+		Mutex								mutex;
+		SceneBase						*	scene_node						= nullptr;
+		std::atomic<uint32_t>				resources_left					{ 0 };
+	};
+
+	static void								ResourceFinished( const SharedPointer<ResourceWaitState> & wait_state );
+
 	Type									type							= Type::UNDEFINED;
 	Path									config_file_path;
 	bool									is_config_file_parsed			= false;
 	bool									is_scene_node_use_ready			= false;
 	bool									is_scene_node_ok				= true;
 
+	SharedPointer<ResourceWaitState>		resource_wait_state;
+	// guarded by the resource availability queue mutex of the scene manager
+	bool									in_resource_availability_queue	= false;
+
 	SceneBase							*	p_parent						= nullptr;
 
 	List<UniquePointer<SceneNode>>			child_list;
@@ -203,4 +227,15 @@ bool										ParseConfigFileHelper( tinyxml2::XMLElement * previous_level, Stri
 SceneBase::ResourcesLoadState				CheckResourcesLoadedHelper( SceneBase::ResourcesLoadState previous_level, std::function<SceneBase::ResourcesLoadState( void )> child_element_parser );
 bool										FinalizeResourcesHelper( bool previous_level, std::function<bool( void )> child_parser_function );
 
+template<typename HandleType>
+void SceneBase::WaitForResource( HandleType & resource )
+{
+	if( !resource ) return;
+	++resource_wait_state->resources_left;
+	auto wait_state		= resource_wait_state;
+	resource->AddLoadFinishedCallback( [ wait_state ]() {
+		ResourceFinished( wait_state );
+	} );
+}
+
 }
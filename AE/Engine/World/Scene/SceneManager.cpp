@@ -1,5 +1,6 @@
 
 #include <assert.h>
+#include <algorithm>
 
 #include "SceneManager.h"
 
@@ -7,6 +8,7 @@
 #include "../../Logger/Logger.h"
 #include "../../Renderer/Renderer.h"
 #include "../../Memory/Memory.h"
+#include "../../Threading/JobSystem.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SceneNode.h"
 
@@ -21,10 +23,10 @@ SceneManager::SceneManager( Engine * engine, World * world )
 	assert( p_world );
 	p_logger		= p_engine->GetLogger();
 	p_renderer		= p_engine->GetRenderer();
+	p_job_system	= p_engine->GetJobSystem();
 	assert( p_logger );
 	assert( p_renderer );
-
-	TODO( "Add multithreading support for the scene update" );
+	assert( p_job_system );
 
 	active_scene	= MakeUniquePointer<Scene>( p_engine, this, nullptr, "" );
 }
@@ -35,21 +37,46 @@ SceneManager::~SceneManager()
 
 void SceneManager::Update()
 {
+	MEMORY_TAG( "Scene update" );
+
 	// update all parent hierarchies
 	active_scene->CalculateSceneNodeRecursiveParentHierarchy();
 
 	TODO( "Implement update frequencies for different types of scene updates" );
-	Vector<SceneBase*> collection;
+	FrameVector<SceneBase*> collection;
 	CollectAllChildSceneBases( active_scene.Get(), &collection );
+
+	// only scene nodes whose waited resources have finished since the last update need their availability
+	// updated, nodes that are still loading cost nothing. This requests resources so it stays on this thread
+	Vector<SceneBase*> availability_updates;
+	{
+		LOCK_GUARD( mutex_resource_availability_queue );
+		availability_updates.swap( resource_availability_queue );
+		for( auto sbase : availability_updates ) {
+			sbase->in_resource_availability_queue	= false;
+		}
+	}
+	for( auto sbase : availability_updates ) {
+		sbase->Update_ResoureAvailability();
+	}
+
+	// ready nodes only touch their own data and buffers so they're updated in parallel
+	FrameVector<SceneBase*> ready_collection;
+	ready_collection.reserve( collection.size() );
 	for( auto sbase : collection ) {
 		if( sbase->IsSceneNodeUseReady() ) {
+			ready_collection.push_back( sbase );
+		}
+	}
+	// frame arena is only used from this thread, jobs must not allocate from it
+	p_job_system->ParallelFor( ready_collection.size(), BUILD_SCENE_MANAGER_UPDATE_BATCH_SIZE, [ &ready_collection ]( size_t begin, size_t end ) {
+		for( size_t i=begin; i < end; ++i ) {
+			auto sbase	= ready_collection[ i ];
 			sbase->Update_Logic();
 			sbase->Update_Animation();
 			sbase->Update_Buffers();
-		} else {
-			sbase->Update_ResoureAvailability();
 		}
-	}
+	} );
 
 	TODO( "Grid nodes not enabled at this point." );
 	/*
@@ -66,7 +93,27 @@ Scene * SceneManager::GetActiveScene() const
 	return active_scene.Get();
 }
 
-void CollectAllChildSceneBases( SceneBase * node, Vector<SceneBase*> * return_collection )
+void SceneManager::QueueResourceAvailabilityUpdate( SceneBase * scene_node )
+{
+	assert( scene_node );
+	LOCK_GUARD( mutex_resource_availability_queue );
+	if( !scene_node->in_resource_availability_queue ) {
+		scene_node->in_resource_availability_queue	= true;
+		resource_availability_queue.push_back( scene_node );
+	}
+}
+
+void SceneManager::CancelResourceAvailabilityUpdate( SceneBase * scene_node )
+{
+	assert( scene_node );
+	LOCK_GUARD( mutex_resource_availability_queue );
+	if( scene_node->in_resource_availability_queue ) {
+		scene_node->in_resource_availability_queue	= false;
+		resource_availability_queue.erase( std::find( resource_availability_queue.begin(), resource_availability_queue.end(), scene_node ) );
+	}
+}
+
+void CollectAllChildSceneBases( SceneBase * node, FrameVector<SceneBase*> * return_collection )
 {
 	return_collection->push_back( node );
 	for( auto i : node->GetChildNodes() ) {
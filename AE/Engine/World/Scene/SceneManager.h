@@ -5,6 +5,7 @@
 
 #include "../../Memory/MemoryTypes.h"
 #include "../../Math/Math.h"
+#include "../../Threading/Threading.h"
 
 namespace AE
 {
@@ -12,6 +13,7 @@ namespace AE
 class Engine;
 class Logger;
 class Renderer;
+class JobSystem;
 class DescriptorPoolManager;
 class World;
 class Scene;
@@ -32,16 +34,27 @@ public:
 	Scene								*	GetActiveScene() const;
 	Scene								*	GetGridScene( Vec3 world_coords ) const;
 
+	// Queues Update_ResoureAvailability() of a scene node for the next update, called when the resources
+	// the scene node waits for have finished, can be called from any thread
+	void									QueueResourceAvailabilityUpdate( SceneBase * scene_node );
+	// removes a scene node that's being destroyed from the queue
+	void									CancelResourceAvailabilityUpdate( SceneBase * scene_node );
+
 private:
 	Engine								*	p_engine					= nullptr;
 	Logger								*	p_logger					= nullptr;
 	Renderer							*	p_renderer					= nullptr;
+	JobSystem							*	p_job_system				= nullptr;
 	World								*	p_world						= nullptr;
 
+	// declared before the scenes so that it outlives the scene nodes that use it when they're destroyed
+	Mutex									mutex_resource_availability_queue;
+	Vector<SceneBase*>						resource_availability_queue;
+
 	UniquePointer<Scene>					active_scene;
 //	DynamicGrid2D<SharedPointer<Scene>>		grid_nodes;
 };
 
-void CollectAllChildSceneBases( SceneBase * node, Vector<SceneBase*> * return_collection );
+void CollectAllChildSceneBases( SceneBase * node, FrameVector<SceneBase*> * return_collection );
 
 }
@@ -45,10 +45,19 @@ tinyxml2::XMLElement * SceneNode::ParseConfigFile_SceneNodeLevel()
 		mesh_info			= MakeSharedPointer<MeshInfo>();
 		auto & mesh			= mesh_info;
 
-		mesh->mesh_resource	= p_device_resource_manager->RequestResource_Mesh( { config_file->GetFieldValue_Text( xml_mesh, "path" ) } );
 		mesh->name			= config_file->GetFieldValue_Text( xml_mesh, "name" );
 		mesh->is_visible	= config_file->GetFieldValue_Bool( xml_mesh, "visible" );
 
+		// visible meshes are needed first, everything else can wait
+		auto priority		= ( is_visible && mesh->is_visible ) ? ResourcePriority::HIGH : ResourcePriority::LOW;
+
+		// all device resources of the mesh are requested as one batch, request indexes point into the batch
+		Vector<DeviceResourceManager::ResourceRequest>	requests;
+		uint32_t										pipeline_request		= UINT32_MAX;
+		Array<uint32_t, BUILD_MAX_PER_SHADER_SAMPLED_IMAGE_COUNT>	image_requests;
+		image_requests.fill( UINT32_MAX );
+		requests.push_back( { DeviceResource::Type::MESH, { AssetID( config_file->GetFieldValue_Text( xml_mesh, "path" ) ) }, DeviceResource::Flags( 0 ), priority } );
+
 		// mesh specific transformation depricated since we now allow only one mesh per scene node
 		/*
 		auto position		= config_file->GetMultiFieldValues_Double( xml_mesh, "position" );
@@ -70,11 +79,13 @@ tinyxml2::XMLElement * SceneNode::ParseConfigFile_SceneNodeLevel()
 		*/
 
 		// handle render info
-		mesh->render_info.image_info.image_count			= -1;
+		// image count is the highest used binding + 1, bindings in between may be left empty
+		mesh->render_info.image_info.image_count			= 0;
 		auto xml_render_info	= config_file->GetChildElement( xml_mesh, "RENDER_INFO" );
 		if( nullptr != xml_render_info ) {
 			TODO( "Pipeline resources" );
-			mesh->render_info.graphics_pipeline_resource	= p_device_resource_manager->RequestResource_GraphicsPipeline( { config_file->GetFieldValue_Text( xml_render_info, "graphics_pipeline_path", "Graphics pipeline path not defined" ) } );
+			pipeline_request	= uint32_t( requests.size() );
+			requests.push_back( { DeviceResource::Type::GRAPHICS_PIPELINE, { AssetID( config_file->GetFieldValue_Text( xml_render_info, "graphics_pipeline_path", "Graphics pipeline path not defined" ) ) }, DeviceResource::Flags( 0 ), priority } );
 
 			// handle images
 			auto xml_images	= config_file->GetChildElement( xml_render_info, "IMAGES" );
@@ -84,13 +95,31 @@ tinyxml2::XMLElement * SceneNode::ParseConfigFile_SceneNodeLevel()
 					auto attr_path		= i->Attribute( "path" );
 					if( nullptr != attr_binding && nullptr != attr_path ) {
 						auto index		= i->Int64Attribute( "binding", 0 );
-						mesh->render_info.image_info.image_resources[ index ]	= p_device_resource_manager->RequestResource_Image( { attr_path } );
-						mesh->render_info.image_info.image_count				= std::max( mesh->render_info.image_info.image_count, int32_t( index ) );
+						if( index < 0 || index >= BUILD_MAX_PER_SHADER_SAMPLED_IMAGE_COUNT ) {
+							p_engine->GetLogger()->LogError( "Scene node image: " + String( attr_path ) + ", binding " + std::to_string( index ).c_str() + " is out of range, image ignored" );
+							continue;
+						}
+						image_requests[ index ]						= uint32_t( requests.size() );
+						requests.push_back( { DeviceResource::Type::IMAGE, { AssetID( attr_path ) }, DeviceResource::Flags( 0 ), priority } );
+						mesh->render_info.image_info.image_count	= std::max( mesh->render_info.image_info.image_count, int32_t( index + 1 ) );
 					}
 				}
 			}
 		}
-		mesh->render_info.image_info.image_count++;
+
+		auto resources		= p_device_resource_manager->RequestResources( requests );
+		mesh->mesh_resource	= DeviceResourceHandle<DeviceResource_Mesh>( std::move( resources[ 0 ] ) );
+		WaitForResource( mesh->mesh_resource );
+		if( pipeline_request != UINT32_MAX ) {
+			mesh->render_info.graphics_pipeline_resource	= DeviceResourceHandle<DeviceResource_GraphicsPipeline>( std::move( resources[ pipeline_request ] ) );
+			WaitForResource( mesh->render_info.graphics_pipeline_resource );
+		}
+		for( size_t i=0; i < image_requests.size(); ++i ) {
+			if( image_requests[ i ] != UINT32_MAX ) {
+				mesh->render_info.image_info.image_resources[ i ]	= DeviceResourceHandle<DeviceResource_Image>( std::move( resources[ image_requests[ i ] ] ) );
+				WaitForResource( mesh->render_info.image_info.image_resources[ i ] );
+			}
+		}
 	}
 
 	return xml_root;
@@ -125,6 +154,12 @@ bool SceneNode::FinalizeResources_SceneNodeLevel()
 	if( mesh_info ) {
 		auto & i = mesh_info;
 
+		// pipeline would read the vertex buffer of the mesh in a wrong layout
+		if( i->mesh_resource->GetVertexFormat() != i->render_info.graphics_pipeline_resource->GetVertexFormat() ) {
+			p_engine->GetLogger()->LogError( "Scene node mesh: " + i->name + ", vertex format of the mesh doesn't match the vertex format of it's graphics pipeline" );
+			return false;
+		}
+
 		i->uniform_buffer	= MakeUniquePointer<UniformBuffer>( p_engine, p_renderer );
 		assert( i->uniform_buffer );
 		i->uniform_buffer->Initialize( sizeof( UniformBufferData_Mesh ) );
@@ -16,6 +16,65 @@ int main( int argc, char ** argv )
 		arguments.push_back( AE::String( argv[ i ] ) );
 	}
 
+	// pack a directory into a file archive and exit, "AE --pack <source directory> <archive> [--no-compression]"
+	if( arguments.size() >= 4 && arguments[ 1 ] == "--pack" ) {
+		bool allow_compression	= !( arguments.size() >= 5 && arguments[ 4 ] == "--no-compression" );
+		AE::Logger logger( "Pack.log" );
+		bool packed				= AE::FileArchive::Pack( arguments[ 2 ].c_str(), arguments[ 3 ].c_str(), allow_compression, &logger );
+		std::cout << ( packed ? "Packed: " : "Packing failed, see Pack.log: " ) << arguments[ 3 ] << std::endl;
+		return packed ? 0 : 1;
+	}
+
+	// cook a .me3d file or every .me3d file in a directory into cooked meshes and exit,
+	// "AE --cook-mesh <source> <destination> [--compact] [--deduplicate] [--no-optimization]"
+	if( arguments.size() >= 4 && arguments[ 1 ] == "--cook-mesh" ) {
+		auto vertex_format		= AE::VertexFormat::FLOAT;
+		auto optimization		= AE::MeshOptimization::REORDER;
+		bool deduplicate		= false;
+		bool no_optimization	= false;
+		for( size_t i=4; i < arguments.size(); ++i ) {
+			if( arguments[ i ] == "--compact" )				vertex_format	= AE::VertexFormat::COMPACT;
+			else if( arguments[ i ] == "--deduplicate" )		deduplicate		= true;
+			else if( arguments[ i ] == "--no-optimization" )	no_optimization	= true;
+			else {
+				std::cout << "Unknown cook option: " << arguments[ i ] << std::endl;
+				return 1;
+			}
+		}
+		if( deduplicate && no_optimization ) {
+			// deduplication is part of the optimization pass, it can't be done without it
+			std::cout << "Conflicting cook options: --deduplicate and --no-optimization" << std::endl;
+			return 1;
+		}
+		if( deduplicate )		optimization	= AE::MeshOptimization::REORDER_AND_DEDUPLICATE;
+		if( no_optimization )	optimization	= AE::MeshOptimization::NONE;
+		AE::Logger logger( "Cook.log" );
+		bool cooked				= AE::CookedMeshFile::Cook( arguments[ 2 ].c_str(), arguments[ 3 ].c_str(), vertex_format, optimization, &logger );
+		std::cout << ( cooked ? "Cooked: " : "Cooking failed, see Cook.log: " ) << arguments[ 3 ] << std::endl;
+		return cooked ? 0 : 1;
+	}
+
+	// run a micro benchmark, write the results to the console and exit,
+	// "AE --benchmark <memory-pool | resource-handles [resource path] | mesh-decode>"
+	if( arguments.size() >= 3 && arguments[ 1 ] == "--benchmark" ) {
+		if( arguments[ 2 ] == "memory-pool" ) {
+			AE::Benchmark_MemoryPool( std::cout );
+			return 0;
+		}
+		if( arguments[ 2 ] == "mesh-decode" ) {
+			AE::Benchmark_MeshDecode( std::cout );
+			return 0;
+		}
+		if( arguments[ 2 ] == "resource-handles" ) {
+			AE::Engine engine;
+			auto resource_path	= ( arguments.size() >= 4 ) ? arguments[ 3 ] : AE::String( "data/worlds/test.world" );
+			AE::Benchmark_ResourceHandles( &engine, resource_path.c_str(), std::cout );
+			return 0;
+		}
+		std::cout << "Unknown benchmark: " << arguments[ 2 ] << std::endl;
+		return 1;
+	}
+
 	AE::Engine engine;
 	auto world			= engine.CreateWorld( "data/worlds/test.world" );
 	auto scene_manager	= world->GetSceneManager();
@@ -18,6 +18,7 @@ layout(set=0, binding=0) uniform CameraData
 layout(set=1, binding=0) uniform MeshData
 {
 	mat4 model_matrix;
+	mat4 normal_matrix;	// use this instead of model_matrix for normals
 } mesh_data;
 
 